@@ -32,6 +32,13 @@ struct ReproductionCooldown {
     float cooldown;
 };
 
+// Identity that names "the same" boid in every run with the same seed (initial
+// boids by spawn order, newborns by parents and birth frame). Keys the boid's
+// random streams; flecs ids are not stable across runs and are not used.
+struct BoidId {
+    uint64_t value;
+};
+
 // ============================================================
 // Tag components — zero-size markers for queries
 // ============================================================
@@ -43,6 +50,7 @@ struct Female {};
 struct Infected {};
 struct Alive {};
 struct AntivaxBoid {};  // Primary swarm tag (mutually exclusive with NormalBoid and DoctorBoid)
+struct Dead {};         // Died this frame; groups corpses in their own tables for bulk cleanup
 
 // ============================================================
 // SimConfig singleton — ALL tunable simulation parameters
@@ -57,6 +65,13 @@ struct SimConfig {
     float p_infect_normal          = 0.5f;
     float p_infect_doctor          = 0.5f;
 
+    // --- Infection scheduling ---
+    // p_infect_* are per-contact, per-frame probabilities calibrated at 60fps. They are
+    // converted to a per-second hazard so the epidemic does not depend on frame rate.
+    // 0 = evaluate every spreader every frame; >0 = each spreader is evaluated once per
+    // 1/infection_tick_rate seconds at a per-boid phase, spreading the work across frames.
+    float infection_tick_rate      = 0.0f;   // Hz
+
     // --- Reproduction probabilities ---
     float p_offspring_normal       = 0.4f;
     float p_offspring_doctor       = 0.05f;
@@ -88,6 +103,28 @@ struct SimConfig {
     int initial_normal_count       = 200;
     int initial_doctor_count       = 10;
 
+    // --- Execution ---
+    int sim_threads                = 0;      // worker threads for parallel systems (0 = all cores, 1 = serial)
+    int seed                       = 42;     // seeds every random stream of the world (ensembles use seed, seed+1, ...)
+    bool toggle_state_tags         = false;  // Infected/Alive flip a CanToggle bit instead of moving tables
+    bool recycle_entities          = false;  // park dead boids and reuse their ids for offspring
+    int stats_stream_interval      = 1;      // frames between stats stream records (--stats-out)
+    int trajectory_interval        = 1;      // frames between recorded trajectory frames (--trajectory-out)
+    int trajectory_keyframe_interval = 300;  // recorded frames between trajectory keyframes (seek granularity)
+    float trajectory_tolerance     = 0.5f;   // world units a recorded position may drift (0 = full 16-bit precision)
+    float trajectory_heading_tolerance = 4.0f;  // degrees a recorded heading may drift (0 = exact 8-bit heading)
+
+    // --- Early termination (headless batch runs; false / 0 = off) ---
+    bool stop_on_normal_extinct    = false;  // stop once every normal boid has died
+    bool stop_on_doctor_extinct    = false;  // stop once every doctor has died
+    bool stop_on_antivax_extinct   = false;  // stop once every antivax boid has died
+    float stop_no_infected_seconds = 0.0f;   // stop after this long with no infected boid
+    float stop_steady_window       = 0.0f;   // seconds of alive counts for the steady-state test
+    float stop_steady_variance     = 0.0f;   // stop when their variance drops below this (boids^2)
+
+    // --- Burn-in (headless batch runs; 0 = off) ---
+    float burn_in_seconds          = 0.0f;   // flocking-only warm-up before t = 0 (see ecs/burn_in.h)
+
     // --- Boid movement (Shiffman/Processing.org Model B, scaled to per-second @ 60fps) ---
     float max_speed                = 180.0f;  // Shiffman maxspeed=3 * 60fps
     float max_force                = 180.0f;  // Shiffman maxforce=0.05 * 60^2 (preserves per-frame steering ratio)
@@ -139,12 +176,19 @@ struct SimStats {
     int antivax_alive   = 0;
     int dead_antivax    = 0;
     int newborns_antivax = 0;
+    int infected_alive  = 0;
+
+    // Population history lives in the PopulationHistory singleton
+    // (sim/population_history.h), not in this per-frame copied struct
+};
+
+// ============================================================
+// SimClock singleton — simulated time, advanced by ClockSystem
+// ============================================================
 
-    // Population history for graph (circular buffer)
-    static constexpr int HISTORY_SIZE = 500;
-    PopulationHistoryPoint history[HISTORY_SIZE] = {};
-    int history_index = 0;  // Current write position (wraps around)
-    int history_count = 0;  // Number of valid entries (0 to HISTORY_SIZE)
+struct SimClock {
+    double time = 0.0;    // simulated seconds at the end of the current frame
+    uint64_t frame = 0;   // frames simulated since spawn/reset
 };
 
 // ============================================================
@@ -9,3 +9,11 @@ struct SimConfig;
 // Returns false if the file does not exist (config unchanged, defaults kept).
 // Throws std::runtime_error on parse errors (malformed lines).
 bool load_config(const std::string& path, SimConfig& config);
+
+// Set one parameter by its config.ini key (used for sweeps and overrides).
+// Returns false if the key is unknown (config unchanged).
+// Throws std::runtime_error if the value cannot be parsed for that key.
+bool set_config_value(SimConfig& config, const std::string& key, const std::string& value);
+
+// True if the key holds an integer; sweeps round their levels for these keys
+bool is_integer_config_key(const std::string& key);
@@ -4,12 +4,17 @@
 #include <vector>
 #include "components.h"
 
+class PopulationHistory;
+struct EnsembleSummary;
+
 struct BoidRenderData {
     float x, y;
     float angle;
     uint32_t color;
     float radius;
     int swarm_type;  // 0=normal, 1=doctor, 2=antivax
+    uint64_t id = 0;        // BoidId: unique per boid, never reused (trajectory recording)
+    bool infected = false;
 };
 
 struct RenderState {
@@ -17,4 +22,6 @@ struct RenderState {
     SimStats stats;
     SimConfig* config = nullptr;
     SimulationState* sim_state = nullptr;
+    const PopulationHistory* history = nullptr;  // owned by the world; null in render_demo
+    const EnsembleSummary* ensemble = nullptr;   // reference bands (--ensemble-bands); null if none
 };
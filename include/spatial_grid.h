@@ -4,6 +4,7 @@
 #include <vector>
 #include <utility>
 #include <memory>
+#include <cstddef>
 
 class SpatialGrid {
 public:
@@ -11,14 +12,16 @@ public:
     static constexpr uint8_t FLAG_INFECTED = 0x01;
     static constexpr uint8_t FLAG_ALIVE    = 0x02;
     static constexpr uint8_t FLAG_MALE     = 0x04;
+    static constexpr uint8_t FLAG_COOLDOWN_READY = 0x08;  // may reproduce this frame
 
     // --- Enriched entry stored in each grid cell ---
     struct Entry {
         uint64_t entity_id;
+        uint64_t uid;          // BoidId: keys the boid's random streams
         float x, y;
         float vx, vy;         // velocity for alignment
         uint8_t swarm_type;    // 0=normal, 1=doctor, 2=antivax
-        uint8_t flags;         // bit 0=infected, bit 1=alive, bit 2=male
+        uint8_t flags;         // bit 0=infected, bit 1=alive, bit 2=male, bit 3=cooldown ready
     };
 
     // --- Query result: pointer to entry + squared distance ---
@@ -34,7 +37,13 @@ public:
 
     // Full insert with enriched fields
     void insert(uint64_t entity_id, float x, float y,
-                float vx, float vy, uint8_t swarm_type, uint8_t flags);
+                float vx, float vy, uint8_t swarm_type, uint8_t flags, uint64_t uid);
+
+    // Without a BoidId the entity id keys the random streams
+    void insert(uint64_t entity_id, float x, float y,
+                float vx, float vy, uint8_t swarm_type, uint8_t flags) {
+        insert(entity_id, x, y, vx, vy, swarm_type, flags, entity_id);
+    }
 
     // Convenience overload: no extra fields (backward compat for tests)
     void insert(uint64_t entity_id, float x, float y) {
@@ -51,14 +60,47 @@ public:
     // Returns the cell size used for spatial partitioning (diagnostic use).
     float cell_size() const { return cell_size_; }
 
+    // Appends every entry accepted by `pred` in deterministic (cell, insertion) order.
+    // Pointers stay valid until the next clear(); used to split work across threads.
+    template <typename Pred>
+    void collect(std::vector<const Entry*>& out, Pred pred) const {
+        for (const auto& cell : cells_) {
+            for (const auto& entry : cell) {
+                if (pred(entry)) out.push_back(&entry);
+            }
+        }
+    }
+
+    // Number of entries inserted since the last clear().
+    std::size_t size() const { return size_; }
+
 private:
     float world_w_ = 0.0f;
     float world_h_ = 0.0f;
     float cell_size_ = 1.0f;
     int cols_ = 0;
     int rows_ = 0;
+    std::size_t size_ = 0;
 
     std::vector<std::vector<Entry>> cells_;
 
     int cell_index(float x, float y) const;
 };
+
+// --- Filtered sub-indexes rebuilt alongside the main grid ---
+// Interaction systems iterate whichever side of a pair is rarer and query the
+// other side here, so each query only scans candidates that can actually match.
+struct InteractionIndex {
+    SpatialGrid infected;   // alive infected boids (all swarms)
+    SpatialGrid doctors;    // alive doctor boids (infected or not)
+
+    InteractionIndex() = default;
+    InteractionIndex(float world_w, float world_h, float cell_size)
+        : infected(world_w, world_h, cell_size)
+        , doctors(world_w, world_h, cell_size) {}
+
+    void clear() {
+        infected.clear();
+        doctors.clear();
+    }
+};
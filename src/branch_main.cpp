@@ -0,0 +1,230 @@
+#include "ecs/sweep_runner.h"
+#include "config_loader.h"
+#include "components.h"
+#include "io/stats_stream.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// ============================================================
+// Branched futures: simulate a shared prefix once, then fan out
+// ============================================================
+
+static void print_usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0 << " [config.ini] [options]\n"
+              << "  --at-frames N    branch point in frames (default 1800)\n"
+              << "  --at-seconds T   branch point in simulated seconds (instead of --at-frames)\n"
+              << "  --frames N       frames per child after the branch point (default 3600)\n"
+              << "  --seconds T      simulated seconds per child (instead of --frames)\n"
+              << "  --dt S           fixed time step (default 1/60)\n"
+              << "  --branch [name:]key=value[,key=value...]\n"
+              << "                   one future with these config changes; repeatable\n"
+              << "  --no-control     do not run the unchanged 'control' branch\n"
+              << "  --replicates R   children per branch (default 1)\n"
+              << "  --independent    give every branch its own seeds (no common random numbers)\n"
+              << "  --threads T      worker threads (default 0 = all cores)\n"
+              << "  --burn-in-cache <dir>  reuse burn-in snapshots (config burn_in_seconds)\n"
+              << "  --interval N     frames between per-child samples (default 10)\n"
+              << "  --out <file>     per-child summary CSV (default branches.csv)\n"
+              << "  --out-prefix P   per-child stats CSVs are P<branch>_r<replicate>.csv\n"
+              << "                   (default branch_)\n";
+}
+
+// "[name:]key=value,key=value"
+static BranchSpec parse_branch(const std::string& spec, std::size_t index) {
+    BranchSpec branch;
+    std::string body = spec;
+    const std::size_t colon = spec.find(':');
+    if (colon != std::string::npos && spec.find('=') > colon) {
+        branch.name = spec.substr(0, colon);
+        body = spec.substr(colon + 1);
+    } else {
+        branch.name = "branch" + std::to_string(index);
+    }
+
+    std::stringstream ss(body);
+    std::string part;
+    while (std::getline(ss, part, ',')) {
+        const std::size_t eq = part.find('=');
+        if (eq == std::string::npos || eq == 0) {
+            throw std::runtime_error("bad --branch '" + spec + "' (expected [name:]key=value,...)");
+        }
+        branch.overrides.emplace_back(part.substr(0, eq), part.substr(eq + 1));
+    }
+    if (branch.overrides.empty()) {
+        throw std::runtime_error("bad --branch '" + spec + "' (no config changes)");
+    }
+    return branch;
+}
+
+static std::string describe_overrides(const BranchSpec& branch) {
+    std::string text;
+    for (const auto& kv : branch.overrides) {
+        if (!text.empty()) text += ';';
+        text += kv.first + '=' + kv.second;
+    }
+    return text;
+}
+
+int main(int argc, char* argv[]) {
+    std::string config_path = "config.ini";
+    std::string out_path = "branches.csv";
+    std::string out_prefix = "branch_";
+    std::vector<std::string> branch_specs;
+    bool control = true;
+    std::size_t replicates = 1;
+    bool common_random_numbers = true;
+    unsigned threads = 0;
+    uint64_t interval = 10;
+    HeadlessOptions prefix_options;
+    prefix_options.max_frames = 1800;
+    HeadlessOptions options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--at-frames" && has_value) {
+            prefix_options.max_frames = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--at-seconds" && has_value) {
+            prefix_options.max_time = std::atof(argv[++i]);
+            prefix_options.max_frames = 0;
+        } else if (arg == "--frames" && has_value) {
+            options.max_frames = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--seconds" && has_value) {
+            options.max_time = std::atof(argv[++i]);
+            options.max_frames = 0;
+        } else if (arg == "--dt" && has_value) {
+            options.dt = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--branch" && has_value) {
+            branch_specs.push_back(argv[++i]);
+        } else if (arg == "--no-control") {
+            control = false;
+        } else if (arg == "--replicates" && has_value) {
+            replicates = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--independent") {
+            common_random_numbers = false;
+        } else if (arg == "--burn-in-cache" && has_value) {
+            prefix_options.burn_in_cache = argv[++i];
+        } else if (arg == "--threads" && has_value) {
+            threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--interval" && has_value) {
+            interval = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--out" && has_value) {
+            out_path = argv[++i];
+        } else if (arg == "--out-prefix" && has_value) {
+            out_prefix = argv[++i];
+        } else if (arg == "--help" || arg == "-h") {
+            print_usage(argv[0]);
+            return 0;
+        } else if (!arg.empty() && arg[0] == '-') {
+            print_usage(argv[0]);
+            return 2;
+        } else {
+            config_path = arg;
+        }
+    }
+    prefix_options.dt = options.dt;
+    // The prefix ignores stop conditions, so it needs a limit of its own
+    if (replicates == 0 || interval == 0 || options.dt <= 0.0f ||
+        (prefix_options.max_frames == 0 && prefix_options.max_time <= 0.0)) {
+        print_usage(argv[0]);
+        return 2;
+    }
+
+    SimConfig config{};
+    std::vector<BranchSpec> branches;
+    try {
+        load_config(config_path, config);
+        if (control) branches.push_back(BranchSpec{"control", {}});
+        for (const auto& spec : branch_specs) {
+            branches.push_back(parse_branch(spec, branches.size()));
+            // Catch typos before the prefix is simulated
+            SimConfig check = config;
+            for (const auto& kv : branches.back().overrides) {
+                if (kv.first == "seed" || !set_config_value(check, kv.first, kv.second)) {
+                    throw std::runtime_error("bad --branch '" + spec + "': cannot set '" + kv.first + "'");
+                }
+            }
+        }
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    if (branches.empty()) {
+        std::cerr << "Nothing to run: no --branch and --no-control\n";
+        return 2;
+    }
+
+    std::ofstream out(out_path);
+    if (!out) {
+        std::cerr << "Cannot open output file: " << out_path << "\n";
+        return 1;
+    }
+    out << "branch,name,replicate,seed,overrides,frames,sim_time,wall_seconds,extinct,stop_reason";
+    const char* const* names = stats_column_names();
+    for (int c = 0; c < STATS_COLUMN_COUNT; ++c) out << ',' << names[c];
+    out << ",error\n";
+
+    const auto start = std::chrono::steady_clock::now();
+    CheckpointImage prefix;
+    try {
+        prefix = run_branch_prefix(config, prefix_options);
+    } catch (const std::exception& e) {
+        std::cerr << "Prefix failed: " << e.what() << "\n";
+        return 1;
+    }
+    const double prefix_wall =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const std::size_t children = branches.size() * replicates;
+    std::cerr << "Prefix simulated once in " << prefix_wall << " s (" << prefix.bytes / 1024
+              << " KiB image); running " << branches.size() << " branches x " << replicates
+              << " replicates" << (common_random_numbers ? "" : " (independent seeds)") << "\n";
+
+    std::size_t done = 0, failed = 0;
+    auto on_done = [&](const BranchRunResult& child) {
+        const BranchSpec& branch = branches[child.branch];
+        const HeadlessResult& r = child.result;
+        out << child.branch << ',' << branch.name << ',' << child.replicate << ',' << child.seed << ','
+            << describe_overrides(branch) << ',' << r.frames << ',' << format_sim_time(r.sim_time) << ','
+            << r.wall_seconds << ',' << (r.extinct ? 1 : 0) << ',' << stop_reason_name(r.stop_reason);
+        const StatsRecord rec = make_stats_record(r.frames, r.sim_time, r.final_stats);
+        for (int c = 0; c < STATS_COLUMN_COUNT; ++c) out << ',' << rec.values[c];
+        std::string error = child.error;
+        for (char& ch : error) {
+            if (ch == ',' || ch == '\n') ch = ';';
+        }
+        out << ',' << error << '\n';
+
+        done++;
+        if (!child.error.empty()) {
+            failed++;
+            std::cerr << branch.name << " r" << child.replicate << ": " << child.error << "\n";
+            return;
+        }
+        const std::string path =
+            out_prefix + branch.name + "_r" + std::to_string(child.replicate) + ".csv";
+        std::ofstream stats_out(path);
+        if (!stats_out) {
+            failed++;
+            std::cerr << "Cannot open output file: " << path << "\n";
+            return;
+        }
+        write_stats_csv(child.samples, stats_out);
+        if (done % 10 == 0 || done == children) {
+            std::cerr << "  " << done << "/" << children << "\n";
+        }
+    };
+    run_branches(prefix, branches, replicates, common_random_numbers, interval, options, threads,
+                 on_done);
+
+    const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "Done: " << done << " children (" << failed << " failed) in " << wall << " s wall -> "
+              << out_path << "\n";
+    return failed == 0 ? 0 : 1;
+}
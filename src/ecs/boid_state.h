@@ -0,0 +1,134 @@
+#pragma once
+
+#include "components.h"
+#include <flecs.h>
+
+// ============================================================
+// Hot state tags: Infected / Alive
+// ============================================================
+//
+// By default Infected and Alive are plain tags, so every infection, cure and
+// death moves the entity to another table (copying all of its components).
+// With SimConfig::toggle_state_tags both tags are registered CanToggle: every
+// boid always carries them and a state change only flips a bit in the
+// table's toggle bitset. Queries that list the tag skip disabled entities on
+// their own, so only per-entity checks and mutations need these helpers.
+//
+// The bitset is a type id of its own (ECS_TOGGLE | tag). The first enable or
+// disable of an entity without it adds it, moving the entity to another
+// table, so boids are created with both bitsets in their type (prefab and
+// bulk type, add_state_toggles) and never move afterwards.
+
+// Registers CanToggle on the hot tags. Must run before any entity has them.
+inline void register_state_toggles(flecs::world& world) {
+    world.component<Infected>().add(flecs::CanToggle);
+    world.component<Alive>().add(flecs::CanToggle);
+}
+
+// Type id of a hot tag's toggle bitset
+template <typename Tag>
+inline flecs::id_t state_toggle_id(flecs::world& world) {
+    return ECS_TOGGLE | world.id<Tag>().raw_id();
+}
+
+// Toggle mode: gives an entity both tags with their bitsets, Alive enabled and
+// Infected as given
+inline void add_state_toggles(flecs::entity e, bool infected) {
+    flecs::world world = e.world();
+    e.add<Infected>()
+        .add<Alive>()
+        .add(state_toggle_id<Infected>(world))
+        .add(state_toggle_id<Alive>(world));
+    // In place now that the bitsets exist
+    e.enable<Alive>();
+    if (infected) {
+        e.enable<Infected>();
+    } else {
+        e.disable<Infected>();
+    }
+}
+
+// True if the entity has the tag and it is not disabled (works in both modes)
+inline bool boid_infected(flecs::entity e) { return e.enabled<Infected>(); }
+inline bool boid_alive(flecs::entity e) { return e.enabled<Alive>(); }
+
+// Swarm type of a table (0=normal, 1=doctor, 2=antivax, as SpatialGrid::Entry).
+// Swarm tags are never toggled, so this is constant for every row.
+inline uint8_t table_swarm_type(const flecs::table& table) {
+    return table.has<NormalBoid>() ? 0 : table.has<DoctorBoid>() ? 1 : 2;
+}
+
+// Infected state for rows of a table visited by q.run(). A plain tag is
+// constant across the table and resolved once; only toggle mode has to read
+// each row's enabled bit.
+class TableInfected {
+public:
+    TableInfected(flecs::iter& it, bool toggle)
+        : present_(it.table().has<Infected>())
+        , per_entity_(present_ && toggle) {}
+
+    bool operator()(flecs::iter& it, size_t row) const {
+        return per_entity_ ? it.entity(row).enabled<Infected>() : present_;
+    }
+
+private:
+    bool present_;
+    bool per_entity_;
+};
+
+// Live SimStats counter of a boid's swarm
+inline int& swarm_alive_counter(SimStats& stats, flecs::entity e) {
+    return e.has<NormalBoid>() ? stats.normal_alive
+         : e.has<DoctorBoid>() ? stats.doctor_alive
+         : stats.antivax_alive;
+}
+
+// Toggle mode: flipping a bit emits no add/remove events, so the stats
+// observers are not registered and the live counters are adjusted here when a
+// bit actually changes (spawn_boids counts the rows it creates). Must be
+// called before the flip is applied.
+inline void count_state_change(flecs::entity e, bool alive_changed, bool infected_changed) {
+    SimStats* stats = e.world().try_get_mut<SimStats>();
+    if (!stats) return;
+    const bool alive = e.enabled<Alive>();
+    const bool infected = e.enabled<Infected>();
+    if (alive_changed) {
+        const int delta = alive ? -1 : 1;
+        swarm_alive_counter(*stats, e) += delta;
+        if (infected) stats->infected_alive += delta;
+    }
+    if (infected_changed && alive) stats->infected_alive += infected ? -1 : 1;
+}
+
+// Toggle mode expects the entity to carry the bitsets already (see above)
+inline void set_boid_infected(flecs::entity e, bool infected, bool toggle) {
+    if (toggle) {
+        e.add<Infected>();  // no-op once present — keeps the entity in its table
+        if (e.enabled<Infected>() != infected) count_state_change(e, false, true);
+        if (infected) {
+            e.enable<Infected>();
+        } else {
+            e.disable<Infected>();
+        }
+    } else if (infected) {
+        e.add<Infected>();
+    } else {
+        e.remove<Infected>();
+    }
+}
+
+inline void set_boid_alive(flecs::entity e, bool alive, bool toggle) {
+    if (toggle) {
+        e.add<Alive>();
+        if (e.enabled<Alive>() != alive) count_state_change(e, true, false);
+        if (alive) {
+            e.enable<Alive>();
+        } else {
+            e.disable<Alive>();
+        }
+    } else if (alive) {
+        e.add<Alive>();
+    } else {
+        e.remove<Alive>();
+    }
+}
@@ -0,0 +1,180 @@
+#include "burn_in.h"
+#include "world.h"
+#include "systems.h"
+#include "spawn.h"
+#include "runner.h"
+#include "components.h"
+#include "io/burn_in_cache.h"
+#include <flecs.h>
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// Everything that changes the population or its epidemic state
+const char* const EPIDEMIC_SYSTEMS[] = {
+    "InfectionSystem", "CureSystem", "AgingSystem", "DeathSystem",
+    "DoctorPromotionSystem", "ReproductionSystem", "OffspringSpawnSystem",
+};
+
+using Snapshot = std::shared_ptr<const std::vector<BurnInBoid>>;
+
+std::vector<BurnInBoid> simulate_burn_in(const SimConfig& config, float dt) {
+    SimConfig scratch = config;
+    scratch.p_initial_infect_normal = 0.0f;
+    scratch.p_initial_infect_doctor = 0.0f;
+
+    std::unique_ptr<flecs::world> world;
+    {
+        std::lock_guard<std::mutex> lock(world_lifetime_mutex());
+        world = std::make_unique<flecs::world>();
+        init_world(*world, scratch);
+        register_all_systems(*world);
+    }
+
+    std::vector<BurnInBoid> boids;
+    try {
+        for (const char* name : EPIDEMIC_SYSTEMS) {
+            if (flecs::entity system = world->lookup(name)) system.disable();
+        }
+        spawn_initial_population(*world);
+
+        HeadlessOptions options;
+        options.dt = dt;
+        options.max_frames = 0;
+        options.max_time = config.burn_in_seconds;
+        options.stop_on_extinction = false;
+        options.stop_conditions = false;
+        run_headless(*world, options);
+
+        world->each([&](const BoidId& id, const Position& p, const Velocity& v, const Heading& h) {
+            BurnInBoid b;
+            b.uid = id.value;
+            b.position = p;
+            b.velocity = v;
+            b.heading = h;
+            boids.push_back(b);
+        });
+        std::sort(boids.begin(), boids.end(),
+                  [](const BurnInBoid& a, const BurnInBoid& b) { return a.uid < b.uid; });
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(world_lifetime_mutex());
+        world.reset();
+        throw;
+    }
+
+    std::lock_guard<std::mutex> lock(world_lifetime_mutex());
+    world.reset();
+    return boids;
+}
+
+// Snapshots being filled. Concurrent runs of one key wait for its first
+// caller; the entry is dropped once filled, so finished snapshots live only
+// as long as the runs using them and later runs go to the disk cache.
+struct SnapshotCache {
+    std::mutex mutex;
+    std::map<uint64_t, std::shared_future<Snapshot>> entries;
+};
+
+SnapshotCache& snapshot_cache() {
+    static SnapshotCache cache;
+    return cache;
+}
+
+Snapshot settled_snapshot(const SimConfig& config, float dt, const std::string& cache_dir,
+                          BurnInSource& source) {
+    const uint64_t key = burn_in_key(config, dt);
+    SnapshotCache& cache = snapshot_cache();
+
+    std::promise<Snapshot> promise;
+    std::shared_future<Snapshot> future;
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        auto it = cache.entries.find(key);
+        if (it != cache.entries.end()) {
+            source = BurnInSource::Memory;
+            future = it->second;
+        } else {
+            future = promise.get_future().share();
+            cache.entries.emplace(key, future);
+        }
+    }
+    if (source == BurnInSource::Memory) return future.get();
+
+    try {
+        auto boids = std::make_shared<std::vector<BurnInBoid>>();
+        const std::string path = cache_dir.empty() ? std::string() : burn_in_path(cache_dir, key);
+        if (!path.empty() && read_burn_in(path, key, *boids)) {
+            source = BurnInSource::File;
+        } else {
+            *boids = simulate_burn_in(config, dt);
+            source = BurnInSource::Simulated;
+            if (!path.empty() && !write_burn_in(path, key, *boids)) {
+                std::cerr << "Warning: cannot write burn-in cache " << path << "\n";
+            }
+        }
+        // Waiters already hold the future; later runs go to the disk cache
+        {
+            std::lock_guard<std::mutex> lock(cache.mutex);
+            cache.entries.erase(key);
+        }
+        promise.set_value(std::move(boids));
+    } catch (...) {
+        // Let a later caller retry rather than inherit the failure
+        {
+            std::lock_guard<std::mutex> lock(cache.mutex);
+            cache.entries.erase(key);
+        }
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+    return future.get();
+}
+
+} // namespace
+
+const char* burn_in_source_name(BurnInSource source) {
+    switch (source) {
+        case BurnInSource::None:      return "none";
+        case BurnInSource::Simulated: return "simulated";
+        case BurnInSource::Memory:    return "memory";
+        case BurnInSource::File:      return "file";
+    }
+    return "none";
+}
+
+BurnInSource spawn_settled_population(flecs::world& world, float dt, const std::string& cache_dir) {
+    const SimConfig config = world.get<SimConfig>();
+    if (config.burn_in_seconds <= 0.0f) {
+        spawn_initial_population(world);
+        return BurnInSource::None;
+    }
+
+    BurnInSource source = BurnInSource::None;
+    const Snapshot snapshot = settled_snapshot(config, dt, cache_dir, source);
+    const std::vector<BurnInBoid>& boids = *snapshot;
+
+    spawn_initial_population(world);
+    std::size_t spawned = 0, matched = 0;
+    world.each([&](const BoidId& id, Position& p, Velocity& v, Heading& h) {
+        spawned++;
+        auto it = std::lower_bound(boids.begin(), boids.end(), id.value,
+                                   [](const BurnInBoid& b, uint64_t uid) { return b.uid < uid; });
+        if (it == boids.end() || it->uid != id.value) return;
+        p = it->position;
+        v = it->velocity;
+        h = it->heading;
+        matched++;
+    });
+    if (matched != spawned || matched != boids.size()) {
+        throw std::runtime_error("burn-in snapshot does not match the spawned population");
+    }
+    return source;
+}
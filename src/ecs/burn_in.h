@@ -0,0 +1,38 @@
+#pragma once
+
+#include <flecs.h>
+#include <string>
+
+// ============================================================
+// Burn-in: start runs from settled flocks
+// ============================================================
+//
+// spawn_initial_population places boids uniformly at random, and the first
+// seconds of flocking are a transient every run discards. With
+// SimConfig::burn_in_seconds > 0, spawn_settled_population first simulates
+// that long in a scratch world with the epidemic off (no initial infections;
+// infection, cure, aging, death, promotion and reproduction disabled), then
+// spawns the run's own population as usual and moves every boid to its
+// settled position, velocity and heading. Clock, stats and history start at
+// zero as after a plain spawn.
+//
+// The snapshot depends only on burn_in_key() (io/burn_in_cache.h), so runs
+// of one key can share it: concurrent runs wait for the first one's snapshot
+// (nothing is kept in memory once they have it) and, given a cache directory,
+// later runs and processes read it back from disk. A run is identical whether
+// its snapshot was simulated, shared or read back.
+
+enum class BurnInSource {
+    None,        // burn_in_seconds <= 0: plain spawn
+    Simulated,
+    Memory,      // shared with a concurrent run of the same key
+    File,
+};
+
+const char* burn_in_source_name(BurnInSource source);
+
+// Populates a freshly initialized world (in place of spawn_initial_population).
+// `dt` is the burn-in time step. Throws std::runtime_error if a snapshot does
+// not match the spawned population.
+BurnInSource spawn_settled_population(flecs::world& world, float dt,
+                                      const std::string& cache_dir = "");
@@ -0,0 +1,291 @@
+#include "checkpoint.h"
+#include "spawn.h"
+#include "boid_state.h"
+#include "io/checkpoint.h"
+#include "io/mapped_file.h"
+#include "sim/population_history.h"
+#include "sim/rng.h"
+#include <flecs.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// Component and tag ids of the boid archetypes, in one place for save and load
+struct BoidIds {
+    flecs::id_t position, velocity, heading, health, cooldown, uid, infection;
+    flecs::id_t tags[8];   // CKPT_NORMAL .. CKPT_DEAD, in bit order
+    flecs::id_t infected_toggle, alive_toggle;
+
+    explicit BoidIds(flecs::world& world)
+        : position(world.id<Position>().raw_id())
+        , velocity(world.id<Velocity>().raw_id())
+        , heading(world.id<Heading>().raw_id())
+        , health(world.id<Health>().raw_id())
+        , cooldown(world.id<ReproductionCooldown>().raw_id())
+        , uid(world.id<BoidId>().raw_id())
+        , infection(world.id<InfectionState>().raw_id())
+        , tags{world.id<NormalBoid>().raw_id(), world.id<DoctorBoid>().raw_id(),
+               world.id<AntivaxBoid>().raw_id(), world.id<Male>().raw_id(),
+               world.id<Female>().raw_id(), world.id<Infected>().raw_id(),
+               world.id<Alive>().raw_id(), world.id<Dead>().raw_id()}
+        , infected_toggle(state_toggle_id<Infected>(world))
+        , alive_toggle(state_toggle_id<Alive>(world)) {}
+
+    // CheckpointTag bit of an id, 0 if it is not part of a boid archetype
+    uint32_t tag_of(flecs::id_t id) const {
+        for (uint32_t b = 0; b < 8; ++b) {
+            if (tags[b] == id) return 1u << b;
+        }
+        if (id == infection) return CKPT_INFECTION_STATE;
+        if (id == infected_toggle) return CKPT_INFECTED_TOGGLE;
+        if (id == alive_toggle) return CKPT_ALIVE_TOGGLE;
+        return 0;
+    }
+
+    // Type of a table with these CheckpointTag bits, sorted as flecs keeps it
+    std::vector<flecs::id_t> type_of(uint32_t table_tags) const {
+        std::vector<flecs::id_t> type = {position, velocity, heading, health, cooldown, uid};
+        if (table_tags & CKPT_INFECTION_STATE) type.push_back(infection);
+        for (uint32_t b = 0; b < 8; ++b) {
+            if (table_tags & (1u << b)) type.push_back(tags[b]);
+        }
+        if (table_tags & CKPT_INFECTED_TOGGLE) type.push_back(infected_toggle);
+        if (table_tags & CKPT_ALIVE_TOGGLE) type.push_back(alive_toggle);
+        std::sort(type.begin(), type.end());
+        return type;
+    }
+
+    bool is_column(flecs::id_t id) const {
+        return id == position || id == velocity || id == heading || id == health ||
+               id == cooldown || id == uid;
+    }
+};
+
+// All boid tables, including empty ones: the order of every table matters
+// for the iteration order of queries once it fills up again
+flecs::query<> boid_table_query(flecs::world& world) {
+    return world.query_builder<>()
+        .with<Position>()
+        .query_flags(EcsQueryMatchEmptyTables)
+        .build();
+}
+
+void pack_enabled_bits(flecs::iter& it, flecs::id_t id, std::vector<uint64_t>& words) {
+    words.assign(checkpoint_bit_words(it.count()), 0);
+    for (size_t i = 0; i < it.count(); ++i) {
+        if (ecs_is_enabled_id(it.world().c_ptr(), it.entity(i), id)) {
+            words[i / 64] |= uint64_t{1} << (i % 64);
+        }
+    }
+}
+
+void write_world(flecs::world& world, std::ostream& out) {
+    const BoidIds ids(world);
+
+    CheckpointGlobals globals;
+    globals.config = world.get<SimConfig>();
+    globals.stats = world.get<SimStats>();
+    if (const SimClock* clock = world.try_get<SimClock>()) globals.clock = *clock;
+    if (const SimRng* rngs = world.try_get<SimRng>()) {
+        globals.rng_seed = rngs->seed;
+        globals.rng_epoch = rngs->epoch;
+        globals.rng_spawned[0] = rngs->spawned[0];
+        globals.rng_spawned[1] = rngs->spawned[1];
+    }
+    if (const PopulationHistory* history = world.try_get<PopulationHistory>()) {
+        globals.history_capacity = history->level_capacity();
+        globals.history_total = history->total_samples();
+        for (std::size_t l = 0; l < history->level_count(); ++l) {
+            globals.history.push_back(history->level(l));
+        }
+    }
+    if (const BoidRecycler* recycler = world.try_get<BoidRecycler>()) {
+        globals.recycled_entities = recycler->free.size();
+    }
+
+    // Columns are written straight from table storage; only the toggle bits
+    // are packed on the side (moving an inner vector keeps its buffer)
+    std::vector<CheckpointTable> tables;
+    std::vector<std::vector<uint64_t>> bits;
+    boid_table_query(world).run([&](flecs::iter& it) {
+        while (it.next()) {
+            flecs::table table = it.table();
+            CheckpointTable t;
+            t.rows = it.count();
+
+            uint32_t columns = 0;
+            const flecs::type type = table.type();
+            for (int32_t i = 0; i < type.count(); ++i) {
+                const flecs::id_t id = type.get(i);
+                if (const uint32_t tag = ids.tag_of(id)) {
+                    t.tags |= tag;
+                } else if (ids.is_column(id)) {
+                    columns++;
+                } else {
+                    throw std::runtime_error("checkpoint: boid table has unsupported component " +
+                                             std::string(world.id(id).str().c_str()));
+                }
+            }
+            if (columns != 6) {
+                throw std::runtime_error("checkpoint: boid table is missing core components");
+            }
+
+            t.position = table.get<Position>();
+            t.velocity = table.get<Velocity>();
+            t.heading = table.get<Heading>();
+            t.health = table.get<Health>();
+            t.cooldown = table.get<ReproductionCooldown>();
+            t.uid = table.get<BoidId>();
+            if (t.tags & CKPT_INFECTION_STATE) t.infection = table.get<InfectionState>();
+
+            // Per-row bits of every bitset in the table's type
+            if (t.rows > 0) {
+                if (t.tags & CKPT_INFECTED_TOGGLE) {
+                    bits.emplace_back();
+                    pack_enabled_bits(it, ids.tags[5], bits.back());
+                    t.infected_enabled = bits.back().data();
+                    t.toggled |= CKPT_INFECTED;
+                }
+                if (t.tags & CKPT_ALIVE_TOGGLE) {
+                    bits.emplace_back();
+                    pack_enabled_bits(it, ids.tags[6], bits.back());
+                    t.alive_enabled = bits.back().data();
+                    t.toggled |= CKPT_ALIVE;
+                }
+            }
+            tables.push_back(t);
+        }
+    });
+
+    write_checkpoint(out, globals, tables);
+}
+
+// Columns are copied into flecs straight from the (mapped) image
+void restore_world(flecs::world& world, const uint8_t* data, std::size_t size) {
+    CheckpointGlobals globals;
+    std::vector<CheckpointTable> tables;
+    read_checkpoint(data, size, globals, tables);
+
+    const SimConfig& current = world.get<SimConfig>();
+    if (current.toggle_state_tags != globals.config.toggle_state_tags ||
+        current.recycle_entities != globals.config.recycle_entities ||
+        current.world_width != globals.config.world_width ||
+        current.world_height != globals.config.world_height) {
+        throw std::runtime_error("checkpoint: world layout differs from the checkpoint's config");
+    }
+    if (boid_table_query(world).count() > 0) {
+        throw std::runtime_error("checkpoint: world already has boids");
+    }
+    ensure_boid_prefabs(world);
+
+    const BoidIds ids(world);
+    for (const CheckpointTable& t : tables) {
+        // Bitsets are part of the type, so toggled rows are restored in place
+        const std::vector<flecs::id_t> type = ids.type_of(t.tags);
+
+        // Creating the table up front, even when empty, keeps table order
+        ecs_table_find(world.c_ptr(), type.data(), static_cast<int32_t>(type.size()));
+        if (t.rows == 0) continue;
+
+        ecs_bulk_desc_t desc = {};
+        void* data[FLECS_ID_DESC_MAX] = {};
+        for (std::size_t i = 0; i < type.size(); ++i) {
+            const flecs::id_t id = type[i];
+            desc.ids[i] = id;
+            if (id == ids.position)       data[i] = const_cast<Position*>(t.position);
+            else if (id == ids.velocity)  data[i] = const_cast<Velocity*>(t.velocity);
+            else if (id == ids.heading)   data[i] = const_cast<Heading*>(t.heading);
+            else if (id == ids.health)    data[i] = const_cast<Health*>(t.health);
+            else if (id == ids.cooldown)  data[i] = const_cast<ReproductionCooldown*>(t.cooldown);
+            else if (id == ids.uid)       data[i] = const_cast<BoidId*>(t.uid);
+            else if (id == ids.infection) data[i] = const_cast<InfectionState*>(t.infection);
+        }
+        desc.count = static_cast<int32_t>(t.rows);
+        desc.data = data;
+        const ecs_entity_t* created = ecs_bulk_init(world.c_ptr(), &desc);
+
+        // Every bit is written, whatever a new row defaults to
+        for (uint64_t row = 0; row < t.rows; ++row) {
+            const uint64_t mask = uint64_t{1} << (row % 64);
+            if (t.infected_enabled) {
+                ecs_enable_id(world.c_ptr(), created[row], ids.tags[5],
+                              (t.infected_enabled[row / 64] & mask) != 0);
+            }
+            if (t.alive_enabled) {
+                ecs_enable_id(world.c_ptr(), created[row], ids.tags[6],
+                              (t.alive_enabled[row / 64] & mask) != 0);
+            }
+        }
+    }
+
+    // Parked entities are empty, so fresh ones stand in for them: the restored
+    // world refills as many before it allocates new ids, like the saved one
+    if (globals.recycled_entities > 0) {
+        BoidRecycler* recycler = world.try_get_mut<BoidRecycler>();
+        if (!recycler) throw std::runtime_error("checkpoint: world has no BoidRecycler to re-park into");
+        for (uint64_t i = 0; i < globals.recycled_entities; ++i) {
+            recycler->free.push_back(ecs_new(world.c_ptr()));
+        }
+    }
+
+    // Singletons last: the stats observers counted the boids as they arrived
+    world.set<SimStats>(globals.stats);
+    world.set<SimClock>(globals.clock);
+    SimRng& rngs = world.get_mut<SimRng>();
+    rngs.seed = globals.rng_seed;
+    rngs.epoch = globals.rng_epoch;
+    rngs.spawned[0] = globals.rng_spawned[0];
+    rngs.spawned[1] = globals.rng_spawned[1];
+    if (PopulationHistory* history = world.try_get_mut<PopulationHistory>()) {
+        history->restore(static_cast<std::size_t>(globals.history_capacity), globals.history,
+                         globals.history_total);
+    }
+}
+
+} // namespace
+
+SimConfig read_checkpoint_config(const std::string& path) {
+    MappedFile file(path);
+    CheckpointGlobals globals;
+    std::vector<CheckpointTable> tables;
+    read_checkpoint(file.data(), file.size(), globals, tables);
+    return globals.config;
+}
+
+void save_checkpoint(flecs::world& world, const std::string& path) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) throw std::runtime_error("Cannot create checkpoint: " + path);
+    write_world(world, out);
+}
+
+void load_checkpoint(flecs::world& world, const std::string& path) {
+    MappedFile file(path);
+    restore_world(world, file.data(), file.size());
+}
+
+CheckpointImage save_checkpoint_image(flecs::world& world) {
+    std::ostringstream out(std::ios::binary);
+    write_world(world, out);
+    const std::string bytes = out.str();
+    CheckpointImage image;
+    image.bytes = bytes.size();
+    image.words.resize((bytes.size() + 7) / 8);
+    std::memcpy(image.words.data(), bytes.data(), bytes.size());
+    return image;
+}
+
+SimConfig read_checkpoint_config(const CheckpointImage& image) {
+    CheckpointGlobals globals;
+    std::vector<CheckpointTable> tables;
+    read_checkpoint(image.data(), image.bytes, globals, tables);
+    return globals.config;
+}
+
+void load_checkpoint(flecs::world& world, const CheckpointImage& image) {
+    restore_world(world, image.data(), image.bytes);
+}
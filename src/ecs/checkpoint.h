@@ -0,0 +1,57 @@
+#pragma once
+
+#include "components.h"
+#include <flecs.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ============================================================
+// World checkpoints (format: io/checkpoint.h)
+// ============================================================
+//
+// A checkpoint holds every boid's components and tags, SimConfig, SimStats,
+// the population history, SimClock and SimRng. Boid tables are written in
+// flecs table order and their rows in storage order; loading recreates the
+// tables in the same order and refills them row by row, so a restored world
+// iterates exactly like the saved one and continues bit for bit. Flecs ids
+// are not preserved (nothing in the simulation depends on them); parked
+// BoidRecycler entities are saved as a count and re-parked as fresh empty
+// entities on load.
+//
+// Resume:
+//   SimConfig config = read_checkpoint_config(path);
+//   init_world(world, config);   // parameters may be changed first
+//   register_all_systems(world); ...
+//   load_checkpoint(world, path);  // instead of spawn_initial_population
+//
+// The loaded world keeps the SimConfig it was initialized with, so a branch
+// can resume the same state under different parameters.
+
+// Writes the world's simulation state. Call between frames. Throws
+// std::runtime_error if the file cannot be written or a boid table holds
+// components the format does not know.
+void save_checkpoint(flecs::world& world, const std::string& path);
+
+// The SimConfig stored in a checkpoint, to initialize the world it is loaded into
+SimConfig read_checkpoint_config(const std::string& path);
+
+// Loads a checkpoint into a world that has no boids yet, initialized from
+// read_checkpoint_config() with any changes that keep the world's layout
+// (world size, toggle_state_tags and recycle_entities must match). Throws
+// std::runtime_error on a bad file or an incompatible world.
+void load_checkpoint(flecs::world& world, const std::string& path);
+
+// A checkpoint held in memory, 8-byte aligned: clones a world into any
+// number of others without touching the disk
+struct CheckpointImage {
+    std::vector<uint64_t> words;
+    std::size_t bytes = 0;
+
+    const uint8_t* data() const { return reinterpret_cast<const uint8_t*>(words.data()); }
+};
+
+CheckpointImage save_checkpoint_image(flecs::world& world);
+SimConfig read_checkpoint_config(const CheckpointImage& image);
+void load_checkpoint(flecs::world& world, const CheckpointImage& image);
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// ============================================================
+// Per-worker command buffers for parallel interaction systems
+// ============================================================
+//
+// Workers append (target, action) records to their own buffer without
+// locking. merge() concatenates them, sorts by (key, action) and drops
+// duplicates, so the structural edits are applied once per target and in
+// an order that does not depend on thread scheduling. The key is the
+// target's BoidId rather than its flecs id, so the order (and with it the
+// row order of the tables the targets move into) does not depend on how
+// flecs happened to allocate ids either — a world restored from a
+// checkpoint, with fresh ids, applies edits in the same order.
+
+enum class BoidAction : uint8_t {
+    Infect = 0,
+    Cure   = 1,
+};
+
+struct BoidCommand {
+    uint64_t target;   // flecs entity
+    uint64_t key;      // target's BoidId: the stable sort key
+    BoidAction action;
+};
+
+class CommandBuffers {
+public:
+    void reset(unsigned workers) {
+        buffers_.resize(workers);
+        for (auto& b : buffers_) b.clear();
+        merged_.clear();
+    }
+
+    std::vector<BoidCommand>& local(unsigned worker) { return buffers_[worker]; }
+
+    const std::vector<BoidCommand>& merge() {
+        merged_.clear();
+        for (const auto& b : buffers_) {
+            merged_.insert(merged_.end(), b.begin(), b.end());
+        }
+        std::sort(merged_.begin(), merged_.end(), [](const BoidCommand& a, const BoidCommand& b) {
+            if (a.key != b.key) return a.key < b.key;
+            return a.target != b.target ? a.target < b.target : a.action < b.action;
+        });
+        merged_.erase(std::unique(merged_.begin(), merged_.end(), [](const BoidCommand& a, const BoidCommand& b) {
+            return a.target == b.target && a.action == b.action;
+        }), merged_.end());
+        return merged_;
+    }
+
+private:
+    std::vector<std::vector<BoidCommand>> buffers_;
+    std::vector<BoidCommand> merged_;
+};
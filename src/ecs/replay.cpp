@@ -0,0 +1,190 @@
+#include "replay.h"
+#include "world.h"
+#include "systems.h"
+#include "spawn.h"
+#include "stats.h"
+#include "boid_state.h"
+#include "checkpoint.h"
+#include "io/xxhash64.h"
+#include "sim/population_history.h"
+#include "sim/rng.h"
+#include <flecs.h>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+template <typename T>
+uint64_t hash_column(uint64_t seed, const T* column, std::size_t rows) {
+    return xxh64(column, rows * sizeof(T), seed);
+}
+
+template <typename T>
+uint64_t hash_value(uint64_t seed, const T& value) {
+    return xxh64(&value, sizeof(T), seed);
+}
+
+// Archetype of a table as bits, independent of flecs ids
+uint32_t table_tags(const flecs::table& table) {
+    uint32_t tags = 0;
+    if (table.has<NormalBoid>())  tags |= 1u << 0;
+    if (table.has<DoctorBoid>())  tags |= 1u << 1;
+    if (table.has<AntivaxBoid>()) tags |= 1u << 2;
+    if (table.has<Male>())        tags |= 1u << 3;
+    if (table.has<Female>())      tags |= 1u << 4;
+    if (table.has<Infected>())    tags |= 1u << 5;
+    if (table.has<Alive>())       tags |= 1u << 6;
+    if (table.has<Dead>())        tags |= 1u << 7;
+    return tags;
+}
+
+void sync_config(ReplayRecorder& recorder, const SimConfig& current) {
+    // Byte compare: sliders write fields in place, so padding never differs
+    if (std::memcmp(&recorder.config, &current, sizeof(SimConfig)) == 0) return;
+    std::memcpy(&recorder.config, &current, sizeof(SimConfig));
+    recorder.writer->config(current);
+}
+
+} // namespace
+
+StateHasher::StateHasher(flecs::world& world)
+    : query_(world.query_builder<const Position, const Velocity, const Heading, const BoidId,
+                                 const Health*, const ReproductionCooldown*, const InfectionState*>()
+                 .cached()
+                 .build()) {}
+
+StateHash StateHasher::operator()(flecs::world& world) const {
+    StateHash h;
+    const bool toggle = world.get<SimConfig>().toggle_state_tags;
+    std::vector<uint64_t> bits;
+
+    query_.run([&](flecs::iter& it) {
+        while (it.next()) {
+            const std::size_t rows = it.count();
+            h.kinematics = hash_column(h.kinematics, &it.field<const Position>(0)[0], rows);
+            h.kinematics = hash_column(h.kinematics, &it.field<const Velocity>(1)[0], rows);
+            h.kinematics = hash_column(h.kinematics, &it.field<const Heading>(2)[0], rows);
+            h.kinematics = hash_column(h.kinematics, &it.field<const BoidId>(3)[0], rows);
+
+            const uint32_t tags = table_tags(it.table());
+            h.epidemic = hash_value(h.epidemic, tags);
+            h.epidemic = hash_value(h.epidemic, static_cast<uint64_t>(rows));
+            if (it.is_set(4)) h.epidemic = hash_column(h.epidemic, &it.field<const Health>(4)[0], rows);
+            if (it.is_set(5)) {
+                h.epidemic = hash_column(h.epidemic, &it.field<const ReproductionCooldown>(5)[0], rows);
+            }
+            if (it.is_set(6)) {
+                h.epidemic = hash_column(h.epidemic, &it.field<const InfectionState>(6)[0], rows);
+            }
+            if (toggle) {
+                // Two bits per row: Infected, Alive
+                bits.assign((rows * 2 + 63) / 64, 0);
+                TableInfected infected(it, toggle);
+                for (std::size_t i = 0; i < rows; ++i) {
+                    if (infected(it, i)) bits[(2 * i) / 64] |= uint64_t{1} << ((2 * i) % 64);
+                    if (it.entity(i).enabled<Alive>()) {
+                        bits[(2 * i + 1) / 64] |= uint64_t{1} << ((2 * i + 1) % 64);
+                    }
+                }
+                h.epidemic = hash_column(h.epidemic, bits.data(), bits.size());
+            }
+        }
+    });
+
+    const SimStats& stats = world.get<SimStats>();
+    h.globals = hash_value(h.globals, stats);
+    const SimClock& clock = world.get<SimClock>();
+    h.globals = hash_value(h.globals, clock.time);
+    h.globals = hash_value(h.globals, clock.frame);
+    if (const SimRng* rngs = world.try_get<SimRng>()) {
+        const uint64_t rng[4] = {rngs->seed, rngs->epoch, rngs->spawned[0], rngs->spawned[1]};
+        h.globals = hash_value(h.globals, rng);
+    }
+    if (const PopulationHistory* history = world.try_get<PopulationHistory>()) {
+        h.globals = hash_value(h.globals, static_cast<uint64_t>(history->total_samples()));
+    }
+    return h;
+}
+
+void open_replay_log(flecs::world& world, const std::string& path) {
+    const CheckpointImage image = save_checkpoint_image(world);
+    ReplayRecorder recorder;
+    recorder.hasher = std::make_shared<StateHasher>(world);
+    recorder.writer = std::make_shared<ReplayLogWriter>(path, image.data(), image.bytes,
+                                                        (*recorder.hasher)(world));
+    std::memcpy(&recorder.config, &world.get<SimConfig>(), sizeof(SimConfig));
+    world.set<ReplayRecorder>(recorder);
+}
+
+void record_replay_reset(flecs::world& world) {
+    ReplayRecorder* recorder = world.try_get_mut<ReplayRecorder>();
+    if (!recorder || !recorder->writer) return;
+    sync_config(*recorder, world.get<SimConfig>());
+    recorder->writer->reset();
+}
+
+void record_replay_frame(flecs::world& world, float dt) {
+    ReplayRecorder* recorder = world.try_get_mut<ReplayRecorder>();
+    if (!recorder || !recorder->writer) return;
+    sync_config(*recorder, world.get<SimConfig>());
+    ReplayFrame frame;
+    frame.frame = world.get<SimClock>().frame;
+    frame.dt = dt;
+    frame.hash = (*recorder->hasher)(world);
+    recorder->writer->frame(frame);
+}
+
+void close_replay_log(flecs::world& world) {
+    const ReplayRecorder* recorder = world.try_get<ReplayRecorder>();
+    if (!recorder) return;
+    if (recorder->writer) recorder->writer->flush();
+    world.remove<ReplayRecorder>();
+}
+
+ReplayCheck replay_log(const ReplayLog& log, int sim_threads) {
+    CheckpointImage image;
+    image.words = log.image;
+    image.bytes = log.image_bytes;
+    SimConfig config = read_checkpoint_config(image);
+    config.sim_threads = sim_threads;
+
+    flecs::world world;
+    init_world(world, config);
+    register_all_systems(world);
+    register_stats_system(world);
+    // Render snapshots do not feed back into the simulation
+    if (flecs::entity render_sync = world.lookup("RenderSyncSystem")) render_sync.disable();
+    load_checkpoint(world, image);
+    const StateHasher hasher(world);
+
+    ReplayCheck check;
+    check.start_matches = hasher(world) == log.start;
+    if (!check.start_matches) return check;
+    for (const ReplayEvent& event : log.events) {
+        switch (event.type) {
+            case ReplayRecord::Config: {
+                SimConfig changed = event.config;
+                changed.sim_threads = sim_threads;
+                world.set<SimConfig>(changed);
+                break;
+            }
+            case ReplayRecord::Reset:
+                reset_simulation(world);
+                break;
+            case ReplayRecord::Frame: {
+                world.progress(event.frame.dt);
+                ReplayFrame frame;
+                frame.frame = world.get<SimClock>().frame;
+                frame.dt = event.frame.dt;
+                frame.hash = hasher(world);
+                check.frames.push_back(frame);
+                if (frame.frame != event.frame.frame || frame.hash != event.frame.hash) {
+                    check.divergent = static_cast<long long>(check.frames.size() - 1);
+                    return check;
+                }
+                break;
+            }
+        }
+    }
+    return check;
+}
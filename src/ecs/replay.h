@@ -0,0 +1,62 @@
+#pragma once
+
+#include "components.h"
+#include "io/replay_log.h"
+#include <flecs.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+// ============================================================
+// Deterministic replay: per-frame state hashes and input logs
+// ============================================================
+//
+// A replay log (format: io/replay_log.h) records a run's starting world and
+// every input after it: dt per frame, SimConfig changes (UI sliders) and
+// resets, plus an XXH64 hash of the world after each frame. Re-simulating
+// the log must reproduce every hash; the first frame that does not is where
+// two builds, machines or thread counts stop agreeing.
+
+// Hashes boid columns in table and row order, per-row toggle bits and the
+// global singletons. Keeps its query, so build one per world and reuse it.
+class StateHasher {
+public:
+    explicit StateHasher(flecs::world& world);
+    StateHash operator()(flecs::world& world) const;
+
+private:
+    flecs::query<const Position, const Velocity, const Heading, const BoidId,
+                 const Health*, const ReproductionCooldown*, const InfectionState*> query_;
+};
+
+// Singleton: present only while the run is logging (--replay-log).
+// Shared so the per-frame singleton copy stays cheap.
+struct ReplayRecorder {
+    std::shared_ptr<ReplayLogWriter> writer;
+    std::shared_ptr<StateHasher> hasher;
+    SimConfig config{};   // last config written to the log
+};
+
+// Starts logging the populated world to path (its current state is the
+// log's starting point). Throws std::runtime_error if the file cannot be created.
+void open_replay_log(flecs::world& world, const std::string& path);
+
+// Call right after reset_simulation()
+void record_replay_reset(flecs::world& world);
+
+// Call right after world.progress(dt); logs any SimConfig change first
+void record_replay_frame(flecs::world& world, float dt);
+
+// Flushes and closes the log (if any) and removes the singleton
+void close_replay_log(flecs::world& world);
+
+struct ReplayCheck {
+    bool start_matches = false;        // the restored starting world hashes as logged
+    std::vector<ReplayFrame> frames;   // replayed, up to the first divergent one
+    long long divergent = -1;          // index of the first divergent frame, -1 = none
+};
+
+// Re-simulates `log` in a fresh world with `sim_threads` workers (as
+// SimConfig::sim_threads), stopping at the first frame whose hash differs
+// from the logged one (or before the first frame if the starting world does).
+ReplayCheck replay_log(const ReplayLog& log, int sim_threads);
@@ -0,0 +1,56 @@
+#include "runner.h"
+#include <chrono>
+
+HeadlessResult run_headless(flecs::world& world, const HeadlessOptions& options) {
+    // Render snapshots are pure overhead without a window
+    if (flecs::entity render_sync = world.lookup("RenderSyncSystem")) {
+        if (options.render_sync) {
+            render_sync.enable();
+        } else {
+            render_sync.disable();
+        }
+    }
+
+    const StopConditions conditions = options.stop_conditions
+        ? stop_conditions_from(world.get<SimConfig>())
+        : StopConditions{};
+    StopMonitor monitor(conditions);
+    const bool monitoring = conditions.any();
+
+    HeadlessResult result;
+    const auto start = std::chrono::steady_clock::now();
+
+    for (;;) {
+        if (options.max_frames > 0 && result.frames >= options.max_frames) {
+            result.stop_reason = StopReason::FrameLimit;
+            break;
+        }
+        if (options.max_time > 0.0 && result.sim_time >= options.max_time) {
+            result.stop_reason = StopReason::TimeLimit;
+            break;
+        }
+
+        world.progress(options.dt);
+        result.frames++;
+        result.sim_time += options.dt;
+        if (options.on_frame) options.on_frame(world);
+
+        if (options.stop_on_extinction) {
+            const SimStats& stats = world.get<SimStats>();
+            if (stats.normal_alive + stats.doctor_alive + stats.antivax_alive == 0) {
+                result.extinct = true;
+                result.stop_reason = StopReason::Extinct;
+                break;
+            }
+        }
+        if (monitoring) {
+            result.stop_reason = monitor.update(result.sim_time, world.get<SimStats>());
+            if (result.stop_reason != StopReason::None) break;
+        }
+    }
+
+    const auto end = std::chrono::steady_clock::now();
+    result.wall_seconds = std::chrono::duration<double>(end - start).count();
+    result.final_stats = world.get<SimStats>();
+    return result;
+}
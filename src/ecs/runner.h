@@ -0,0 +1,43 @@
+#pragma once
+
+#include "components.h"
+#include "sim/stop_monitor.h"
+#include <flecs.h>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// ============================================================
+// Headless stepping — no window, no vsync, fixed time step
+// ============================================================
+
+struct HeadlessOptions {
+    float dt = 1.0f / 60.0f;        // fixed simulated seconds per frame
+    uint64_t max_frames = 3600;     // 0 = no frame limit
+    double max_time = 0.0;          // simulated seconds; 0 = no time limit
+    bool stop_on_extinction = true; // nothing can change once every boid is dead
+    bool stop_conditions = true;    // honour the config's stop_* keys (see sim/stop_monitor.h)
+    bool render_sync = false;       // keep RenderSyncSystem (needed for trajectory recording)
+    std::function<void(flecs::world&)> on_frame;  // optional, called after every stepped frame
+    std::string burn_in_cache;      // burn-in snapshot directory for worlds the batch runners
+                                    // spawn (sweep_runner.h); "" = keep snapshots in memory only
+};
+
+struct HeadlessResult {
+    uint64_t frames = 0;            // frames stepped by this call
+    double sim_time = 0.0;          // simulated seconds stepped by this call
+    double wall_seconds = 0.0;
+    bool extinct = false;
+    StopReason stop_reason = StopReason::None;   // why stepping ended
+    SimStats final_stats{};
+
+    double sim_seconds_per_wall_second() const {
+        return wall_seconds > 0.0 ? sim_time / wall_seconds : 0.0;
+    }
+};
+
+// Steps world.progress(dt) until a limit or stop condition is hit, as fast as
+// the CPU allows. Stop conditions are read from the world's SimConfig once,
+// at the start of the call. The world must already be initialized, have its systems
+// registered and be populated.
+HeadlessResult run_headless(flecs::world& world, const HeadlessOptions& options);
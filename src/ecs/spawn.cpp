@@ -1,14 +1,193 @@
 #include "spawn.h"
 #include "components.h"
 #include "spatial_grid.h"
+#include "boid_state.h"
+#include "sim/population_history.h"
+#include "sim/rng.h"
 #include <flecs.h>
 #include <random>
 #include <cmath>
 #include <algorithm>
+#include <vector>
 
 namespace {
-    // Seeded random engine for reproducible spawning
-    std::mt19937 rng(42);
+    template <typename SwarmTag, typename SexTag>
+    flecs::entity_t make_prefab(flecs::world& world, const char* name, bool toggle) {
+        auto prefab = world.prefab(name)
+            .add<SwarmTag>()
+            .add<SexTag>()
+            .add<Alive>()
+            .set(Position{0.0f, 0.0f})
+            .set(Velocity{0.0f, 0.0f})
+            .set(Heading{0.0f})
+            .set(Health{0.0f, 60.0f}) // age=0, lifespan=60s
+            .set(ReproductionCooldown{0.0f})
+            .set(BoidId{0});
+        if (toggle) {
+            // Toggle mode: every boid carries the infection columns and both
+            // toggle bitsets, so an infection, cure or death later only flips
+            // a bit and writes in place
+            prefab.add<Infected>();
+            prefab.set(InfectionState{0.0f, 0.0f});
+            prefab.add(state_toggle_id<Infected>(world));
+            prefab.add(state_toggle_id<Alive>(world));
+        }
+        return prefab.id();
+    }
+
+    // Column storage for one archetype group
+    struct SpawnGroup {
+        bool infected = false;
+        std::vector<Position> pos;
+        std::vector<Velocity> vel;
+        std::vector<Heading> heading;
+        std::vector<Health> health;
+        std::vector<ReproductionCooldown> cooldown;
+        std::vector<BoidId> uid;
+        std::vector<InfectionState> infection;
+    };
+}
+
+const BoidPrefabs& ensure_boid_prefabs(flecs::world& world) {
+    if (const BoidPrefabs* existing = world.try_get<BoidPrefabs>()) {
+        return *existing;
+    }
+
+    bool toggle = world.get<SimConfig>().toggle_state_tags;
+    BoidPrefabs prefabs;
+    prefabs.prefab[0][0] = make_prefab<NormalBoid, Female>(world, "boid_normal_female", toggle);
+    prefabs.prefab[0][1] = make_prefab<NormalBoid, Male>(world, "boid_normal_male", toggle);
+    prefabs.prefab[1][0] = make_prefab<DoctorBoid, Female>(world, "boid_doctor_female", toggle);
+    prefabs.prefab[1][1] = make_prefab<DoctorBoid, Male>(world, "boid_doctor_male", toggle);
+    prefabs.prefab[2][0] = make_prefab<AntivaxBoid, Female>(world, "boid_antivax_female", toggle);
+    prefabs.prefab[2][1] = make_prefab<AntivaxBoid, Male>(world, "boid_antivax_male", toggle);
+    world.set<BoidPrefabs>(prefabs);
+    return world.get<BoidPrefabs>();
+}
+
+void spawn_boids(flecs::world& world, const std::vector<SpawnSpec>& specs) {
+    if (specs.empty()) return;
+
+    const SimConfig& config = world.get<SimConfig>();
+    const BoidPrefabs prefabs = ensure_boid_prefabs(world);
+    bool toggle = config.toggle_state_tags;
+    BoidRecycler* recycler = config.recycle_entities ? world.try_get_mut<BoidRecycler>() : nullptr;
+    SimStats* stats = toggle ? world.try_get_mut<SimStats>() : nullptr;
+    int SimStats::* const alive_counter[3] = {&SimStats::normal_alive, &SimStats::doctor_alive,
+                                              &SimStats::antivax_alive};
+    std::vector<ecs_entity_t> ids;
+
+    // Fields SpawnSpec does not carry come from the prefab
+    Health prefab_health[3][2];
+    for (int swarm = 0; swarm < 3; ++swarm) {
+        for (int male = 0; male < 2; ++male) {
+            prefab_health[swarm][male] = world.entity(prefabs.prefab[swarm][male]).get<Health>();
+        }
+    }
+
+    // Group by archetype: [swarm_type][male][infected]
+    SpawnGroup groups[3][2][2];
+    for (const SpawnSpec& s : specs) {
+        SpawnGroup& g = groups[s.swarm_type][s.male ? 1 : 0][s.infected ? 1 : 0];
+        g.infected = s.infected;
+        g.pos.push_back(Position{s.x, s.y});
+        g.vel.push_back(Velocity{s.vx, s.vy});
+        g.heading.push_back(Heading{s.heading});
+        g.health.push_back(prefab_health[s.swarm_type][s.male ? 1 : 0]);
+        g.cooldown.push_back(ReproductionCooldown{s.cooldown});
+        g.uid.push_back(BoidId{s.uid});
+        g.infection.push_back(InfectionState{0.0f, config.t_death});
+    }
+
+    const flecs::id_t id_position = world.id<Position>().raw_id();
+    const flecs::id_t id_velocity = world.id<Velocity>().raw_id();
+    const flecs::id_t id_heading = world.id<Heading>().raw_id();
+    const flecs::id_t id_health = world.id<Health>().raw_id();
+    const flecs::id_t id_cooldown = world.id<ReproductionCooldown>().raw_id();
+    const flecs::id_t id_uid = world.id<BoidId>().raw_id();
+    const flecs::id_t id_infection = world.id<InfectionState>().raw_id();
+    const flecs::id_t id_infected = world.id<Infected>().raw_id();
+    const flecs::id_t id_alive = world.id<Alive>().raw_id();
+    const flecs::id_t id_infected_toggle = state_toggle_id<Infected>(world);
+    const flecs::id_t id_alive_toggle = state_toggle_id<Alive>(world);
+
+    for (int swarm = 0; swarm < 3; ++swarm) {
+        for (int male = 0; male < 2; ++male) {
+            for (int inf = 0; inf < 2; ++inf) {
+                SpawnGroup& g = groups[swarm][male][inf];
+                if (g.pos.empty()) continue;
+
+                ecs_bulk_desc_t desc = {};
+                void* data[FLECS_ID_DESC_MAX] = {};
+                int32_t n = 0;
+                bool has_infected = false;
+                bool has_infection = false;
+                bool has_toggles[2] = {false, false};
+
+                // Archetype = prefab type (minus Prefab and name pairs)
+                const ecs_type_t* type = ecs_get_type(world.c_ptr(), prefabs.prefab[swarm][male]);
+                for (int32_t i = 0; i < type->count; ++i) {
+                    flecs::id_t id = type->array[i];
+                    if (id == EcsPrefab || ECS_IS_PAIR(id)) continue;
+                    desc.ids[n] = id;
+                    if (id == id_position)       data[n] = g.pos.data();
+                    else if (id == id_velocity)  data[n] = g.vel.data();
+                    else if (id == id_heading)   data[n] = g.heading.data();
+                    else if (id == id_health)    data[n] = g.health.data();
+                    else if (id == id_cooldown)  data[n] = g.cooldown.data();
+                    else if (id == id_uid)       data[n] = g.uid.data();
+                    else if (id == id_infection) { data[n] = g.infection.data(); has_infection = true; }
+                    else if (id == id_infected)  has_infected = true;
+                    else if (id == id_infected_toggle) has_toggles[0] = true;
+                    else if (id == id_alive_toggle)    has_toggles[1] = true;
+                    n++;
+                }
+                // Toggle mode: bulk init lands in the table with both bitsets,
+                // so setting the bits below never moves an entity
+                if (toggle && !has_toggles[0]) desc.ids[n++] = id_infected_toggle;
+                if (toggle && !has_toggles[1]) desc.ids[n++] = id_alive_toggle;
+                if (g.infected && !has_infected) {
+                    desc.ids[n++] = id_infected;
+                }
+                if (g.infected && !has_infection) {
+                    desc.ids[n] = id_infection;
+                    data[n++] = g.infection.data();
+                }
+
+                desc.count = static_cast<int32_t>(g.pos.size());
+                desc.data = data;
+
+                // Recycling: refill parked (empty) entities first, new ids for the rest
+                if (recycler) {
+                    ids.clear();
+                    while (static_cast<int32_t>(ids.size()) < desc.count && !recycler->free.empty()) {
+                        ids.push_back(recycler->free.back());
+                        recycler->free.pop_back();
+                    }
+                    while (static_cast<int32_t>(ids.size()) < desc.count) {
+                        ids.push_back(ecs_new(world.c_ptr()));
+                    }
+                    desc.entities = ids.data();
+                }
+
+                const ecs_entity_t* created = ecs_bulk_init(world.c_ptr(), &desc);
+
+                // Toggle mode: healthy boids carry a disabled Infected. Bits are
+                // written in place, both of them, whatever a new row defaults to.
+                // No observer counts bits, so the live counters are kept here
+                if (toggle) {
+                    for (int32_t i = 0; i < desc.count; ++i) {
+                        ecs_enable_id(world.c_ptr(), created[i], id_infected, g.infected);
+                        ecs_enable_id(world.c_ptr(), created[i], id_alive, true);
+                    }
+                    if (stats) {
+                        stats->*alive_counter[swarm] += desc.count;
+                        if (g.infected) stats->infected_alive += desc.count;
+                    }
+                }
+            }
+        }
+    }
 }
 
 void spawn_normal_boids(flecs::world& world, int count) {
@@ -20,41 +199,36 @@ void spawn_normal_boids(flecs::world& world, int count) {
     std::uniform_real_distribution<float> dist_sex(0.0f, 1.0f);
     std::uniform_real_distribution<float> dist_infect(0.0f, 1.0f);
     std::uniform_real_distribution<float> dist_antivax(0.0f, 1.0f);
+    SimRng& rngs = world.get_mut<SimRng>();
 
+    std::vector<SpawnSpec> specs;
+    specs.reserve(static_cast<std::size_t>(std::max(0, count)));
     for (int i = 0; i < count; ++i) {
-        float x = dist_x(rng);
-        float y = dist_y(rng);
-        float angle = dist_angle(rng);
+        SpawnSpec s{};
+        // The i-th boid of a cohort draws the same numbers in every run with
+        // this seed, whatever the spawn probabilities are
+        s.uid = root_boid_uid(rngs.epoch, 0, rngs.spawned[0]++);
+        KeyedRng rng(rngs.seed, 0, s.uid, RngPurpose::Spawn);
+        s.x = dist_x(rng);
+        s.y = dist_y(rng);
+        s.heading = dist_angle(rng);
         float speed = config.max_speed * 1.0f; // Start with moderate speed
-
-        auto boid = world.entity()
-            .add<Alive>()
-            .set(Position{x, y})
-            .set(Velocity{speed * std::cos(angle), speed * std::sin(angle)})
-            .set(Heading{angle})
-            .set(Health{0.0f, 60.0f}) // age=0, lifespan=60s
-            .set(ReproductionCooldown{0.0f});
+        s.vx = speed * std::cos(s.heading);
+        s.vy = speed * std::sin(s.heading);
+        s.cooldown = 0.0f;
 
         // Assign sex
-        if (dist_sex(rng) < 0.5f) {
-            boid.add<Male>();
-        } else {
-            boid.add<Female>();
-        }
+        s.male = dist_sex(rng) < 0.5f;
 
         // Assign swarm tag — mutually exclusive
-        if (dist_antivax(rng) < config.p_antivax) {
-            boid.add<AntivaxBoid>();
-        } else {
-            boid.add<NormalBoid>();
-        }
+        s.swarm_type = (dist_antivax(rng) < config.p_antivax) ? 2 : 0;
 
         // Initial infection
-        if (dist_infect(rng) < config.p_initial_infect_normal) {
-            boid.add<Infected>();
-            boid.set(InfectionState{0.0f, config.t_death});
-        }
+        s.infected = dist_infect(rng) < config.p_initial_infect_normal;
+        specs.push_back(s);
     }
+
+    spawn_boids(world, specs);
 }
 
 void spawn_doctor_boids(flecs::world& world, int count) {
@@ -65,35 +239,32 @@ void spawn_doctor_boids(flecs::world& world, int count) {
     std::uniform_real_distribution<float> dist_angle(0.0f, 2.0f * 3.14159265f);
     std::uniform_real_distribution<float> dist_sex(0.0f, 1.0f);
     std::uniform_real_distribution<float> dist_infect(0.0f, 1.0f);
+    SimRng& rngs = world.get_mut<SimRng>();
 
+    std::vector<SpawnSpec> specs;
+    specs.reserve(static_cast<std::size_t>(std::max(0, count)));
     for (int i = 0; i < count; ++i) {
-        float x = dist_x(rng);
-        float y = dist_y(rng);
-        float angle = dist_angle(rng);
+        SpawnSpec s{};
+        s.swarm_type = 1;
+        s.uid = root_boid_uid(rngs.epoch, 1, rngs.spawned[1]++);
+        KeyedRng rng(rngs.seed, 0, s.uid, RngPurpose::Spawn);
+        s.x = dist_x(rng);
+        s.y = dist_y(rng);
+        s.heading = dist_angle(rng);
         float speed = config.max_speed * 1.0f; // Start with moderate speed
-
-        auto boid = world.entity()
-            .add<DoctorBoid>()
-            .add<Alive>()
-            .set(Position{x, y})
-            .set(Velocity{speed * std::cos(angle), speed * std::sin(angle)})
-            .set(Heading{angle})
-            .set(Health{0.0f, 60.0f}) // age=0, lifespan=60s
-            .set(ReproductionCooldown{0.0f});
+        s.vx = speed * std::cos(s.heading);
+        s.vy = speed * std::sin(s.heading);
+        s.cooldown = 0.0f;
 
         // Assign sex
-        if (dist_sex(rng) < 0.5f) {
-            boid.add<Male>();
-        } else {
-            boid.add<Female>();
-        }
+        s.male = dist_sex(rng) < 0.5f;
 
         // Initial infection
-        if (dist_infect(rng) < config.p_initial_infect_doctor) {
-            boid.add<Infected>();
-            boid.set(InfectionState{0.0f, config.t_death});
-        }
+        s.infected = dist_infect(rng) < config.p_initial_infect_doctor;
+        specs.push_back(s);
     }
+
+    spawn_boids(world, specs);
 }
 
 void spawn_initial_population(flecs::world& world) {
@@ -116,6 +287,14 @@ void reset_simulation(flecs::world& world) {
         e.destruct();
     });
 
+    // Parked entities have no Position; release them with the rest
+    if (BoidRecycler* recycler = world.try_get_mut<BoidRecycler>()) {
+        for (flecs::entity_t id : recycler->free) {
+            world.entity(id).destruct();
+        }
+        recycler->free.clear();
+    }
+
     world.defer_end();
 
     // Reset statistics and population history
@@ -131,10 +310,19 @@ void reset_simulation(flecs::world& world) {
     stats.antivax_alive = 0;
     stats.dead_antivax = 0;
     stats.newborns_antivax = 0;
-    stats.history_index = 0;
-    stats.history_count = 0;
-    for (int i = 0; i < SimStats::HISTORY_SIZE; ++i) {
-        stats.history[i] = {};
+    stats.infected_alive = 0;
+    if (PopulationHistory* history = world.try_get_mut<PopulationHistory>()) {
+        history->clear();
+    }
+
+    // Restart the simulation clock (infection tick phases are relative to it)
+    world.set<SimClock>({});
+
+    // New epoch: the re-spawned population gets fresh ids and random streams
+    if (SimRng* rngs = world.try_get_mut<SimRng>()) {
+        rngs->epoch++;
+        rngs->spawned[0] = 0;
+        rngs->spawned[1] = 0;
     }
 
     // Rebuild spatial grid with current config (sliders may have changed radii).
@@ -143,6 +331,8 @@ void reset_simulation(flecs::world& world) {
     float cell_size = std::max(config.r_interact_normal, config.r_interact_doctor);
     SpatialGrid new_grid(config.world_width, config.world_height, cell_size);
     world.set<SpatialGrid>(std::move(new_grid));
+    InteractionIndex new_index(config.world_width, config.world_height, cell_size);
+    world.set<InteractionIndex>(std::move(new_index));
 
     // Re-spawn initial population
     spawn_initial_population(world);
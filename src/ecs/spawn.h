@@ -1,6 +1,47 @@
 #pragma once
 
 #include <flecs.h>
+#include <cstdint>
+#include <vector>
+
+// ============================================================
+// Boid prefabs and batched spawning
+// ============================================================
+
+// Everything needed to place one boid in its final archetype
+struct SpawnSpec {
+    uint8_t swarm_type;        // 0=normal, 1=doctor, 2=antivax (as SpatialGrid::Entry)
+    bool male;
+    bool infected;
+    float x, y;
+    float vx, vy;
+    float heading;
+    float cooldown;            // initial ReproductionCooldown
+    uint64_t uid;              // BoidId (root_boid_uid / child_boid_uid)
+};
+
+// One prefab per swarm x sex. A prefab's type is the archetype its boids are
+// created in (plus Infected/InfectionState for infected spawns), and its
+// component values are the defaults for fields SpawnSpec does not carry.
+struct BoidPrefabs {
+    flecs::entity_t prefab[3][2] = {};  // [swarm_type][male]
+};
+
+// Dead boids parked for reuse when SimConfig::recycle_entities is set. Parked
+// entities are cleared (alive but without components), so no query — stats,
+// render sync or otherwise — can observe them until spawn_boids refills them.
+struct BoidRecycler {
+    std::vector<flecs::entity_t> free;
+};
+
+// Creates the BoidPrefabs singleton if the world does not have it yet
+const BoidPrefabs& ensure_boid_prefabs(flecs::world& world);
+
+// Creates all boids in `specs`, grouped by archetype, one ecs_bulk_init per
+// group. Parked entities from BoidRecycler are reused first. Must not be called
+// while the world is deferred (from inside a system use an immediate system
+// with defer_suspend).
+void spawn_boids(flecs::world& world, const std::vector<SpawnSpec>& specs);
 
 void spawn_normal_boids(flecs::world& world, int count);
 void spawn_doctor_boids(flecs::world& world, int count);
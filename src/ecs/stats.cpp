@@ -1,55 +1,114 @@
 #include "stats.h"
 #include "components.h"
+#include "sim/population_history.h"
+#include "io/stats_stream.h"
 #include <flecs.h>
+#include <algorithm>
+#include <iostream>
+
+namespace {
+    // Keeps one SimStats counter equal to the number of entities matching
+    // the observer's terms. Monitor fires OnAdd when an entity starts matching
+    // and OnRemove when it stops (tag removed, table change or deletion).
+    void count_on_monitor(flecs::iter& it, int SimStats::* counter) {
+        SimStats* stats = it.world().try_get_mut<SimStats>();
+        if (!stats) return;
+        stats->*counter += (it.event() == flecs::OnAdd) ? 1 : -1;
+    }
+
+    // Entities a query yields; iteration skips rows with a disabled tag
+    template <typename Query>
+    int count_matching(const Query& q) {
+        int n = 0;
+        q.run([&n](flecs::iter& it) {
+            while (it.next()) n += static_cast<int>(it.count());
+        });
+        return n;
+    }
+}
 
 void register_stats_system(flecs::world& world) {
+    if (world.get<SimConfig>().toggle_state_tags) {
+        // Toggle mode flips enabled bits, which emit no add/remove events:
+        // the state helpers and spawn_boids keep the counters instead
+        // (boid_state.h). Seed them once from the boids that already exist.
+        SimStats& stats = world.get_mut<SimStats>();
+        stats.normal_alive = count_matching(world.query_builder<const NormalBoid, const Alive>().build());
+        stats.doctor_alive = count_matching(world.query_builder<const DoctorBoid, const Alive>().build());
+        stats.antivax_alive = count_matching(world.query_builder<const AntivaxBoid, const Alive>().build());
+        stats.infected_alive = count_matching(world.query_builder<const Alive, const Infected>().build());
+    } else {
+        // Live population counters, maintained incrementally. yield_existing
+        // seeds them with entities created before registration.
+        world.observer<>("CountNormalAlive")
+            .with<NormalBoid>().with<Alive>()
+            .event(flecs::Monitor)
+            .yield_existing()
+            .each([](flecs::iter& it, size_t) { count_on_monitor(it, &SimStats::normal_alive); });
+        world.observer<>("CountDoctorAlive")
+            .with<DoctorBoid>().with<Alive>()
+            .event(flecs::Monitor)
+            .yield_existing()
+            .each([](flecs::iter& it, size_t) { count_on_monitor(it, &SimStats::doctor_alive); });
+        world.observer<>("CountAntivaxAlive")
+            .with<AntivaxBoid>().with<Alive>()
+            .event(flecs::Monitor)
+            .yield_existing()
+            .each([](flecs::iter& it, size_t) { count_on_monitor(it, &SimStats::antivax_alive); });
+        world.observer<>("CountInfectedAlive")
+            .with<Alive>().with<Infected>()
+            .event(flecs::Monitor)
+            .yield_existing()
+            .each([](flecs::iter& it, size_t) { count_on_monitor(it, &SimStats::infected_alive); });
+    }
+
+    // Note: dead_total, dead_normal, dead_doctor, newborns_* are cumulative
+    // and updated by the death and reproduction systems. The per-frame step
+    // only records population history.
     world.system("UpdateStatsSystem")
         .kind(flecs::OnStore)
         .run([](flecs::iter& it) {
             flecs::world w = it.world();
-            SimStats& stats = w.get_mut<SimStats>();
-
-            // Reset per-frame counters (deaths and newborns are cumulative)
-            stats.normal_alive = 0;
-            stats.doctor_alive = 0;
-            stats.antivax_alive = 0;
-
-            // Count alive normal boids
-            auto q_normal = w.query<const NormalBoid, const Alive>();
-            q_normal.each([&stats](const NormalBoid&, const Alive&) {
-                stats.normal_alive++;
-            });
-
-            // Count alive doctor boids
-            auto q_doctor = w.query<const DoctorBoid, const Alive>();
-            q_doctor.each([&stats](const DoctorBoid&, const Alive&) {
-                stats.doctor_alive++;
-            });
-
-            // Count alive antivax boids
-            auto q_antivax = w.query<const AntivaxBoid, const Alive>();
-            q_antivax.each([&stats](const AntivaxBoid&, const Alive&) {
-                stats.antivax_alive++;
-            });
-
-            // Note: dead_total, dead_normal, dead_doctor, newborns_* are cumulative
-            // and updated by the death and reproduction systems
-
-            // Count total infected across all swarms
-            int infected_count = 0;
-            auto q_infected = w.query<const Alive, const Infected>();
-            q_infected.each([&infected_count](const Alive&, const Infected&) {
-                infected_count++;
-            });
-
-            // Record population history for graph
-            stats.history[stats.history_index].normal_alive = stats.normal_alive;
-            stats.history[stats.history_index].doctor_alive = stats.doctor_alive;
-            stats.history[stats.history_index].antivax_alive = stats.antivax_alive;
-            stats.history[stats.history_index].infected_count = infected_count;
-            stats.history_index = (stats.history_index + 1) % SimStats::HISTORY_SIZE;
-            if (stats.history_count < SimStats::HISTORY_SIZE) {
-                stats.history_count++;
+            const SimStats& stats = w.get<SimStats>();
+            if (PopulationHistory* history = w.try_get_mut<PopulationHistory>()) {
+                PopulationHistoryPoint point;
+                point.normal_alive = stats.normal_alive;
+                point.doctor_alive = stats.doctor_alive;
+                point.antivax_alive = stats.antivax_alive;
+                point.infected_count = stats.infected_alive;
+                history->push(point);
             }
         });
+
+    // Hand the frame's counters to the background writer (never blocks)
+    world.system("StatsStreamSystem")
+        .kind(flecs::OnStore)
+        .run([](flecs::iter& it) {
+            flecs::world w = it.world();
+            const StatsStream* stream = w.try_get<StatsStream>();
+            if (!stream || !stream->writer) return;
+
+            const SimClock& clock = w.get<SimClock>();
+            const int interval = std::max(1, w.get<SimConfig>().stats_stream_interval);
+            if (clock.frame % static_cast<uint64_t>(interval) != 0) return;
+
+            stream->writer->push(make_stats_record(clock.frame, clock.time, w.get<SimStats>()));
+        });
+}
+
+void open_stats_stream(flecs::world& world, const std::string& path) {
+    world.set<StatsStream>({std::make_shared<StatsStreamWriter>(path)});
+}
+
+void close_stats_stream(flecs::world& world) {
+    const StatsStream* stream = world.try_get<StatsStream>();
+    if (!stream) return;
+    if (stream->writer) {
+        stream->writer->close();
+        if (stream->writer->dropped() > 0) {
+            std::cerr << "Stats stream dropped " << stream->writer->dropped()
+                      << " records (writer fell behind)\n";
+        }
+    }
+    world.remove<StatsStream>();
 }
@@ -1,5 +1,22 @@
 #pragma once
 
 #include <flecs.h>
+#include <memory>
+#include <string>
+
+class StatsStreamWriter;
+
+// Singleton: present only when the run streams stats to disk (--stats-out).
+// Shared so the per-frame singleton copy stays cheap.
+struct StatsStream {
+    std::shared_ptr<StatsStreamWriter> writer;
+};
 
 void register_stats_system(flecs::world& world);
+
+// Opens a stats stream at path and installs the StatsStream singleton.
+// Throws std::runtime_error if the file cannot be created.
+void open_stats_stream(flecs::world& world, const std::string& path);
+
+// Flushes and closes the stream (if any) and removes the singleton
+void close_stats_stream(flecs::world& world);
@@ -0,0 +1,357 @@
+#include "sweep_runner.h"
+#include "world.h"
+#include "systems.h"
+#include "spawn.h"
+#include "stats.h"
+#include "burn_in.h"
+#include "worker_pool.h"
+#include "config_loader.h"
+#include "io/stats_stream.h"
+#include "sim/ensemble.h"
+#include "sim/rng.h"
+#include <flecs.h>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// Builds a serial, populated headless world for one run
+std::unique_ptr<flecs::world> make_run_world(SimConfig config, const HeadlessOptions& options) {
+    config.sim_threads = 1;
+    std::unique_ptr<flecs::world> world;
+    {
+        std::lock_guard<std::mutex> lock(world_lifetime_mutex());
+        world = std::make_unique<flecs::world>();
+        init_world(*world, config);
+        register_all_systems(*world);
+        register_stats_system(*world);
+    }
+    spawn_settled_population(*world, options.dt, options.burn_in_cache);
+    return world;
+}
+
+void destroy_run_world(std::unique_ptr<flecs::world>& world) {
+    std::lock_guard<std::mutex> lock(world_lifetime_mutex());
+    world.reset();
+}
+
+SweepPointResult run_point(const SimConfig& base,
+                           const std::vector<SweepParam>& params,
+                           const std::vector<double>& values,
+                           std::size_t index,
+                           const HeadlessOptions& options) {
+    SweepPointResult point;
+    point.index = index;
+    point.values = values;
+
+    std::unique_ptr<flecs::world> world;
+    try {
+        SimConfig config = base;
+        for (std::size_t k = 0; k < params.size(); ++k) {
+            // Range levels on integer keys can fall between integers
+            // (10:15:3 gives 12.5); run and record the rounded value
+            if (is_integer_config_key(params[k].key)) point.values[k] = std::round(values[k]);
+            if (!set_config_value(config, params[k].key, format_sweep_value(point.values[k]))) {
+                throw std::runtime_error("unknown config key '" + params[k].key + "'");
+            }
+        }
+        world = make_run_world(config, options);
+        point.result = run_headless(*world, options);
+    } catch (const std::exception& e) {
+        point.error = e.what();
+    }
+
+    destroy_run_world(world);
+    return point;
+}
+
+void check_ensemble_columns(const EnsembleAccumulator& acc) {
+    if (acc.columns() != static_cast<std::size_t>(STATS_COLUMN_COUNT)) {
+        throw std::invalid_argument("ensemble accumulator needs one column per stats column");
+    }
+}
+
+// Per-run buffer of ensemble samples, merged in batches so the shared
+// accumulator lock stays cold
+class SampleBatch {
+public:
+    SampleBatch(EnsembleAccumulator& acc, std::mutex& mutex) : acc_(acc), mutex_(mutex) {
+        pending_.reserve(BATCH);
+    }
+
+    void add(std::size_t row, const StatsRecord& record) {
+        pending_.push_back({row, record});
+        if (pending_.size() >= BATCH) flush();
+    }
+
+    void flush() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        double values[STATS_COLUMN_COUNT];
+        for (const Sample& s : pending_) {
+            for (int c = 0; c < STATS_COLUMN_COUNT; ++c) values[c] = s.record.values[c];
+            acc_.add(s.row, s.record.frame, s.record.time, values);
+        }
+        pending_.clear();
+    }
+
+private:
+    static constexpr std::size_t BATCH = 64;
+    struct Sample {
+        std::size_t row;
+        StatsRecord record;
+    };
+    EnsembleAccumulator& acc_;
+    std::mutex& mutex_;
+    std::vector<Sample> pending_;
+};
+
+// Runs one ensemble member to completion, handing SimStats to on_sample every
+// `sample_interval` frames as row frame / interval - 1. Never stops on
+// extinction, so every run reaches every row. Fills point.result / error.
+void run_sampled(const SimConfig& config,
+                 const HeadlessOptions& options,
+                 uint64_t sample_interval,
+                 SweepPointResult& point,
+                 const std::function<void(std::size_t, const StatsRecord&)>& on_sample) {
+    HeadlessOptions run_options = options;
+    run_options.stop_on_extinction = false;
+    run_options.stop_conditions = false;
+    run_options.on_frame = [&](flecs::world& w) {
+        const SimClock& clock = w.get<SimClock>();
+        if (clock.frame == 0 || clock.frame % sample_interval != 0) return;
+        on_sample(static_cast<std::size_t>(clock.frame / sample_interval - 1),
+                  make_stats_record(clock.frame, clock.time, w.get<SimStats>()));
+    };
+
+    std::unique_ptr<flecs::world> world;
+    try {
+        world = make_run_world(config, options);
+        point.result = run_headless(*world, run_options);
+    } catch (const std::exception& e) {
+        point.error = e.what();
+    }
+    destroy_run_world(world);
+}
+
+// A serial world resuming `prefix` under `config`
+std::unique_ptr<flecs::world> make_branch_world(SimConfig config, const CheckpointImage& prefix) {
+    config.sim_threads = 1;
+    std::unique_ptr<flecs::world> world;
+    {
+        std::lock_guard<std::mutex> lock(world_lifetime_mutex());
+        world = std::make_unique<flecs::world>();
+        init_world(*world, config);
+        register_all_systems(*world);
+        register_stats_system(*world);
+    }
+    load_checkpoint(*world, prefix);
+    return world;
+}
+
+} // namespace
+
+void run_sweep(const SimConfig& base,
+               const std::vector<SweepParam>& params,
+               const std::vector<std::vector<double>>& design,
+               const HeadlessOptions& options,
+               unsigned threads,
+               const std::function<void(const SweepPointResult&)>& on_done) {
+    // Each worker builds and steps its own world; no world is shared
+    WorkerPool pool(threads);
+    std::mutex done_mutex;
+    pool.run(design.size(), [&](std::size_t index, unsigned) {
+        SweepPointResult point = run_point(base, params, design[index], index, options);
+        std::lock_guard<std::mutex> lock(done_mutex);
+        on_done(point);
+    });
+}
+
+void run_ensemble(const SimConfig& base,
+                  std::size_t runs,
+                  uint64_t sample_interval,
+                  const HeadlessOptions& options,
+                  unsigned threads,
+                  EnsembleAccumulator& acc,
+                  const std::function<void(const SweepPointResult&)>& on_done) {
+    check_ensemble_columns(acc);
+    if (sample_interval == 0) sample_interval = 1;
+
+    WorkerPool pool(threads);
+    std::mutex acc_mutex;
+    std::mutex done_mutex;
+    pool.run(runs, [&](std::size_t index, unsigned) {
+        SimConfig config = base;
+        config.seed = base.seed + static_cast<int>(index);
+
+        SweepPointResult point;
+        point.index = index;
+        point.values = {static_cast<double>(config.seed)};
+
+        SampleBatch batch(acc, acc_mutex);
+        run_sampled(config, options, sample_interval, point,
+                    [&](std::size_t row, const StatsRecord& record) { batch.add(row, record); });
+        batch.flush();
+
+        std::lock_guard<std::mutex> lock(done_mutex);
+        on_done(point);
+    });
+}
+
+void run_paired_ensemble(const SimConfig& base,
+                         const SimConfig& variant,
+                         bool common_random_numbers,
+                         std::size_t runs,
+                         uint64_t sample_interval,
+                         const HeadlessOptions& options,
+                         unsigned threads,
+                         EnsembleAccumulator& acc,
+                         const std::function<void(const SweepPointResult&)>& on_done) {
+    check_ensemble_columns(acc);
+    if (sample_interval == 0) sample_interval = 1;
+
+    WorkerPool pool(threads);
+    std::mutex acc_mutex;
+    std::mutex done_mutex;
+    pool.run(runs, [&](std::size_t index, unsigned) {
+        SimConfig base_config = base;
+        base_config.seed = base.seed + static_cast<int>(index);
+        SimConfig variant_config = variant;
+        variant_config.seed = base_config.seed +
+                              (common_random_numbers ? 0 : static_cast<int>(runs));
+
+        SweepPointResult point;
+        point.index = index;
+        point.values = {static_cast<double>(base_config.seed)};
+
+        // The baseline arm is kept whole; it is one record per sample
+        std::vector<StatsRecord> baseline;
+        run_sampled(base_config, options, sample_interval, point,
+                    [&](std::size_t row, const StatsRecord& record) {
+                        if (baseline.size() <= row) baseline.resize(row + 1);
+                        baseline[row] = record;
+                    });
+
+        if (point.error.empty()) {
+            SampleBatch batch(acc, acc_mutex);
+            run_sampled(variant_config, options, sample_interval, point,
+                        [&](std::size_t row, const StatsRecord& record) {
+                            if (row >= baseline.size()) return;
+                            StatsRecord delta = record;
+                            for (int c = 0; c < STATS_COLUMN_COUNT; ++c) {
+                                delta.values[c] -= baseline[row].values[c];
+                            }
+                            batch.add(row, delta);
+                        });
+            batch.flush();
+        }
+
+        std::lock_guard<std::mutex> lock(done_mutex);
+        on_done(point);
+    });
+}
+
+CheckpointImage run_branch_prefix(const SimConfig& base, const HeadlessOptions& options) {
+    HeadlessOptions prefix_options = options;
+    prefix_options.stop_on_extinction = false;
+    prefix_options.stop_conditions = false;
+
+    std::unique_ptr<flecs::world> world;
+    {
+        std::lock_guard<std::mutex> lock(world_lifetime_mutex());
+        world = std::make_unique<flecs::world>();
+        init_world(*world, base);
+        register_all_systems(*world);
+        register_stats_system(*world);
+    }
+    CheckpointImage image;
+    try {
+        spawn_settled_population(*world, options.dt, options.burn_in_cache);
+        run_headless(*world, prefix_options);
+        image = save_checkpoint_image(*world);
+    } catch (...) {
+        destroy_run_world(world);
+        throw;
+    }
+    destroy_run_world(world);
+    return image;
+}
+
+void run_branches(const CheckpointImage& prefix,
+                  const std::vector<BranchSpec>& branches,
+                  std::size_t replicates,
+                  bool common_random_numbers,
+                  uint64_t sample_interval,
+                  const HeadlessOptions& options,
+                  unsigned threads,
+                  const std::function<void(const BranchRunResult&)>& on_done) {
+    if (sample_interval == 0) sample_interval = 1;
+    const SimConfig prefix_config = read_checkpoint_config(prefix);
+    const int prefix_seed = prefix_config.seed;
+
+    WorkerPool pool(threads);
+    std::mutex done_mutex;
+    pool.run(branches.size() * replicates, [&](std::size_t index, unsigned) {
+        BranchRunResult child;
+        child.branch = index / replicates;
+        child.replicate = index % replicates;
+        child.seed = prefix_seed + static_cast<int>(
+            common_random_numbers ? child.replicate : index);
+
+        HeadlessOptions run_options = options;
+        run_options.on_frame = [&](flecs::world& w) {
+            const SimClock& clock = w.get<SimClock>();
+            if (clock.frame % sample_interval != 0) return;
+            child.samples.push_back(make_stats_record(clock.frame, clock.time, w.get<SimStats>()));
+        };
+
+        std::unique_ptr<flecs::world> world;
+        try {
+            SimConfig config = prefix_config;
+            for (const auto& kv : branches[child.branch].overrides) {
+                if (!set_config_value(config, kv.first, kv.second)) {
+                    throw std::runtime_error("cannot set '" + kv.first + "' to '" + kv.second + "'");
+                }
+            }
+            config.seed = child.seed;
+            world = make_branch_world(config, prefix);
+            // Draws after the branch point come from the child's own stream
+            world->get_mut<SimRng>().seed = static_cast<uint32_t>(child.seed);
+            child.result = run_headless(*world, run_options);
+        } catch (const std::exception& e) {
+            child.error = e.what();
+        }
+        destroy_run_world(world);
+
+        std::lock_guard<std::mutex> lock(done_mutex);
+        on_done(child);
+    });
+}
+
+void write_sweep_csv_header(const std::vector<SweepParam>& params, std::ostream& out) {
+    out << "point";
+    for (const auto& p : params) out << ',' << p.key;
+    out << ",frames,sim_time,wall_seconds,extinct,stop_reason";
+    const char* const* names = stats_column_names();
+    for (int c = 0; c < STATS_COLUMN_COUNT; ++c) out << ',' << names[c];
+    out << ",error\n";
+}
+
+void write_sweep_csv_row(const SweepPointResult& point, std::ostream& out) {
+    out << point.index;
+    for (double v : point.values) out << ',' << format_sweep_value(v);
+    const HeadlessResult& r = point.result;
+    out << ',' << r.frames << ',' << format_sim_time(r.sim_time) << ',' << r.wall_seconds << ',' << (r.extinct ? 1 : 0)
+        << ',' << stop_reason_name(r.stop_reason);
+    const StatsRecord rec = make_stats_record(r.frames, r.sim_time, r.final_stats);
+    for (int c = 0; c < STATS_COLUMN_COUNT; ++c) out << ',' << rec.values[c];
+    // Errors are single config messages; keep the CSV single-line
+    std::string error = point.error;
+    for (char& ch : error) {
+        if (ch == ',' || ch == '\n') ch = ';';
+    }
+    out << ',' << error << '\n';
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "components.h"
+#include "runner.h"
+#include "checkpoint.h"
+#include "io/stats_stream.h"
+#include "sim/sweep.h"
+#include <cstddef>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+class EnsembleAccumulator;
+
+struct SweepPointResult {
+    std::size_t index = 0;          // row in the design
+    std::vector<double> values;     // parameter values as run (integer keys rounded), in SweepParam order
+    HeadlessResult result;
+    std::string error;              // non-empty if the point failed (bad value, ...)
+};
+
+// Runs every design point as an independent headless world, in parallel on a
+// WorkerPool of `threads` workers (0 = all cores). Each world runs serially
+// (sim_threads = 1) so points, not systems, use the cores. on_done is called
+// once per point as it finishes, serialized, in completion order.
+void run_sweep(const SimConfig& base,
+               const std::vector<SweepParam>& params,
+               const std::vector<std::vector<double>>& design,
+               const HeadlessOptions& options,
+               unsigned threads,
+               const std::function<void(const SweepPointResult&)>& on_done);
+
+// Monte-Carlo ensemble: runs `runs` copies of `base` with seeds base.seed,
+// base.seed + 1, ... in parallel (as run_sweep) and feeds SimStats into `acc`
+// every `sample_interval` frames, so row k holds frame (k + 1) * sample_interval
+// of every run. Runs never stop on extinction, so each run contributes to
+// every row, the config's stop_* keys are ignored, and options.on_frame is
+// replaced. `acc` must have
+// STATS_COLUMN_COUNT columns. Samples are merged in batches as runs progress;
+// P² quantiles therefore depend slightly on merge order. on_done is called per
+// run, serialized, with values = {seed}.
+void run_ensemble(const SimConfig& base,
+                  std::size_t runs,
+                  uint64_t sample_interval,
+                  const HeadlessOptions& options,
+                  unsigned threads,
+                  EnsembleAccumulator& acc,
+                  const std::function<void(const SweepPointResult&)>& on_done);
+
+// Paired ensemble for A/B comparisons: run i simulates `base` and then
+// `variant` and feeds the per-sample difference (variant - base) into `acc`.
+// With common random numbers both arms use seed base.seed + i, and because
+// every draw is keyed by a stable BoidId the arms share their spawn, mating
+// and contact streams, so noise common to both cancels in the difference.
+// Otherwise the variant arm uses seed base.seed + runs + i. variant.seed is
+// ignored. on_done is called per pair with values = {base seed} and the
+// variant arm's result.
+void run_paired_ensemble(const SimConfig& base,
+                         const SimConfig& variant,
+                         bool common_random_numbers,
+                         std::size_t runs,
+                         uint64_t sample_interval,
+                         const HeadlessOptions& options,
+                         unsigned threads,
+                         EnsembleAccumulator& acc,
+                         const std::function<void(const SweepPointResult&)>& on_done);
+
+// One future of a branched run: config keys changed at the branch point
+struct BranchSpec {
+    std::string name;
+    std::vector<std::pair<std::string, std::string>> overrides;   // key, value
+};
+
+struct BranchRunResult {
+    std::size_t branch = 0;         // index into the branch list
+    std::size_t replicate = 0;
+    int seed = 0;                   // RNG seed after the branch point
+    HeadlessResult result;          // frames and time after the branch point
+    std::vector<StatsRecord> samples;   // every sample_interval frames of the world clock
+    std::string error;              // non-empty if the child failed (bad key, layout change, ...)
+};
+
+// Simulates `base` once, up to the branch point given by `options` (with
+// base.sim_threads), and returns the world as a checkpoint image. Stop
+// conditions are ignored so the prefix always reaches the branch point.
+CheckpointImage run_branch_prefix(const SimConfig& base, const HeadlessOptions& options);
+
+// Runs `replicates` children of every branch from `prefix`, in parallel as
+// run_sweep. Each child is a fresh serial world cloned from the image (its
+// config is the prefix config with the branch's overrides; keys that change
+// the world layout are rejected), reseeded at the branch point: with common
+// random numbers replicate r of every branch uses seed prefix seed + r, so
+// replicate 0 continues the prefix's own stream; otherwise branch b uses
+// prefix seed + b * replicates + r. `options` bounds the run after the branch
+// point; options.on_frame is replaced. on_done is called per child,
+// serialized, in completion order.
+void run_branches(const CheckpointImage& prefix,
+                  const std::vector<BranchSpec>& branches,
+                  std::size_t replicates,
+                  bool common_random_numbers,
+                  uint64_t sample_interval,
+                  const HeadlessOptions& options,
+                  unsigned threads,
+                  const std::function<void(const BranchRunResult&)>& on_done);
+
+// Consolidated CSV: point, one column per parameter, run outcome, final stats
+void write_sweep_csv_header(const std::vector<SweepParam>& params, std::ostream& out);
+void write_sweep_csv_row(const SweepPointResult& point, std::ostream& out);
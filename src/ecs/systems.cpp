@@ -6,12 +6,15 @@
 // Individual systems defined in:
 //   systems_steering.cpp     — grid rebuild, steering, movement
 //   systems_infection.cpp    — collision, infection, cure
-//   systems_lifecycle.cpp    — aging, death, doctor promotion
+//   systems_lifecycle.cpp    — clock, aging, death, doctor promotion
 //   systems_reproduction.cpp — reproduction
 //   systems_render_sync.cpp  — render state sync
 // ============================================================
 
 void register_all_systems(flecs::world& world) {
+    // OnLoad
+    register_clock_system(world);
+
     // PreUpdate
     register_rebuild_grid_system(world);
 
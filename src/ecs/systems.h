@@ -5,6 +5,7 @@
 void register_all_systems(flecs::world& world);
 
 // Individual system registration functions (also available for unit tests)
+void register_clock_system(flecs::world& world);
 void register_rebuild_grid_system(flecs::world& world);
 void register_steering_system(flecs::world& world);
 void register_antivax_steering_system(flecs::world& world);
@@ -1,15 +1,53 @@
 #include "systems.h"
 #include "components.h"
 #include "spatial_grid.h"
+#include "command_buffer.h"
+#include "boid_state.h"
+#include "worker_pool.h"
 #include "sim/infection.h"
-#include "sim/cure.h"
 #include "sim/rng.h"
 #include <flecs.h>
+#include <algorithm>
+#include <memory>
 #include <vector>
 
 // ============================================================
 // PostUpdate Phase: Collisions and Behavior
 // ============================================================
+//
+// Infection and cure are pair interactions between a small and a large set
+// (spreaders vs. susceptibles, doctors vs. infected). Each frame the systems
+// iterate whichever side is currently rarer and query the other side — the
+// main grid for the forward direction, the filtered InteractionIndex for the
+// reverse one. Every candidate pair is still rolled independently, so a target
+// ends up infected/cured with probability 1 - prod(1 - p_i) either way.
+//
+// The iterated side is read from the grid snapshot and split into chunks that
+// run on the world's WorkerPool. Every candidate pair draws one number keyed
+// by the frame and the (spreader or doctor, target) BoidIds — the same number
+// whichever side is iterated, and in any run with the same seed. Staggered
+// infection ticks are gated on the spreader in both directions, so a pair is
+// rolled on the same frames either way (cure is not staggered: every pair
+// rolls every frame). Workers only emit (target, action) records into
+// per-worker buffers, and the merged, deduplicated records are applied to
+// FLECS in BoidId order — the result is identical for any thread count and
+// either direction.
+
+namespace {
+    // Iterated boids per parallel work item
+    constexpr std::size_t CHUNK_SIZE = 256;
+
+    WorkerPool* world_pool(flecs::world& w, unsigned& workers) {
+        const SimWorkers* sw = w.try_get<SimWorkers>();
+        WorkerPool* pool = sw ? sw->pool.get() : nullptr;
+        workers = pool ? pool->size() : 1;
+        return pool;
+    }
+
+    std::size_t chunk_count(std::size_t items) {
+        return (items + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    }
+}
 
 void register_collision_system(flecs::world& world) {
     // Collision system stub reserved for future extensions.
@@ -17,117 +55,262 @@ void register_collision_system(flecs::world& world) {
 }
 
 void register_infection_system(flecs::world& world) {
+    auto buffers = std::make_shared<CommandBuffers>();
+
     world.system("InfectionSystem")
         .kind(flecs::PostUpdate)
-        .run([](flecs::iter& it) {
+        .run([buffers](flecs::iter& it) {
             flecs::world w = it.world();
             const SimConfig& config = w.get<SimConfig>();
             const SpatialGrid& grid = w.get<SpatialGrid>();
-            std::mt19937& rng = sim_rng();
+            const InteractionIndex* index = w.try_get<InteractionIndex>();
+            float dt = it.delta_time();
 
-            w.defer_begin();
+            // Staggered ticks need the simulation clock; without it every boid
+            // is evaluated every frame (hand-built test worlds).
+            const SimClock* clock = w.try_get<SimClock>();
+            bool staggered = clock && config.infection_tick_rate > 0.0f;
+            double t_now = clock ? clock->time : 0.0;
+            double t_prev = t_now - dt;
+            uint64_t frame = clock ? clock->frame : 0;
+            const SimRng* rngs = w.try_get<SimRng>();
+            const uint64_t key =
+                pair_stream_key(rngs ? rngs->seed : SIM_RNG_SEED, frame, RngPurpose::Infection);
+            float tick_interval = staggered ? 1.0f / config.infection_tick_rate : dt;
 
-            std::vector<SpatialGrid::QueryResult> neighbors;
-
-            // Unified infection pass: iterate all infected alive boids
-            auto q_infected = w.query<const Position, const Alive, const Infected>();
-            q_infected.each([&](flecs::entity e, const Position& pos, const Alive&, const Infected&) {
-                // Determine spreader's swarm type and effective radius/probability
-                bool is_doctor = e.has<DoctorBoid>();
-                float effective_r_interact;
-                float p_infect;
-
-                if (is_doctor) {
-                    effective_r_interact = config.r_interact_doctor * config.debuff_r_interact_doctor_infected;
-                    p_infect = config.p_infect_doctor;
-                } else {
-                    // Normal and Antivax use the same infection params
-                    effective_r_interact = config.r_interact_normal * config.debuff_r_interact_normal_infected;
-                    p_infect = config.p_infect_normal;
-                }
+            // Ticks due for a spreader this frame. Pairs are gated on the
+            // spreader in both directions, so a pair is rolled on the same
+            // frames, with the same draws, whichever side is iterated.
+            auto ticks_due = [&](uint64_t id) {
+                if (!staggered) return 1;
+                return infection_ticks_due(infection_phase(id), t_prev, t_now,
+                                           config.infection_tick_rate);
+            };
+
+            // Spreader parameters: doctors use the doctor radius/probability,
+            // Normal and Antivax share the normal ones. Spreaders are always infected.
+            float r_spread_normal = config.r_interact_normal * config.debuff_r_interact_normal_infected;
+            float r_spread_doctor = config.r_interact_doctor * config.debuff_r_interact_doctor_infected;
+
+            // Pick the direction from live counts: iterate the rarer side
+            bool reverse = false;
+            if (index) {
+                std::size_t n_infected = index->infected.size();
+                std::size_t n_susceptible = grid.size() - n_infected;
+                reverse = n_susceptible < n_infected;
+            }
+
+            std::vector<const SpatialGrid::Entry*> items;
+            if (!reverse) {
+                const SpatialGrid& spreaders = index ? index->infected : grid;
+                spreaders.collect(items, [](const SpatialGrid::Entry& e) {
+                    return (e.flags & SpatialGrid::FLAG_INFECTED) != 0;
+                });
+            } else {
+                grid.collect(items, [](const SpatialGrid::Entry& e) {
+                    return (e.flags & SpatialGrid::FLAG_INFECTED) == 0;
+                });
+            }
+            if (items.empty()) return;
 
-                // Query neighbors within effective interaction radius
-                grid.query_neighbors(pos.x, pos.y, effective_r_interact, neighbors);
+            unsigned workers = 1;
+            WorkerPool* pool = world_pool(w, workers);
+            buffers->reset(workers);
+            std::vector<std::vector<SpatialGrid::QueryResult>> scratch(workers);
 
-                for (const auto& qr : neighbors) {
-                    const auto* ne_entry = qr.entry;
-                    if (ne_entry->entity_id == e.id()) continue;
+            float r_query = std::max(r_spread_normal, r_spread_doctor);
+            // Reverse-direction probabilities for the usual single tick
+            float p_tick_normal = hazard_probability(config.p_infect_normal, tick_interval);
+            float p_tick_doctor = hazard_probability(config.p_infect_doctor, tick_interval);
+            float r_normal_sq = r_spread_normal * r_spread_normal;
+            float r_doctor_sq = r_spread_doctor * r_spread_doctor;
+
+            parallel_chunks(pool, chunk_count(items.size()), [&](std::size_t chunk, unsigned worker) {
+                std::vector<BoidCommand>& out = buffers->local(worker);
+                std::vector<SpatialGrid::QueryResult>& neighbors = scratch[worker];
+                std::size_t end = std::min(items.size(), (chunk + 1) * CHUNK_SIZE);
+
+                for (std::size_t i = chunk * CHUNK_SIZE; i < end; ++i) {
+                    const SpatialGrid::Entry* self = items[i];
+
+                    if (!reverse) {
+                        // Forward: the spreader queries the main grid for susceptibles.
+                        // It only acts on its own tick; a long frame may cover several
+                        int ticks = ticks_due(self->uid);
+                        if (ticks <= 0) continue;
+                        float interval = tick_interval * static_cast<float>(ticks);
+
+                        bool is_doctor = self->swarm_type == 1;
+                        float radius = is_doctor ? r_spread_doctor : r_spread_normal;
+                        // Per-frame probability -> probability over the elapsed tick interval(s)
+                        float p_infect = hazard_probability(
+                            is_doctor ? config.p_infect_doctor : config.p_infect_normal, interval);
+
+                        grid.query_neighbors(self->x, self->y, radius, neighbors);
+
+                        for (const auto& qr : neighbors) {
+                            const auto* ne_entry = qr.entry;
+                            if (ne_entry->entity_id == self->entity_id) continue;
+
+                            // Use enriched entry: skip non-alive, skip already infected
+                            if (!(ne_entry->flags & SpatialGrid::FLAG_ALIVE)) continue;
+                            if (ne_entry->flags & SpatialGrid::FLAG_INFECTED) continue;
+
+                            // Any boid type (0=normal, 1=doctor, 2=antivax) can be infected
+                            if (pair_uniform(key, self->uid, ne_entry->uid) < p_infect) {
+                                out.push_back({ne_entry->entity_id, ne_entry->uid, BoidAction::Infect});
+                            }
+                        }
+                    } else {
+                        // Reverse: the susceptible queries the infected index for spreaders.
+                        // Each spreader in range rolls only on its own tick(s), as forward.
+                        index->infected.query_neighbors(self->x, self->y, r_query, neighbors);
 
-                    // Use enriched entry: skip non-alive, skip already infected
-                    if (!(ne_entry->flags & SpatialGrid::FLAG_ALIVE)) continue;
-                    if (ne_entry->flags & SpatialGrid::FLAG_INFECTED) continue;
+                        for (const auto& qr : neighbors) {
+                            const auto* spreader = qr.entry;
+                            if (spreader->entity_id == self->entity_id) continue;
 
-                    // Any boid type (0=normal, 1=doctor, 2=antivax) can be infected
-                    // swarm_type is always 0, 1, or 2 — no filter needed
+                            bool is_doctor = spreader->swarm_type == 1;
+                            if (qr.dist_sq > (is_doctor ? r_doctor_sq : r_normal_sq)) continue;
 
-                    // Try to infect
-                    if (try_infect(p_infect, rng)) {
-                        flecs::entity ne = w.entity(ne_entry->entity_id);
-                        ne.add<Infected>();
-                        ne.set(InfectionState{0.0f, config.t_death});
+                            int ticks = ticks_due(spreader->uid);
+                            if (ticks <= 0) continue;
+                            float p_infect = ticks == 1
+                                ? (is_doctor ? p_tick_doctor : p_tick_normal)
+                                : hazard_probability(is_doctor ? config.p_infect_doctor : config.p_infect_normal,
+                                                     tick_interval * static_cast<float>(ticks));
+                            if (pair_uniform(key, spreader->uid, self->uid) < p_infect) {
+                                out.push_back({self->entity_id, self->uid, BoidAction::Infect});
+                                break;  // already infected — remaining rolls cannot change the outcome
+                            }
+                        }
                     }
                 }
             });
 
+            // Apply merged, deduplicated infections in BoidId order
+            w.defer_begin();
+            for (const BoidCommand& cmd : buffers->merge()) {
+                flecs::entity ne = w.entity(cmd.target);
+                if (!ne.is_alive()) continue;
+                set_boid_infected(ne, true, config.toggle_state_tags);
+                ne.set(InfectionState{0.0f, config.t_death});
+            }
             w.defer_end();
         });
 }
 
 void register_cure_system(flecs::world& world) {
+    auto buffers = std::make_shared<CommandBuffers>();
+
     world.system("CureSystem")
         .kind(flecs::PostUpdate)
-        .run([](flecs::iter& it) {
+        .run([buffers](flecs::iter& it) {
             flecs::world w = it.world();
             const SimConfig& config = w.get<SimConfig>();
             const SpatialGrid& grid = w.get<SpatialGrid>();
-            std::mt19937& rng = sim_rng();
+            const InteractionIndex* index = w.try_get<InteractionIndex>();
+            const SimClock* clock = w.try_get<SimClock>();
+            uint64_t frame = clock ? clock->frame : 0;
+            const SimRng* rngs = w.try_get<SimRng>();
+            const uint64_t key =
+                pair_stream_key(rngs ? rngs->seed : SIM_RNG_SEED, frame, RngPurpose::Cure);
 
-            w.defer_begin();
+            // Debuffed values for infected doctors
+            float r_cure_infected = config.r_interact_doctor * config.debuff_r_interact_doctor_infected;
+            float p_cure_infected = config.p_cure * config.debuff_p_cure_infected;
 
-            // Only doctors can cure
-            auto q_doctor = w.query<const Position, const DoctorBoid, const Alive>();
-            std::vector<SpatialGrid::QueryResult> neighbors;
-            q_doctor.each([&](flecs::entity e, const Position& pos, const DoctorBoid&, const Alive&) {
-                // Check if doctor is infected for debuff calculation
-                bool doctor_infected = e.has<Infected>();
-
-                // Calculate effective interaction radius (debuffed if infected)
-                float effective_r_interact = config.r_interact_doctor;
-                if (doctor_infected) {
-                    effective_r_interact *= config.debuff_r_interact_doctor_infected;
-                }
+            // Pick the direction from live counts: iterate the rarer side
+            bool reverse = false;
+            if (index) {
+                reverse = index->infected.size() < index->doctors.size();
+            }
 
-                // Query neighbors within effective doctor interaction radius
-                grid.query_neighbors(pos.x, pos.y, effective_r_interact, neighbors);
+            std::vector<const SpatialGrid::Entry*> items;
+            if (!reverse) {
+                // Only doctors can cure
+                const SpatialGrid& doctors = index ? index->doctors : grid;
+                doctors.collect(items, [](const SpatialGrid::Entry& e) { return e.swarm_type == 1; });
+            } else {
+                index->infected.collect(items, [](const SpatialGrid::Entry&) { return true; });
+            }
+            if (items.empty()) return;
 
-                for (const auto& qr : neighbors) {
-                    const auto* ne_entry = qr.entry;
-                    // Contract: doctors cannot cure themselves
-                    if (ne_entry->entity_id == e.id()) continue;
+            unsigned workers = 1;
+            WorkerPool* pool = world_pool(w, workers);
+            buffers->reset(workers);
+            std::vector<std::vector<SpatialGrid::QueryResult>> scratch(workers);
 
-                    // Use enriched entry: skip non-alive, skip non-infected
-                    if (!(ne_entry->flags & SpatialGrid::FLAG_ALIVE)) continue;
-                    if (!(ne_entry->flags & SpatialGrid::FLAG_INFECTED)) continue;
+            float r_query = std::max(config.r_interact_doctor, r_cure_infected);
+            float r_healthy_sq = config.r_interact_doctor * config.r_interact_doctor;
+            float r_infected_sq = r_cure_infected * r_cure_infected;
 
-                    // Calculate effective cure probability (debuffed if doctor is infected)
-                    float effective_p_cure = config.p_cure;
-                    if (doctor_infected) {
-                        effective_p_cure *= config.debuff_p_cure_infected;
-                    }
+            parallel_chunks(pool, chunk_count(items.size()), [&](std::size_t chunk, unsigned worker) {
+                std::vector<BoidCommand>& out = buffers->local(worker);
+                std::vector<SpatialGrid::QueryResult>& neighbors = scratch[worker];
+                std::size_t end = std::min(items.size(), (chunk + 1) * CHUNK_SIZE);
+
+                for (std::size_t i = chunk * CHUNK_SIZE; i < end; ++i) {
+                    const SpatialGrid::Entry* self = items[i];
+
+                    if (!reverse) {
+                        // Forward: the doctor queries for infected neighbors
+                        bool doctor_infected = (self->flags & SpatialGrid::FLAG_INFECTED) != 0;
+
+                        // Effective interaction radius and cure probability (debuffed if infected)
+                        float radius = doctor_infected ? r_cure_infected : config.r_interact_doctor;
+                        float p_cure = doctor_infected ? p_cure_infected : config.p_cure;
 
-                    // Try to cure (doctors cure ANY infected boid, including other doctors)
-                    if (try_cure(effective_p_cure, rng)) {
-                        flecs::entity ne = w.entity(ne_entry->entity_id);
-                        ne.remove<Infected>();
-                        // Reset infection timer
-                        if (ne.has<InfectionState>()) {
-                            InfectionState& inf = ne.get_mut<InfectionState>();
-                            inf.time_infected = 0.0f;
+                        grid.query_neighbors(self->x, self->y, radius, neighbors);
+
+                        for (const auto& qr : neighbors) {
+                            const auto* ne_entry = qr.entry;
+                            // Contract: doctors cannot cure themselves
+                            if (ne_entry->entity_id == self->entity_id) continue;
+
+                            // Use enriched entry: skip non-alive, skip non-infected
+                            if (!(ne_entry->flags & SpatialGrid::FLAG_ALIVE)) continue;
+                            if (!(ne_entry->flags & SpatialGrid::FLAG_INFECTED)) continue;
+
+                            // Doctors cure ANY infected boid, including other doctors
+                            if (pair_uniform(key, self->uid, ne_entry->uid) < p_cure) {
+                                out.push_back({ne_entry->entity_id, ne_entry->uid, BoidAction::Cure});
+                            }
+                        }
+                    } else {
+                        // Reverse: the infected boid queries the doctor index for curers
+                        index->doctors.query_neighbors(self->x, self->y, r_query, neighbors);
+
+                        for (const auto& qr : neighbors) {
+                            const auto* doctor = qr.entry;
+                            // Contract: doctors cannot cure themselves
+                            if (doctor->entity_id == self->entity_id) continue;
+
+                            bool doctor_infected = (doctor->flags & SpatialGrid::FLAG_INFECTED) != 0;
+                            if (qr.dist_sq > (doctor_infected ? r_infected_sq : r_healthy_sq)) continue;
+
+                            float p_cure = doctor_infected ? p_cure_infected : config.p_cure;
+                            if (pair_uniform(key, doctor->uid, self->uid) < p_cure) {
+                                out.push_back({self->entity_id, self->uid, BoidAction::Cure});
+                                break;  // already cured — remaining rolls cannot change the outcome
+                            }
                         }
                     }
                 }
             });
 
+            // Apply merged, deduplicated cures in BoidId order
+            w.defer_begin();
+            for (const BoidCommand& cmd : buffers->merge()) {
+                flecs::entity ne = w.entity(cmd.target);
+                if (!ne.is_alive()) continue;
+                set_boid_infected(ne, false, config.toggle_state_tags);
+                // Reset infection timer
+                if (ne.has<InfectionState>()) {
+                    InfectionState& inf = ne.get_mut<InfectionState>();
+                    inf.time_infected = 0.0f;
+                }
+            }
             w.defer_end();
         });
 }
@@ -1,31 +1,47 @@
 #include "systems.h"
 #include "components.h"
+#include "boid_state.h"
+#include "spawn.h"
 #include "sim/aging.h"
 #include "sim/death.h"
 #include "sim/promotion.h"
 #include "sim/rng.h"
 #include <flecs.h>
-#include <vector>
+
+// ============================================================
+// OnLoad Phase: Simulation Clock (runs before every other system)
+// ============================================================
+
+void register_clock_system(flecs::world& world) {
+    world.system("ClockSystem")
+        .kind(flecs::OnLoad)
+        .run([](flecs::iter& it) {
+            flecs::world w = it.world();
+            SimClock& clock = w.get_mut<SimClock>();
+            clock.time += it.delta_time();
+            clock.frame++;
+        });
+}
 
 // ============================================================
 // PostUpdate Phase: Aging and Timers
 // ============================================================
 
 void register_aging_system(flecs::world& world) {
+    auto q_age = world.query_builder<Health, const Alive>().cached().build();
+    auto q_infected = world.query_builder<InfectionState, const Infected, const Alive>().cached().build();
+
     world.system("AgingSystem")
         .kind(flecs::PostUpdate)
-        .run([](flecs::iter& it) {
-            flecs::world w = it.world();
+        .run([q_age, q_infected](flecs::iter& it) {
             float dt = it.delta_time();
 
             // Age all alive entities
-            auto q_age = w.query<Health, const Alive>();
             q_age.each([dt](Health& health, const Alive&) {
                 age_entity(health.age, dt);
             });
 
             // Tick infection timers
-            auto q_infected = w.query<InfectionState, const Infected, const Alive>();
             q_infected.each([dt](InfectionState& infection, const Infected&, const Alive&) {
                 tick_infection(infection.time_infected, dt);
             });
@@ -37,30 +53,39 @@ void register_aging_system(flecs::world& world) {
 // ============================================================
 
 void register_death_system(flecs::world& world) {
+    world.component<Dead>();
+
+    auto q = world.query_builder<const InfectionState, const Infected, const Alive>().cached().build();
+
     world.system("DeathSystem")
         .kind(flecs::PostUpdate)
-        .run([](flecs::iter& it) {
+        .run([q](flecs::iter& it) {
             flecs::world w = it.world();
             const SimConfig& config = w.get<SimConfig>();
             SimStats& stats = w.get_mut<SimStats>();
 
             w.defer_begin();
 
-            // Check for death by infection
-            auto q = w.query<const InfectionState, const Infected, const Alive>();
-            q.each([&](flecs::entity e, const InfectionState& infection, const Infected&, const Alive&) {
-                if (should_die(infection.time_infected, config.t_death)) {
-                    // Remove Alive tag (entity remains for stats)
-                    e.remove<Alive>();
-
-                    // Update stats
-                    stats.dead_total++;
-                    if (e.has<NormalBoid>()) {
-                        stats.dead_normal++;
-                    } else if (e.has<DoctorBoid>()) {
-                        stats.dead_doctor++;
-                    } else if (e.has<AntivaxBoid>()) {
-                        stats.dead_antivax++;
+            // Check for death by infection. The swarm counter is table-constant.
+            q.run([&](flecs::iter& it) {
+                while (it.next()) {
+                    auto infection = it.field<const InfectionState>(0);
+                    uint8_t swarm_type = table_swarm_type(it.table());
+                    int& dead_swarm = swarm_type == 0 ? stats.dead_normal
+                                    : swarm_type == 1 ? stats.dead_doctor
+                                    : stats.dead_antivax;
+
+                    for (auto i : it) {
+                        if (!should_die(infection[i].time_infected, config.t_death)) continue;
+
+                        // Clear Alive and tag Dead (entity remains until cleanup)
+                        flecs::entity e = it.entity(i);
+                        set_boid_alive(e, false, config.toggle_state_tags);
+                        e.add<Dead>();
+
+                        // Update stats
+                        stats.dead_total++;
+                        dead_swarm++;
                     }
                 }
             });
@@ -74,22 +99,36 @@ void register_death_system(flecs::world& world) {
 // ============================================================
 
 void register_doctor_promotion_system(flecs::world& world) {
+    auto q = world.query_builder<const Health, const NormalBoid, const Alive, const BoidId*>()
+        .cached()
+        .build();
+
     world.system("DoctorPromotionSystem")
         .kind(flecs::PostUpdate)
-        .run([](flecs::iter& it) {
+        .run([q](flecs::iter& it) {
             flecs::world w = it.world();
             const SimConfig& config = w.get<SimConfig>();
-            std::mt19937& rng = sim_rng();
+            const SimRng* rngs = w.try_get<SimRng>();
+            const SimClock* clock = w.try_get<SimClock>();
+            const uint64_t seed = rngs ? rngs->seed : SIM_RNG_SEED;
+            const uint64_t frame = clock ? clock->frame : 0;
+            SimStats* stats = config.toggle_state_tags ? w.try_get_mut<SimStats>() : nullptr;
 
             w.defer_begin();
 
-            // Check normal boids for promotion
-            auto q = w.query<const Health, const NormalBoid, const Alive>();
-            q.each([&](flecs::entity e, const Health& health, const NormalBoid&, const Alive&) {
+            // Check normal boids for promotion, each on its own keyed stream
+            q.each([&](flecs::entity e, const Health& health, const NormalBoid&, const Alive&,
+                       const BoidId* id) {
+                KeyedRng rng(seed, frame, id ? id->value : e.id(), RngPurpose::Promotion);
                 if (try_promote(health.age, config.t_adult, config.p_become_doctor, rng)) {
-                    // Promote to doctor
+                    // Promote to doctor. Toggle mode has no observers to move
+                    // the live boid between the swarm counters
                     e.remove<NormalBoid>();
                     e.add<DoctorBoid>();
+                    if (stats) {
+                        stats->normal_alive--;
+                        stats->doctor_alive++;
+                    }
                 }
             });
 
@@ -102,23 +141,36 @@ void register_doctor_promotion_system(flecs::world& world) {
 // ============================================================
 
 void register_cleanup_system(flecs::world& world) {
+    world.component<Dead>();
+
+    // Only matches the tables DeathSystem moved corpses into
+    auto q_dead = world.query_builder<>()
+        .with<Dead>()
+        .cached()
+        .build();
+
     world.system("CleanupSystem")
         .kind(flecs::OnStore)
-        .run([](flecs::iter& it) {
+        .run([q_dead](flecs::iter& it) {
             flecs::world w = it.world();
 
-            // Collect entities to destroy (have Position but not Alive)
-            // Cannot destroy during query iteration, so collect first
-            std::vector<flecs::entity> to_destroy;
-            auto q = w.query<const Position>();
-            q.each([&](flecs::entity e, const Position&) {
-                if (!e.has<Alive>()) {
-                    to_destroy.push_back(e);
-                }
-            });
+            // No deaths this frame: nothing to scan
+            if (w.count<Dead>() == 0) return;
 
-            for (auto e : to_destroy) {
-                e.destruct();
+            // Recycling mode parks corpses instead: clearing drops every
+            // component, so nothing observes them until spawn_boids refills them
+            BoidRecycler* recycler = w.get<SimConfig>().recycle_entities
+                                   ? w.try_get_mut<BoidRecycler>() : nullptr;
+            if (!recycler) {
+                w.delete_with<Dead>();
+                return;
             }
+
+            w.defer_begin();
+            q_dead.each([recycler](flecs::entity e) {
+                e.clear();
+                recycler->free.push_back(e.id());
+            });
+            w.defer_end();
         });
 }
@@ -1,6 +1,9 @@
 #include "systems.h"
 #include "components.h"
 #include "render_state.h"
+#include "boid_state.h"
+#include "sim/population_history.h"
+#include "sim/ensemble.h"
 #include "render/render_config.h"
 #include <flecs.h>
 
@@ -9,9 +12,14 @@
 // ============================================================
 
 void register_render_sync_system(flecs::world& world) {
+    auto q = world.query_builder<const Position, const Velocity, const Heading, const Alive,
+                                 const BoidId*>()
+        .cached()
+        .build();
+
     world.system("RenderSyncSystem")
         .kind(flecs::OnStore)
-        .run([](flecs::iter& it) {
+        .run([q](flecs::iter& it) {
             flecs::world w = it.world();
             const SimConfig& config = w.get<SimConfig>();
             RenderState& rs = w.get_mut<RenderState>();
@@ -26,37 +34,43 @@ void register_render_sync_system(flecs::world& world) {
             // Populate config and sim_state pointers for renderer
             rs.config = &w.get_mut<SimConfig>();
             rs.sim_state = &w.get_mut<SimulationState>();
+            rs.history = w.try_get<PopulationHistory>();
+            rs.ensemble = w.try_get<EnsembleSummary>();
 
-            // Build render data for all alive boids
-            auto q = w.query<const Position, const Velocity, const Heading, const Alive>();
-            q.each([&](flecs::entity e, const Position& pos, const Velocity& vel,
-                        const Heading& heading, const Alive&) {
-                BoidRenderData brd;
-                brd.x = pos.x;
-                brd.y = pos.y;
-                brd.angle = heading.angle;
-                // Determine swarm type
-                if (e.has<DoctorBoid>()) {
-                    brd.swarm_type = 1;
-                } else if (e.has<AntivaxBoid>()) {
-                    brd.swarm_type = 2;
-                } else {
-                    brd.swarm_type = 0;
-                }
+            // Build render data for all alive boids. Swarm type (and so color and
+            // radius) is table-constant; only infection may vary per row.
+            q.run([&](flecs::iter& it) {
+                while (it.next()) {
+                    auto pos = it.field<const Position>(0);
+                    auto heading = it.field<const Heading>(2);
+                    // Entity ids are reused by the recycler; BoidIds never are.
+                    // Hand-built test boids may lack one, as in the grid
+                    const BoidId* uid = it.is_set(4) ? &it.field<const BoidId>(4)[0] : nullptr;
+                    uint8_t swarm_type = table_swarm_type(it.table());
+                    TableInfected infected(it, config.toggle_state_tags);
 
-                // Color: red if infected, else swarm-specific
-                if (e.has<Infected>()) {
-                    brd.color = RenderConfig::COLOR_INFECTED;
-                } else if (brd.swarm_type == 2) {
-                    brd.color = RenderConfig::COLOR_ANTIVAX;
-                } else if (brd.swarm_type == 1) {
-                    brd.color = RenderConfig::COLOR_DOCTOR;
-                } else {
-                    brd.color = RenderConfig::COLOR_NORMAL;
-                }
+                    // Color: red if infected, else swarm-specific
+                    uint32_t swarm_color = RenderConfig::COLOR_NORMAL;
+                    if (swarm_type == 2) {
+                        swarm_color = RenderConfig::COLOR_ANTIVAX;
+                    } else if (swarm_type == 1) {
+                        swarm_color = RenderConfig::COLOR_DOCTOR;
+                    }
+                    float radius = (swarm_type == 1) ? config.r_interact_doctor : config.r_interact_normal;
 
-                brd.radius = (brd.swarm_type == 1) ? config.r_interact_doctor : config.r_interact_normal;
-                rs.boids.push_back(brd);
+                    for (auto i : it) {
+                        BoidRenderData brd;
+                        brd.x = pos[i].x;
+                        brd.y = pos[i].y;
+                        brd.angle = heading[i].angle;
+                        brd.swarm_type = swarm_type;
+                        brd.id = uid ? uid[i].value : it.entity(i).id();
+                        brd.infected = infected(it, i);
+                        brd.color = brd.infected ? RenderConfig::COLOR_INFECTED : swarm_color;
+                        brd.radius = radius;
+                        rs.boids.push_back(brd);
+                    }
+                }
             });
         });
 }
@@ -1,327 +1,222 @@
 #include "systems.h"
 #include "components.h"
 #include "spatial_grid.h"
+#include "boid_state.h"
+#include "spawn.h"
 #include "sim/infection.h"
 #include "sim/reproduction.h"
 #include "sim/rng.h"
 #include <flecs.h>
 #include <cmath>
+#include <memory>
+#include <unordered_set>
 #include <vector>
-#include <utility>
 
 namespace {
     constexpr float PI = 3.14159265f;
     constexpr float TWO_PI = 2.0f * PI;
+
+    // Per-swarm parameters for the shared reproduction kernel
+    struct SwarmTraits {
+        uint8_t swarm_type;          // matches SpatialGrid::Entry::swarm_type
+        float r_interact;
+        float debuff_r_interact;     // radius multiplier while infected
+        float p_offspring;
+        float debuff_p_offspring;    // probability multiplier while infected
+        float offspring_mean;
+        float offspring_stddev;
+        float p_infect;              // child infection chance when both parents are infected
+        int SimStats::* newborns;    // per-swarm newborn counter
+    };
+
+    // Shared state for one ReproductionSystem run
+    struct ReproductionFrame {
+        flecs::world& w;
+        const SimConfig& config;
+        const SpatialGrid& grid;
+        SimStats& stats;
+        uint64_t seed;                       // SimRng seed; draws are keyed by BoidIds
+        uint64_t frame;
+        std::vector<SpawnSpec>& offspring;   // created in bulk by OffspringSpawnSystem
+        std::vector<SpatialGrid::QueryResult> neighbors;
+        // Boids that mated earlier this frame; their grid entries still read cooldown-ready
+        std::unordered_set<uint64_t> mated;
+    };
+
+    template <typename SwarmTag>
+    using SwarmQuery = flecs::query<const Position, ReproductionCooldown, const SwarmTag, const Alive,
+                                    const BoidId*>;
+
+    template <typename SwarmTag>
+    SwarmQuery<SwarmTag> build_swarm_query(flecs::world& world) {
+        return world.query_builder<const Position, ReproductionCooldown, const SwarmTag, const Alive,
+                                   const BoidId*>()
+            .cached()
+            .build();
+    }
+
+    // Mating partners are filtered purely on the enriched grid entry (swarm,
+    // alive, sex, cooldown-ready, infected). flecs is only touched for the
+    // partner once a mating succeeds. Each attempt (this boid, candidate) rolls
+    // its own Mating stream and each newborn its own Birth stream, keyed by
+    // BoidIds. A pair is tried from both sides, as with a shared engine, so
+    // its chance per frame is 1 - (1 - p)^2.
+    template <typename SwarmTag>
+    void reproduce_swarm(ReproductionFrame& f, const SwarmTraits& traits,
+                         const SwarmQuery<SwarmTag>& q) {
+        const SimConfig& config = f.config;
+        std::uniform_real_distribution<float> dist_angle(0.0f, TWO_PI);
+        std::uniform_real_distribution<float> dist_sex(0.0f, 1.0f);
+
+        q.each([&](flecs::entity e, const Position& pos, ReproductionCooldown& cooldown,
+                   const SwarmTag&, const Alive&, const BoidId* id) {
+            // Skip if on cooldown
+            if (cooldown.cooldown > 0.0f) return;
+            // Hand-built test boids may lack a BoidId, as in the grid
+            const uint64_t uid = id ? id->value : e.id();
+
+            bool is_infected = boid_infected(e);
+            bool is_male = e.has<Male>();
+
+            // Effective interaction radius and probability (debuffed if infected)
+            float effective_r_interact = traits.r_interact;
+            float effective_p_offspring = traits.p_offspring;
+            if (is_infected) {
+                effective_r_interact *= traits.debuff_r_interact;
+                effective_p_offspring *= traits.debuff_p_offspring;
+            }
+
+            f.grid.query_neighbors(pos.x, pos.y, effective_r_interact, f.neighbors);
+
+            for (const auto& qr : f.neighbors) {
+                const SpatialGrid::Entry* ne = qr.entry;
+                if (ne->entity_id == e.id()) continue;
+
+                // Same swarm, alive, opposite sex, off cooldown
+                if (ne->swarm_type != traits.swarm_type) continue;
+                if (!(ne->flags & SpatialGrid::FLAG_ALIVE)) continue;
+                bool neighbor_is_male = (ne->flags & SpatialGrid::FLAG_MALE) != 0;
+                if (neighbor_is_male == is_male) continue;
+                if (!(ne->flags & SpatialGrid::FLAG_COOLDOWN_READY)) continue;
+                if (f.mated.count(ne->entity_id)) continue;
+
+                KeyedRng rng(f.seed, f.frame, boid_attempt_key(uid, ne->uid), RngPurpose::Mating);
+                if (!try_reproduce(effective_p_offspring, rng)) continue;
+
+                int count = offspring_count(traits.offspring_mean, traits.offspring_stddev, rng);
+                if (count <= 0) continue;
+
+                // Mating succeeded: only now resolve the partner entity
+                flecs::entity partner = f.w.entity(ne->entity_id);
+                const Position& npos = partner.get<Position>();
+                float spawn_x = (pos.x + npos.x) / 2.0f;
+                float spawn_y = (pos.y + npos.y) / 2.0f;
+
+                // Check if both parents are infected
+                bool neighbor_infected = (ne->flags & SpatialGrid::FLAG_INFECTED) != 0;
+                bool child_infected = false;
+                if (is_infected && neighbor_infected) {
+                    child_infected = try_infect(traits.p_infect, rng);
+                }
+
+                // Queue offspring — inherit the parents' swarm
+                const uint64_t pair = boid_pair_key(uid, ne->uid);
+                for (int i = 0; i < count; ++i) {
+                    SpawnSpec child{};
+                    child.uid = child_boid_uid(pair, f.frame, static_cast<uint32_t>(i));
+                    KeyedRng birth(f.seed, f.frame, child.uid, RngPurpose::Birth);
+                    float angle = dist_angle(birth);
+                    float speed = config.max_speed;
+
+                    child.swarm_type = traits.swarm_type;
+                    child.x = spawn_x;
+                    child.y = spawn_y;
+                    child.vx = speed * std::cos(angle);
+                    child.vy = speed * std::sin(angle);
+                    child.heading = angle;
+                    child.cooldown = config.reproduction_cooldown;
+                    child.male = dist_sex(birth) < 0.5f;
+                    child.infected = child_infected;
+                    f.offspring.push_back(child);
+                }
+
+                cooldown.cooldown = config.reproduction_cooldown;
+                partner.get_mut<ReproductionCooldown>().cooldown = config.reproduction_cooldown;
+                f.mated.insert(e.id());
+                f.mated.insert(ne->entity_id);
+
+                f.stats.newborns_total += count;
+                f.stats.*traits.newborns += count;
+
+                break;
+            }
+        });
+    }
 }
 
 void register_reproduction_system(flecs::world& world) {
+    // Offspring of one frame, handed from the kernel to the bulk spawner
+    auto offspring = std::make_shared<std::vector<SpawnSpec>>();
+
+    auto q_cooldown = world.query_builder<ReproductionCooldown, const Alive>().cached().build();
+    auto q_normal = build_swarm_query<NormalBoid>(world);
+    auto q_doctor = build_swarm_query<DoctorBoid>(world);
+    auto q_antivax = build_swarm_query<AntivaxBoid>(world);
+
     world.system("ReproductionSystem")
         .kind(flecs::PostUpdate)
-        .run([](flecs::iter& it) {
+        .run([offspring, q_cooldown, q_normal, q_doctor, q_antivax](flecs::iter& it) {
             flecs::world w = it.world();
             const SimConfig& config = w.get<SimConfig>();
-            const SpatialGrid& grid = w.get<SpatialGrid>();
-            SimStats& stats = w.get_mut<SimStats>();
-            std::mt19937& rng = sim_rng();
-            std::uniform_real_distribution<float> dist_angle(0.0f, TWO_PI);
-            std::uniform_real_distribution<float> dist_sex(0.0f, 1.0f);
             float dt = it.delta_time();
 
             // First, update cooldowns for all alive boids
-            auto q_cooldown = w.query<ReproductionCooldown, const Alive>();
             q_cooldown.each([dt](ReproductionCooldown& cooldown, const Alive&) {
                 if (cooldown.cooldown > 0.0f) {
                     cooldown.cooldown -= dt;
                 }
             });
 
-            w.defer_begin();
-
-            std::vector<SpatialGrid::QueryResult> neighbors;
-
-            // Process Normal Boid reproduction
-            auto q_normal = w.query<const Position, const Velocity, ReproductionCooldown, const NormalBoid, const Alive>();
-            q_normal.each([&](flecs::entity e, const Position& pos, const Velocity& vel,
-                              ReproductionCooldown& cooldown, const NormalBoid&, const Alive&) {
-                // Skip if on cooldown
-                if (cooldown.cooldown > 0.0f) return;
-
-                bool is_infected = e.has<Infected>();
-
-                // Calculate effective interaction radius (debuffed if infected)
-                float effective_r_interact = config.r_interact_normal;
-                if (is_infected) {
-                    effective_r_interact *= config.debuff_r_interact_normal_infected;
-                }
-
-                // Query neighbors within effective interaction radius
-                grid.query_neighbors(pos.x, pos.y, effective_r_interact, neighbors);
-
-                for (const auto& qr : neighbors) {
-                    uint64_t nid = qr.entry->entity_id;
-                    if (nid == e.id()) continue;
-
-                    flecs::entity ne = w.entity(nid);
-                    if (!ne.is_alive() || !ne.has<Alive>()) continue;
-
-                    // Only reproduce with same swarm type
-                    if (!ne.has<NormalBoid>()) continue;
-
-                    // Check opposite sex requirement
-                    bool parent_is_male = e.has<Male>();
-                    bool neighbor_is_male = ne.has<Male>();
-                    if (parent_is_male == neighbor_is_male) continue; // Same sex, skip
-
-                    // Check neighbor's cooldown
-                    if (!ne.has<ReproductionCooldown>()) continue;
-                    const ReproductionCooldown& ncooldown = ne.get<ReproductionCooldown>();
-                    if (ncooldown.cooldown > 0.0f) continue;
-
-                    // Calculate effective reproduction probability (debuffed if infected)
-                    float effective_p_offspring = config.p_offspring_normal;
-                    if (is_infected) {
-                        effective_p_offspring *= config.debuff_p_offspring_normal_infected;
-                    }
-
-                    // Try to reproduce
-                    if (!try_reproduce(effective_p_offspring, rng)) continue;
-
-                    // Calculate offspring count
-                    int count = offspring_count(config.offspring_mean_normal,
-                                               config.offspring_stddev_normal, rng);
-
-                    if (count <= 0) continue;
-
-                    // Get neighbor position for midpoint calculation
-                    const Position& npos = ne.get<Position>();
-                    float spawn_x = (pos.x + npos.x) / 2.0f;
-                    float spawn_y = (pos.y + npos.y) / 2.0f;
-
-                    // Check if both parents are infected
-                    bool neighbor_infected = ne.has<Infected>();
-                    bool child_infected = false;
-                    if (is_infected && neighbor_infected) {
-                        child_infected = try_infect(config.p_infect_normal, rng);
-                    }
-
-                    // Spawn offspring
-                    for (int i = 0; i < count; ++i) {
-                        float angle = dist_angle(rng);
-                        float speed = config.max_speed;
-
-                        auto child = w.entity()
-                            .add<NormalBoid>()
-                            .add<Alive>()
-                            .set(Position{spawn_x, spawn_y})
-                            .set(Velocity{speed * std::cos(angle), speed * std::sin(angle)})
-                            .set(Heading{angle})
-                            .set(Health{0.0f, 60.0f})
-                            .set(ReproductionCooldown{config.reproduction_cooldown});
-
-                        if (dist_sex(rng) < 0.5f) {
-                            child.add<Male>();
-                        } else {
-                            child.add<Female>();
-                        }
-
-                        if (child_infected) {
-                            child.add<Infected>();
-                            child.set(InfectionState{0.0f, config.t_death});
-                        }
-                    }
-
-                    cooldown.cooldown = config.reproduction_cooldown;
-                    ReproductionCooldown& ncool = ne.get_mut<ReproductionCooldown>();
-                    ncool.cooldown = config.reproduction_cooldown;
-
-                    stats.newborns_total += count;
-                    stats.newborns_normal += count;
-
-                    break;
-                }
-            });
-
-            // Process Doctor Boid reproduction
-            auto q_doctor = w.query<const Position, const Velocity, ReproductionCooldown, const DoctorBoid, const Alive>();
-            q_doctor.each([&](flecs::entity e, const Position& pos, const Velocity& vel,
-                              ReproductionCooldown& cooldown, const DoctorBoid&, const Alive&) {
-                if (cooldown.cooldown > 0.0f) return;
-
-                bool is_infected = e.has<Infected>();
-
-                float effective_r_interact = config.r_interact_doctor;
-                if (is_infected) {
-                    effective_r_interact *= config.debuff_r_interact_doctor_infected;
-                }
-
-                grid.query_neighbors(pos.x, pos.y, effective_r_interact, neighbors);
-
-                for (const auto& qr : neighbors) {
-                    uint64_t nid = qr.entry->entity_id;
-                    if (nid == e.id()) continue;
-
-                    flecs::entity ne = w.entity(nid);
-                    if (!ne.is_alive() || !ne.has<Alive>()) continue;
-
-                    if (!ne.has<DoctorBoid>()) continue;
-
-                    bool parent_is_male = e.has<Male>();
-                    bool neighbor_is_male = ne.has<Male>();
-                    if (parent_is_male == neighbor_is_male) continue;
+            const SimRng* rngs = w.try_get<SimRng>();
+            const SimClock* clock = w.try_get<SimClock>();
+            ReproductionFrame frame{w, config, w.get<SpatialGrid>(), w.get_mut<SimStats>(),
+                                    rngs ? rngs->seed : SIM_RNG_SEED, clock ? clock->frame : 0,
+                                    *offspring, {}, {}};
+
+            const SwarmTraits normal{
+                0, config.r_interact_normal, config.debuff_r_interact_normal_infected,
+                config.p_offspring_normal, config.debuff_p_offspring_normal_infected,
+                config.offspring_mean_normal, config.offspring_stddev_normal,
+                config.p_infect_normal, &SimStats::newborns_normal};
+            const SwarmTraits doctor{
+                1, config.r_interact_doctor, config.debuff_r_interact_doctor_infected,
+                config.p_offspring_doctor, config.debuff_p_offspring_doctor_infected,
+                config.offspring_mean_doctor, config.offspring_stddev_doctor,
+                config.p_infect_doctor, &SimStats::newborns_doctor};
+            // Antivax boids breed with the normal-swarm parameters
+            SwarmTraits antivax = normal;
+            antivax.swarm_type = 2;
+            antivax.newborns = &SimStats::newborns_antivax;
 
-                    if (!ne.has<ReproductionCooldown>()) continue;
-                    const ReproductionCooldown& ncooldown = ne.get<ReproductionCooldown>();
-                    if (ncooldown.cooldown > 0.0f) continue;
-
-                    float effective_p_offspring = config.p_offspring_doctor;
-                    if (is_infected) {
-                        effective_p_offspring *= config.debuff_p_offspring_doctor_infected;
-                    }
-
-                    if (!try_reproduce(effective_p_offspring, rng)) continue;
-
-                    int count = offspring_count(config.offspring_mean_doctor,
-                                               config.offspring_stddev_doctor, rng);
-
-                    if (count <= 0) continue;
-
-                    const Position& npos = ne.get<Position>();
-                    float spawn_x = (pos.x + npos.x) / 2.0f;
-                    float spawn_y = (pos.y + npos.y) / 2.0f;
-
-                    bool neighbor_infected = ne.has<Infected>();
-                    bool child_infected = false;
-                    if (is_infected && neighbor_infected) {
-                        child_infected = try_infect(config.p_infect_doctor, rng);
-                    }
-
-                    for (int i = 0; i < count; ++i) {
-                        float angle = dist_angle(rng);
-                        float speed = config.max_speed;
-
-                        auto child = w.entity()
-                            .add<DoctorBoid>()
-                            .add<Alive>()
-                            .set(Position{spawn_x, spawn_y})
-                            .set(Velocity{speed * std::cos(angle), speed * std::sin(angle)})
-                            .set(Heading{angle})
-                            .set(Health{0.0f, 60.0f})
-                            .set(ReproductionCooldown{config.reproduction_cooldown});
-
-                        if (dist_sex(rng) < 0.5f) {
-                            child.add<Male>();
-                        } else {
-                            child.add<Female>();
-                        }
-
-                        if (child_infected) {
-                            child.add<Infected>();
-                            child.set(InfectionState{0.0f, config.t_death});
-                        }
-                    }
-
-                    cooldown.cooldown = config.reproduction_cooldown;
-                    ReproductionCooldown& ncool = ne.get_mut<ReproductionCooldown>();
-                    ncool.cooldown = config.reproduction_cooldown;
-
-                    stats.newborns_total += count;
-                    stats.newborns_doctor += count;
-
-                    break;
-                }
-            });
-
-            // Process Antivax Boid reproduction
-            auto q_antivax = w.query<const Position, const Velocity, ReproductionCooldown, const AntivaxBoid, const Alive>();
-            q_antivax.each([&](flecs::entity e, const Position& pos, const Velocity& vel,
-                              ReproductionCooldown& cooldown, const AntivaxBoid&, const Alive&) {
-                if (cooldown.cooldown > 0.0f) return;
-
-                bool is_infected = e.has<Infected>();
-
-                float effective_r_interact = config.r_interact_normal;
-                if (is_infected) {
-                    effective_r_interact *= config.debuff_r_interact_normal_infected;
-                }
-
-                grid.query_neighbors(pos.x, pos.y, effective_r_interact, neighbors);
-
-                for (const auto& qr : neighbors) {
-                    uint64_t nid = qr.entry->entity_id;
-                    if (nid == e.id()) continue;
-
-                    flecs::entity ne = w.entity(nid);
-                    if (!ne.is_alive() || !ne.has<Alive>()) continue;
-
-                    if (!ne.has<AntivaxBoid>()) continue;
-
-                    bool parent_is_male = e.has<Male>();
-                    bool neighbor_is_male = ne.has<Male>();
-                    if (parent_is_male == neighbor_is_male) continue;
-
-                    if (!ne.has<ReproductionCooldown>()) continue;
-                    const ReproductionCooldown& ncooldown = ne.get<ReproductionCooldown>();
-                    if (ncooldown.cooldown > 0.0f) continue;
-
-                    float effective_p_offspring = config.p_offspring_normal;
-                    if (is_infected) {
-                        effective_p_offspring *= config.debuff_p_offspring_normal_infected;
-                    }
-
-                    if (!try_reproduce(effective_p_offspring, rng)) continue;
-
-                    int count = offspring_count(config.offspring_mean_normal,
-                                               config.offspring_stddev_normal, rng);
-
-                    if (count <= 0) continue;
-
-                    const Position& npos = ne.get<Position>();
-                    float spawn_x = (pos.x + npos.x) / 2.0f;
-                    float spawn_y = (pos.y + npos.y) / 2.0f;
-
-                    bool neighbor_infected = ne.has<Infected>();
-                    bool child_infected = false;
-                    if (is_infected && neighbor_infected) {
-                        child_infected = try_infect(config.p_infect_normal, rng);
-                    }
-
-                    // Spawn offspring — inherit AntivaxBoid tag from parents
-                    for (int i = 0; i < count; ++i) {
-                        float angle = dist_angle(rng);
-                        float speed = config.max_speed;
-
-                        auto child = w.entity()
-                            .add<AntivaxBoid>()
-                            .add<Alive>()
-                            .set(Position{spawn_x, spawn_y})
-                            .set(Velocity{speed * std::cos(angle), speed * std::sin(angle)})
-                            .set(Heading{angle})
-                            .set(Health{0.0f, 60.0f})
-                            .set(ReproductionCooldown{config.reproduction_cooldown});
-
-                        if (dist_sex(rng) < 0.5f) {
-                            child.add<Male>();
-                        } else {
-                            child.add<Female>();
-                        }
-
-                        if (child_infected) {
-                            child.add<Infected>();
-                            child.set(InfectionState{0.0f, config.t_death});
-                        }
-                    }
-
-                    cooldown.cooldown = config.reproduction_cooldown;
-                    ReproductionCooldown& ncool = ne.get_mut<ReproductionCooldown>();
-                    ncool.cooldown = config.reproduction_cooldown;
-
-                    stats.newborns_total += count;
-                    stats.newborns_antivax += count;
+            w.defer_begin();
+            reproduce_swarm<NormalBoid>(frame, normal, q_normal);
+            reproduce_swarm<DoctorBoid>(frame, doctor, q_doctor);
+            reproduce_swarm<AntivaxBoid>(frame, antivax, q_antivax);
+            w.defer_end();
+        });
 
-                    break;
-                }
-            });
+    // Creates the queued offspring straight into their final tables. Immediate:
+    // ecs_bulk_init cannot run while the world is deferred.
+    world.system("OffspringSpawnSystem")
+        .kind(flecs::PostUpdate)
+        .immediate()
+        .run([offspring](flecs::iter& it) {
+            if (offspring->empty()) return;
+            flecs::world w = it.world();
 
-            w.defer_end();
+            w.defer_suspend();
+            spawn_boids(w, *offspring);
+            w.defer_resume();
+            offspring->clear();
         });
 }
@@ -1,6 +1,7 @@
 #include "systems.h"
 #include "components.h"
 #include "spatial_grid.h"
+#include "boid_state.h"
 #include <flecs.h>
 #include <cmath>
 #include <algorithm>
@@ -11,23 +12,62 @@
 // ============================================================
 
 void register_rebuild_grid_system(flecs::world& world) {
+    auto q = world.query_builder<const Position, const Velocity, const ReproductionCooldown*, const Alive,
+                                 const BoidId*>()
+        .cached()
+        .build();
+
     world.system("RebuildGridSystem")
         .kind(flecs::PreUpdate)
-        .run([](flecs::iter& it) {
+        .run([q](flecs::iter& it) {
             flecs::world w = it.world();
             SpatialGrid& grid = w.get_mut<SpatialGrid>();
+            // Optional: hand-built test worlds may only provide the main grid
+            InteractionIndex* index = w.try_get_mut<InteractionIndex>();
 
             grid.clear();
+            if (index) index->clear();
+
+            // ReproductionSystem ticks cooldowns down by dt before mating, so a boid
+            // is ready this frame iff its cooldown is already <= dt
+            float dt = it.delta_time();
+
+            // Swarm and sex are table-constant: resolve them once per table and
+            // walk the columns directly
+            bool toggle = w.get<SimConfig>().toggle_state_tags;
+            q.run([&grid, index, dt, toggle](flecs::iter& it) {
+                while (it.next()) {
+                    auto pos = it.field<const Position>(0);
+                    auto vel = it.field<const Velocity>(1);
+                    bool has_cooldown = it.is_set(2);
+                    // Hand-built test boids may lack a BoidId; their flecs id stands in
+                    bool has_uid = it.is_set(4);
+                    uint8_t swarm_type = table_swarm_type(it.table());
+                    uint8_t table_flags = SpatialGrid::FLAG_ALIVE;
+                    if (it.table().has<Male>()) table_flags |= SpatialGrid::FLAG_MALE;
+                    TableInfected infected(it, toggle);
+
+                    for (auto i : it) {
+                        uint64_t id = it.entity(i).id();
+                        uint64_t uid = has_uid ? it.field_at<const BoidId>(4, i).value : id;
+                        uint8_t flags = table_flags;
+                        if (infected(it, i)) flags |= SpatialGrid::FLAG_INFECTED;
+                        if (has_cooldown && it.field_at<const ReproductionCooldown>(2, i).cooldown <= dt) {
+                            flags |= SpatialGrid::FLAG_COOLDOWN_READY;
+                        }
 
-            auto q = w.query<const Position, const Velocity, const Alive>();
-            q.each([&grid](flecs::entity e, const Position& pos, const Velocity& vel, const Alive&) {
-                uint8_t swarm_type = e.has<NormalBoid>() ? 0
-                                   : e.has<DoctorBoid>() ? 1 : 2;
-                uint8_t flags = SpatialGrid::FLAG_ALIVE;
-                if (e.has<Infected>()) flags |= SpatialGrid::FLAG_INFECTED;
-                if (e.has<Male>())     flags |= SpatialGrid::FLAG_MALE;
+                        grid.insert(id, pos[i].x, pos[i].y, vel[i].vx, vel[i].vy, swarm_type, flags, uid);
 
-                grid.insert(e.id(), pos.x, pos.y, vel.vx, vel.vy, swarm_type, flags);
+                        if (index) {
+                            if (flags & SpatialGrid::FLAG_INFECTED) {
+                                index->infected.insert(id, pos[i].x, pos[i].y, vel[i].vx, vel[i].vy, swarm_type, flags, uid);
+                            }
+                            if (swarm_type == 1) {
+                                index->doctors.insert(id, pos[i].x, pos[i].y, vel[i].vx, vel[i].vy, swarm_type, flags, uid);
+                            }
+                        }
+                    }
+                }
             });
         });
 }
@@ -37,16 +77,19 @@ void register_rebuild_grid_system(flecs::world& world) {
 // ============================================================
 
 void register_antivax_steering_system(flecs::world& world) {
+    // Only process AntivaxBoid entities (primary swarm tag)
+    auto q = world.query_builder<const Position, Velocity, const AntivaxBoid, const Alive>()
+        .cached()
+        .build();
+
     world.system("AntivaxSteeringSystem")
         .kind(flecs::OnUpdate)
-        .run([](flecs::iter& it) {
+        .run([q](flecs::iter& it) {
             flecs::world w = it.world();
             const SimConfig& config = w.get<SimConfig>();
             const SpatialGrid& grid = w.get<SpatialGrid>();
             float dt = it.delta_time();
 
-            // Only process AntivaxBoid entities (primary swarm tag)
-            auto q = w.query<const Position, Velocity, const AntivaxBoid, const Alive>();
             std::vector<SpatialGrid::QueryResult> neighbors;
             q.each([&](flecs::entity e, const Position& pos, Velocity& vel, const AntivaxBoid&, const Alive&) {
                 // Query for doctors within visual range
@@ -115,15 +158,16 @@ void register_antivax_steering_system(flecs::world& world) {
 }
 
 void register_steering_system(flecs::world& world) {
+    auto q = world.query_builder<const Position, Velocity, const Alive>().cached().build();
+
     world.system("SteeringSystem")
         .kind(flecs::OnUpdate)
-        .run([](flecs::iter& it) {
+        .run([q](flecs::iter& it) {
             flecs::world w = it.world();
             const SimConfig& config = w.get<SimConfig>();
             const SpatialGrid& grid = w.get<SpatialGrid>();
             float dt = it.delta_time();
 
-            auto q = w.query<const Position, Velocity, const Alive>();
             float query_radius = std::max({config.separation_radius,
                                             config.alignment_radius,
                                             config.cohesion_radius});
@@ -132,156 +176,167 @@ void register_steering_system(flecs::world& world) {
             float coh_r_sq = config.cohesion_radius * config.cohesion_radius;
 
             std::vector<SpatialGrid::QueryResult> neighbors;
-            q.each([&](flecs::entity e, const Position& pos, Velocity& vel, const Alive&) {
-                // Query neighbors within the largest steering radius
-                grid.query_neighbors(pos.x, pos.y, query_radius, neighbors);
-
-                // Cache own swarm type once (avoid re-checking per neighbor)
-                int my_swarm = e.has<NormalBoid>() ? 0 : e.has<DoctorBoid>() ? 1 : 2;
-
-                // Separation accumulators (inverse-distance weighted, Model B)
-                float sep_x = 0.0f, sep_y = 0.0f;
-                int sep_count = 0;
-                // Alignment accumulators
-                float ali_vx = 0.0f, ali_vy = 0.0f;
-                int ali_count = 0;
-                // Cohesion accumulators
-                float coh_x = 0.0f, coh_y = 0.0f;
-                int coh_count = 0;
-
-                for (const auto& qr : neighbors) {
-                    const auto* ne = qr.entry;
-                    if (ne->entity_id == e.id()) continue; // skip self
-                    if (qr.dist_sq < 0.000001f) continue; // skip overlapping
-
-                    if (!(ne->flags & SpatialGrid::FLAG_ALIVE)) continue;
-
-                    // Read from enriched entry instead of FLECS lookups
-                    int ne_swarm = static_cast<int>(ne->swarm_type);
-                    bool is_same_swarm = (my_swarm == ne_swarm);
-
-                    // Separation: repel from ALL nearby boids (cross-swarm)
-                    // Model B: normalize(diff) / distance — inverse-distance weighting
-                    if (qr.dist_sq < sep_r_sq) {
-                        float dist = std::sqrt(qr.dist_sq);
-                        float dx = pos.x - ne->x;
-                        float dy = pos.y - ne->y;
-                        sep_x += (dx / dist) / dist;
-                        sep_y += (dy / dist) / dist;
-                        sep_count++;
-                    }
-
-                    // Alignment: match velocity of SAME-SWARM nearby boids only
-                    if (is_same_swarm && qr.dist_sq < ali_r_sq) {
-                        ali_vx += ne->vx;
-                        ali_vy += ne->vy;
-                        ali_count++;
-                    }
-
-                    // Cohesion: steer toward center of mass of SAME-SWARM only
-                    if (is_same_swarm && qr.dist_sq < coh_r_sq) {
-                        coh_x += ne->x;
-                        coh_y += ne->y;
-                        coh_count++;
-                    }
-                }
+            q.run([&](flecs::iter& it) {
+                while (it.next()) {
+                    auto positions = it.field<const Position>(0);
+                    auto velocities = it.field<Velocity>(1);
+                    // Own swarm type is table-constant (avoid re-checking per boid)
+                    int my_swarm = table_swarm_type(it.table());
+
+                    for (auto i : it) {
+                        const Position& pos = positions[i];
+                        Velocity& vel = velocities[i];
+                        uint64_t self_id = it.entity(i).id();
+
+                        // Query neighbors within the largest steering radius
+                        grid.query_neighbors(pos.x, pos.y, query_radius, neighbors);
+
+                        // Separation accumulators (inverse-distance weighted, Model B)
+                        float sep_x = 0.0f, sep_y = 0.0f;
+                        int sep_count = 0;
+                        // Alignment accumulators
+                        float ali_vx = 0.0f, ali_vy = 0.0f;
+                        int ali_count = 0;
+                        // Cohesion accumulators
+                        float coh_x = 0.0f, coh_y = 0.0f;
+                        int coh_count = 0;
+
+                        for (const auto& qr : neighbors) {
+                            const auto* ne = qr.entry;
+                            if (ne->entity_id == self_id) continue; // skip self
+                            if (qr.dist_sq < 0.000001f) continue; // skip overlapping
+
+                            if (!(ne->flags & SpatialGrid::FLAG_ALIVE)) continue;
+
+                            // Read from enriched entry instead of FLECS lookups
+                            int ne_swarm = static_cast<int>(ne->swarm_type);
+                            bool is_same_swarm = (my_swarm == ne_swarm);
+
+                            // Separation: repel from ALL nearby boids (cross-swarm)
+                            // Model B: normalize(diff) / distance — inverse-distance weighting
+                            if (qr.dist_sq < sep_r_sq) {
+                                float dist = std::sqrt(qr.dist_sq);
+                                float dx = pos.x - ne->x;
+                                float dy = pos.y - ne->y;
+                                sep_x += (dx / dist) / dist;
+                                sep_y += (dy / dist) / dist;
+                                sep_count++;
+                            }
+
+                            // Alignment: match velocity of SAME-SWARM nearby boids only
+                            if (is_same_swarm && qr.dist_sq < ali_r_sq) {
+                                ali_vx += ne->vx;
+                                ali_vy += ne->vy;
+                                ali_count++;
+                            }
+
+                            // Cohesion: steer toward center of mass of SAME-SWARM only
+                            if (is_same_swarm && qr.dist_sq < coh_r_sq) {
+                                coh_x += ne->x;
+                                coh_y += ne->y;
+                                coh_count++;
+                            }
+                        }
 
-                float force_x = 0.0f, force_y = 0.0f;
-
-                // --- Separation: Model B (Shiffman) ---
-                // Average, compute desired velocity, truncate per-behavior
-                if (sep_count > 0) {
-                    sep_x /= static_cast<float>(sep_count);
-                    sep_y /= static_cast<float>(sep_count);
-                    float sep_mag = std::sqrt(sep_x * sep_x + sep_y * sep_y);
-                    if (sep_mag > 0.001f) {
-                        // desired = normalize(steer) * max_speed
-                        float desired_vx = (sep_x / sep_mag) * config.max_speed;
-                        float desired_vy = (sep_y / sep_mag) * config.max_speed;
-                        float steer_x = desired_vx - vel.vx;
-                        float steer_y = desired_vy - vel.vy;
-                        // Per-behavior truncation to max_force
-                        float steer_mag = std::sqrt(steer_x * steer_x + steer_y * steer_y);
-                        if (steer_mag > config.max_force) {
-                            float scale = config.max_force / steer_mag;
-                            steer_x *= scale;
-                            steer_y *= scale;
+                        float force_x = 0.0f, force_y = 0.0f;
+
+                        // --- Separation: Model B (Shiffman) ---
+                        // Average, compute desired velocity, truncate per-behavior
+                        if (sep_count > 0) {
+                            sep_x /= static_cast<float>(sep_count);
+                            sep_y /= static_cast<float>(sep_count);
+                            float sep_mag = std::sqrt(sep_x * sep_x + sep_y * sep_y);
+                            if (sep_mag > 0.001f) {
+                                // desired = normalize(steer) * max_speed
+                                float desired_vx = (sep_x / sep_mag) * config.max_speed;
+                                float desired_vy = (sep_y / sep_mag) * config.max_speed;
+                                float steer_x = desired_vx - vel.vx;
+                                float steer_y = desired_vy - vel.vy;
+                                // Per-behavior truncation to max_force
+                                float steer_mag = std::sqrt(steer_x * steer_x + steer_y * steer_y);
+                                if (steer_mag > config.max_force) {
+                                    float scale = config.max_force / steer_mag;
+                                    steer_x *= scale;
+                                    steer_y *= scale;
+                                }
+                                force_x += steer_x * config.separation_weight;
+                                force_y += steer_y * config.separation_weight;
+                            }
                         }
-                        force_x += steer_x * config.separation_weight;
-                        force_y += steer_y * config.separation_weight;
-                    }
-                }
 
-                // --- Alignment: Model B (Shiffman) with per-behavior truncation ---
-                if (ali_count > 0) {
-                    ali_vx /= static_cast<float>(ali_count);
-                    ali_vy /= static_cast<float>(ali_count);
-                    float ali_mag = std::sqrt(ali_vx * ali_vx + ali_vy * ali_vy);
-                    if (ali_mag > 0.001f) {
-                        float desired_vx = (ali_vx / ali_mag) * config.max_speed;
-                        float desired_vy = (ali_vy / ali_mag) * config.max_speed;
-                        float steer_x = desired_vx - vel.vx;
-                        float steer_y = desired_vy - vel.vy;
-                        // Per-behavior truncation to max_force
-                        float steer_mag = std::sqrt(steer_x * steer_x + steer_y * steer_y);
-                        if (steer_mag > config.max_force) {
-                            float scale = config.max_force / steer_mag;
-                            steer_x *= scale;
-                            steer_y *= scale;
+                        // --- Alignment: Model B (Shiffman) with per-behavior truncation ---
+                        if (ali_count > 0) {
+                            ali_vx /= static_cast<float>(ali_count);
+                            ali_vy /= static_cast<float>(ali_count);
+                            float ali_mag = std::sqrt(ali_vx * ali_vx + ali_vy * ali_vy);
+                            if (ali_mag > 0.001f) {
+                                float desired_vx = (ali_vx / ali_mag) * config.max_speed;
+                                float desired_vy = (ali_vy / ali_mag) * config.max_speed;
+                                float steer_x = desired_vx - vel.vx;
+                                float steer_y = desired_vy - vel.vy;
+                                // Per-behavior truncation to max_force
+                                float steer_mag = std::sqrt(steer_x * steer_x + steer_y * steer_y);
+                                if (steer_mag > config.max_force) {
+                                    float scale = config.max_force / steer_mag;
+                                    steer_x *= scale;
+                                    steer_y *= scale;
+                                }
+                                force_x += steer_x * config.alignment_weight;
+                                force_y += steer_y * config.alignment_weight;
+                            }
                         }
-                        force_x += steer_x * config.alignment_weight;
-                        force_y += steer_y * config.alignment_weight;
-                    }
-                }
 
-                // --- Cohesion: Model B (Shiffman) with per-behavior truncation ---
-                if (coh_count > 0) {
-                    coh_x /= static_cast<float>(coh_count);
-                    coh_y /= static_cast<float>(coh_count);
-                    float dx = coh_x - pos.x;
-                    float dy = coh_y - pos.y;
-                    float mag = std::sqrt(dx * dx + dy * dy);
-                    if (mag > 0.001f) {
-                        float desired_vx = (dx / mag) * config.max_speed;
-                        float desired_vy = (dy / mag) * config.max_speed;
-                        float steer_x = desired_vx - vel.vx;
-                        float steer_y = desired_vy - vel.vy;
-                        // Per-behavior truncation to max_force
-                        float steer_mag = std::sqrt(steer_x * steer_x + steer_y * steer_y);
-                        if (steer_mag > config.max_force) {
-                            float scale = config.max_force / steer_mag;
-                            steer_x *= scale;
-                            steer_y *= scale;
+                        // --- Cohesion: Model B (Shiffman) with per-behavior truncation ---
+                        if (coh_count > 0) {
+                            coh_x /= static_cast<float>(coh_count);
+                            coh_y /= static_cast<float>(coh_count);
+                            float dx = coh_x - pos.x;
+                            float dy = coh_y - pos.y;
+                            float mag = std::sqrt(dx * dx + dy * dy);
+                            if (mag > 0.001f) {
+                                float desired_vx = (dx / mag) * config.max_speed;
+                                float desired_vy = (dy / mag) * config.max_speed;
+                                float steer_x = desired_vx - vel.vx;
+                                float steer_y = desired_vy - vel.vy;
+                                // Per-behavior truncation to max_force
+                                float steer_mag = std::sqrt(steer_x * steer_x + steer_y * steer_y);
+                                if (steer_mag > config.max_force) {
+                                    float scale = config.max_force / steer_mag;
+                                    steer_x *= scale;
+                                    steer_y *= scale;
+                                }
+                                force_x += steer_x * config.cohesion_weight;
+                                force_y += steer_y * config.cohesion_weight;
+                            }
                         }
-                        force_x += steer_x * config.cohesion_weight;
-                        force_y += steer_y * config.cohesion_weight;
-                    }
-                }
 
-                // Apply force to velocity
-                vel.vx += force_x * dt;
-                vel.vy += force_y * dt;
+                        // Apply force to velocity
+                        vel.vx += force_x * dt;
+                        vel.vy += force_y * dt;
 
-                // Clamp velocity to max_speed
-                float speed = std::sqrt(vel.vx * vel.vx + vel.vy * vel.vy);
-                if (speed > config.max_speed) {
-                    float scale = config.max_speed / speed;
-                    vel.vx *= scale;
-                    vel.vy *= scale;
+                        // Clamp velocity to max_speed
+                        float speed = std::sqrt(vel.vx * vel.vx + vel.vy * vel.vy);
+                        if (speed > config.max_speed) {
+                            float scale = config.max_speed / speed;
+                            vel.vx *= scale;
+                            vel.vy *= scale;
+                        }
+                    }
                 }
             });
         });
 }
 
 void register_movement_system(flecs::world& world) {
+    auto q = world.query_builder<Position, Velocity, Heading>().cached().build();
+
     world.system("MovementSystem")
         .kind(flecs::OnUpdate)
-        .run([](flecs::iter& it) {
+        .run([q](flecs::iter& it) {
             flecs::world w = it.world();
             const SimConfig& config = w.get<SimConfig>();
             float dt = it.delta_time();
 
-            auto q = w.query<Position, Velocity, Heading>();
             q.each([&](Position& pos, Velocity& vel, Heading& heading) {
                 // Apply velocity to position
                 pos.x += vel.vx * dt;
@@ -0,0 +1,68 @@
+#include "trajectory.h"
+#include "components.h"
+#include "render_state.h"
+#include "io/trajectory.h"
+#include <flecs.h>
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+void register_trajectory_system(flecs::world& world) {
+    world.system("TrajectoryRecordSystem")
+        .kind(flecs::OnStore)
+        .run([](flecs::iter& it) {
+            flecs::world w = it.world();
+            TrajectoryRecorder* recorder = w.try_get_mut<TrajectoryRecorder>();
+            if (!recorder || !recorder->writer) return;
+
+            const SimClock& clock = w.get<SimClock>();
+            const int interval = std::max(1, w.get<SimConfig>().trajectory_interval);
+            if (clock.frame % static_cast<uint64_t>(interval) != 0) return;
+
+            TrajectoryFrame frame;
+            if (recorder->frame_base + clock.frame <= recorder->last_frame) {
+                recorder->frame_base = recorder->last_frame;
+                frame.keyframe = true;
+            }
+            recorder->last_frame = recorder->frame_base + clock.frame;
+
+            // Copy the snapshot; encoding happens on the writer thread
+            const RenderState& rs = w.get<RenderState>();
+            frame.frame = recorder->last_frame;
+            frame.time = clock.time;
+            frame.boids.resize(rs.boids.size());
+            for (size_t i = 0; i < rs.boids.size(); ++i) {
+                const BoidRenderData& b = rs.boids[i];
+                TrajectorySample& s = frame.boids[i];
+                s.id = b.id;
+                s.x = b.x;
+                s.y = b.y;
+                s.angle = b.angle;
+                s.swarm_type = static_cast<uint8_t>(b.swarm_type);
+                s.infected = b.infected;
+            }
+            recorder->writer->push(std::move(frame));
+        });
+}
+
+void open_trajectory_recording(flecs::world& world, const std::string& path) {
+    const SimConfig& config = world.get<SimConfig>();
+    auto writer = std::make_shared<TrajectoryWriter>(
+        path, config.world_width, config.world_height,
+        static_cast<uint32_t>(std::max(1, config.trajectory_keyframe_interval)),
+        config.trajectory_tolerance, config.trajectory_heading_tolerance * (3.14159265f / 180.0f));
+    world.set<TrajectoryRecorder>({writer, 0, 0});
+}
+
+void close_trajectory_recording(flecs::world& world) {
+    const TrajectoryRecorder* recorder = world.try_get<TrajectoryRecorder>();
+    if (!recorder) return;
+    if (recorder->writer) {
+        recorder->writer->close();
+        if (recorder->writer->dropped() > 0) {
+            std::cerr << "Trajectory recording dropped " << recorder->writer->dropped()
+                      << " frames (writer fell behind)\n";
+        }
+    }
+    world.remove<TrajectoryRecorder>();
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <flecs.h>
+#include <memory>
+#include <string>
+
+class TrajectoryWriter;
+
+// Singleton: present only when the run records trajectories (--trajectory-out)
+struct TrajectoryRecorder {
+    std::shared_ptr<TrajectoryWriter> writer;
+    // Recorded frame numbers keep increasing across resets (SimClock restarts
+    // at 0); a reset starts a new segment with a keyframe
+    uint64_t frame_base = 0;
+    uint64_t last_frame = 0;
+};
+
+// Registers TrajectoryRecordSystem. Must be registered after the render sync
+// system: it records the RenderState snapshot of the same frame.
+void register_trajectory_system(flecs::world& world);
+
+// Opens a trajectory file and installs the TrajectoryRecorder singleton.
+// Throws std::runtime_error if the file cannot be created.
+void open_trajectory_recording(flecs::world& world, const std::string& path);
+
+// Flushes and closes the recording (if any) and removes the singleton
+void close_trajectory_recording(flecs::world& world);
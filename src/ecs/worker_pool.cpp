@@ -0,0 +1,72 @@
+#include "worker_pool.h"
+#include <algorithm>
+
+WorkerPool::WorkerPool(unsigned threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    worker_count_ = threads;
+    for (unsigned w = 1; w < worker_count_; ++w) {
+        threads_.emplace_back([this, w]() { worker_loop(w); });
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& t : threads_) {
+        t.join();
+    }
+}
+
+void WorkerPool::run(std::size_t chunks, const std::function<void(std::size_t, unsigned)>& fn) {
+    if (chunks == 0) return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_ = &fn;
+        job_chunks_ = chunks;
+        next_chunk_.store(0);
+        busy_workers_ = static_cast<unsigned>(threads_.size());
+        generation_++;
+    }
+    wake_.notify_all();
+
+    // Caller works as worker 0, then waits for the helpers to finish
+    drain(0);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this]() { return busy_workers_ == 0; });
+    job_ = nullptr;
+}
+
+void WorkerPool::worker_loop(unsigned worker) {
+    uint64_t seen_generation = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&]() { return stopping_ || generation_ != seen_generation; });
+            if (stopping_) return;
+            seen_generation = generation_;
+        }
+
+        drain(worker);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            busy_workers_--;
+        }
+        done_.notify_one();
+    }
+}
+
+void WorkerPool::drain(unsigned worker) {
+    for (;;) {
+        std::size_t chunk = next_chunk_.fetch_add(1);
+        if (chunk >= job_chunks_) return;
+        (*job_)(chunk, worker);
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+
+// ============================================================
+// WorkerPool — persistent threads for data-parallel system bodies
+// ============================================================
+//
+// run() splits `chunks` work items across the workers; the calling thread
+// participates as worker 0. Work functions receive the worker index so they
+// can write into per-worker buffers without locking. Pure C++ — workers must
+// not touch the FLECS world.
+
+class WorkerPool {
+public:
+    // threads = total worker count including the caller; 0 = hardware concurrency
+    explicit WorkerPool(unsigned threads = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    unsigned size() const { return worker_count_; }
+
+    // Calls fn(chunk, worker) once for every chunk in [0, chunks). Blocks until done.
+    void run(std::size_t chunks, const std::function<void(std::size_t, unsigned)>& fn);
+
+private:
+    void worker_loop(unsigned worker);
+    void drain(unsigned worker);
+
+    unsigned worker_count_ = 1;
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const std::function<void(std::size_t, unsigned)>* job_ = nullptr;
+    std::size_t job_chunks_ = 0;
+    std::atomic<std::size_t> next_chunk_{0};
+    unsigned busy_workers_ = 0;
+    uint64_t generation_ = 0;
+    bool stopping_ = false;
+};
+
+// Singleton wrapper so systems can find the world's pool (absent = run serially)
+struct SimWorkers {
+    std::shared_ptr<WorkerPool> pool;
+};
+
+// Runs fn(chunk, worker) for every chunk, on the pool when one is available
+inline void parallel_chunks(WorkerPool* pool, std::size_t chunks,
+                            const std::function<void(std::size_t, unsigned)>& fn) {
+    if (pool && pool->size() > 1 && chunks > 1) {
+        pool->run(chunks, fn);
+    } else {
+        for (std::size_t c = 0; c < chunks; ++c) fn(c, 0);
+    }
+}
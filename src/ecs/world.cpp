@@ -3,11 +3,26 @@
 #include "config_loader.h"
 #include "spatial_grid.h"
 #include "render_state.h"
+#include "worker_pool.h"
+#include "boid_state.h"
+#include "spawn.h"
+#include "sim/population_history.h"
+#include "sim/rng.h"
 #include <flecs.h>
 #include <algorithm>
 #include <iostream>
+#include <memory>
 
 void init_world(flecs::world& world, const std::string& config_path) {
+    // Load SimConfig from file (or use defaults if file not found)
+    SimConfig config{};
+    if (load_config(config_path, config)) {
+        std::cout << "Loaded config from " << config_path << "\n";
+    }
+    init_world(world, config);
+}
+
+void init_world(flecs::world& world, const SimConfig& config) {
     // Register all components from components.h
     world.component<Position>();
     world.component<Velocity>();
@@ -15,6 +30,7 @@ void init_world(flecs::world& world, const std::string& config_path) {
     world.component<Health>();
     world.component<InfectionState>();
     world.component<ReproductionCooldown>();
+    world.component<BoidId>();
 
     // Register tag components
     world.component<NormalBoid>();
@@ -24,23 +40,45 @@ void init_world(flecs::world& world, const std::string& config_path) {
     world.component<Infected>();
     world.component<Alive>();
     world.component<AntivaxBoid>();
+    world.component<Dead>();
+    // toggle_state_tags decides how the hot tags are registered
+    if (config.toggle_state_tags) {
+        register_state_toggles(world);
+    }
 
     // Register SpatialGrid as a component (required before using as singleton)
     world.component<SpatialGrid>();
-    
-    // Load SimConfig from file (or use defaults if file not found)
-    SimConfig config{};
-    if (load_config(config_path, config)) {
-        std::cout << "Loaded config from " << config_path << "\n";
-    }
+    world.component<InteractionIndex>();
+    world.component<SimRng>();
+
     world.set<SimConfig>(config);
 
     // Set SimStats singleton (zeroed)
     world.set<SimStats>({});
 
+    // Full-run population history (multi-resolution, outside SimStats)
+    world.set(PopulationHistory());
+
+    // World-owned random engines, seeded from config.seed
+    world.set(SimRng(static_cast<uint32_t>(config.seed)));
+
+    // Set SimClock singleton (t = 0, frame 0)
+    world.set<SimClock>({});
+
     // Set SimulationState singleton (not paused)
     world.set<SimulationState>({});
 
+    // Worker pool for the parallel interaction systems (absent = serial)
+    if (config.sim_threads != 1) {
+        unsigned threads = static_cast<unsigned>(std::max(0, config.sim_threads));
+        world.set<SimWorkers>({std::make_shared<WorkerPool>(threads)});
+    }
+
+    // Free list for dead boids (absent = destroy them)
+    if (config.recycle_entities) {
+        world.set<BoidRecycler>({});
+    }
+
     // Set RenderState singleton (empty)
     world.set<RenderState>({});
 
@@ -50,4 +88,13 @@ void init_world(flecs::world& world, const std::string& config_path) {
     float cell_size = std::max(config.r_interact_normal, config.r_interact_doctor);
     SpatialGrid grid(config.world_width, config.world_height, cell_size);
     world.set<SpatialGrid>(std::move(grid));
+
+    // Infected/doctor sub-indexes share the main grid's geometry
+    InteractionIndex index(config.world_width, config.world_height, cell_size);
+    world.set<InteractionIndex>(std::move(index));
+}
+
+std::mutex& world_lifetime_mutex() {
+    static std::mutex mutex;
+    return mutex;
 }
@@ -1,6 +1,20 @@
 #pragma once
 
 #include <flecs.h>
+#include <mutex>
 #include <string>
 
+struct SimConfig;
+
+// Loads config_path (defaults if missing) and initializes the world with it
 void init_world(flecs::world& world, const std::string& config_path = "config.ini");
+
+// Registers components and sets every singleton (including the world's own
+// SimRng) for an already-built config
+void init_world(flecs::world& world, const SimConfig& config);
+
+// flecs keeps a little process-wide state (OS API init refcount, C++ component
+// index table) that world creation and destruction update without locking.
+// Code that builds or destroys worlds on several threads holds this lock for
+// setup and teardown; stepping is per-world and needs no lock.
+std::mutex& world_lifetime_mutex();
@@ -0,0 +1,193 @@
+#include "ecs/sweep_runner.h"
+#include "config_loader.h"
+#include "components.h"
+#include "io/stats_stream.h"
+#include "sim/ensemble.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// ============================================================
+// Monte-Carlo ensemble: one config, many seeds, aggregate curves
+// ============================================================
+
+static void print_usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0 << " [config.ini] [options]\n"
+              << "  --runs M         number of seeds (default 32)\n"
+              << "  --seed S         first seed (default: config seed)\n"
+              << "  --threads T      worker threads (default 0 = all cores)\n"
+              << "  --burn-in-cache <dir>  reuse burn-in snapshots (config burn_in_seconds)\n"
+              << "  --frames N       frames per run (default 3600)\n"
+              << "  --seconds T      simulated seconds per run (instead of --frames)\n"
+              << "  --dt S           fixed time step (default 1/60)\n"
+              << "  --interval N     frames between aggregated samples (default 10)\n"
+              << "  --quantiles L    comma-separated levels in (0,1) (default 0.05,0.5,0.95)\n"
+              << "  --out <file>     aggregate curves CSV (default ensemble.csv)\n"
+              << "  --runs-out <file>  per-run final stats CSV\n"
+              << "  --compare key=value  paired A/B: aggregate (variant - base) per seed;\n"
+              << "                   repeat to change several keys in the variant\n"
+              << "  --independent    give the variant arm its own seeds (no common random numbers)\n";
+}
+
+static std::vector<double> parse_levels(const std::string& text) {
+    std::vector<double> levels;
+    std::stringstream ss(text);
+    std::string part;
+    while (std::getline(ss, part, ',')) levels.push_back(std::atof(part.c_str()));
+    return levels;
+}
+
+int main(int argc, char* argv[]) {
+    std::string config_path = "config.ini";
+    std::string out_path = "ensemble.csv";
+    std::string runs_out_path;
+    std::size_t runs = 32;
+    std::string seed_arg;
+    unsigned threads = 0;
+    uint64_t interval = 10;
+    std::vector<double> levels = {0.05, 0.5, 0.95};
+    std::vector<std::string> compares;
+    bool common_random_numbers = true;
+    HeadlessOptions options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--runs" && has_value) {
+            runs = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--seed" && has_value) {
+            seed_arg = argv[++i];
+        } else if (arg == "--burn-in-cache" && has_value) {
+            options.burn_in_cache = argv[++i];
+        } else if (arg == "--threads" && has_value) {
+            threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--frames" && has_value) {
+            options.max_frames = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--seconds" && has_value) {
+            options.max_time = std::atof(argv[++i]);
+            options.max_frames = 0;
+        } else if (arg == "--dt" && has_value) {
+            options.dt = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--interval" && has_value) {
+            interval = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--quantiles" && has_value) {
+            levels = parse_levels(argv[++i]);
+        } else if (arg == "--out" && has_value) {
+            out_path = argv[++i];
+        } else if (arg == "--runs-out" && has_value) {
+            runs_out_path = argv[++i];
+        } else if (arg == "--compare" && has_value) {
+            compares.push_back(argv[++i]);
+        } else if (arg == "--independent") {
+            common_random_numbers = false;
+        } else if (arg == "--help" || arg == "-h") {
+            print_usage(argv[0]);
+            return 0;
+        } else if (!arg.empty() && arg[0] == '-') {
+            print_usage(argv[0]);
+            return 2;
+        } else {
+            config_path = arg;
+        }
+    }
+    // Runs never stop on extinction, so an unbounded run would never end
+    if (runs == 0 || interval == 0 || options.dt <= 0.0f ||
+        (options.max_frames == 0 && options.max_time <= 0.0)) {
+        print_usage(argv[0]);
+        return 2;
+    }
+
+    SimConfig base{};
+    SimConfig variant{};
+    try {
+        load_config(config_path, base);
+        if (!seed_arg.empty() && !set_config_value(base, "seed", seed_arg)) {
+            throw std::runtime_error("cannot set seed");
+        }
+        variant = base;
+        for (const auto& spec : compares) {
+            const std::size_t eq = spec.find('=');
+            const std::string key = spec.substr(0, eq);
+            if (eq == std::string::npos || key == "seed" ||
+                !set_config_value(variant, key, spec.substr(eq + 1))) {
+                throw std::runtime_error("bad --compare '" + spec + "' (expected config_key=value)");
+            }
+        }
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    std::unique_ptr<EnsembleAccumulator> acc;
+    try {
+        acc = std::make_unique<EnsembleAccumulator>(STATS_COLUMN_COUNT, levels);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << e.what() << "\n";
+        return 2;
+    }
+
+    std::ofstream out(out_path);
+    if (!out) {
+        std::cerr << "Cannot open output file: " << out_path << "\n";
+        return 1;
+    }
+
+    std::ofstream runs_out;
+    if (!runs_out_path.empty()) {
+        runs_out.open(runs_out_path);
+        if (!runs_out) {
+            std::cerr << "Cannot open output file: " << runs_out_path << "\n";
+            return 1;
+        }
+        SweepParam seed_param;
+        seed_param.key = "seed";
+        write_sweep_csv_header({seed_param}, runs_out);
+    }
+
+    const bool paired = !compares.empty();
+    std::cerr << "Running " << runs << (paired ? " seed pairs" : " seeds") << " from " << base.seed
+              << (paired && !common_random_numbers ? " (independent arms)" : "") << " -> " << out_path
+              << "\n";
+    const auto start = std::chrono::steady_clock::now();
+    std::size_t done = 0, failed = 0;
+    double sim_seconds = 0.0;
+
+    auto on_done = [&](const SweepPointResult& run) {
+        if (runs_out.is_open()) write_sweep_csv_row(run, runs_out);
+        done++;
+        sim_seconds += run.result.sim_time;
+        if (!run.error.empty()) {
+            failed++;
+            std::cerr << "seed " << base.seed + static_cast<int>(run.index) << ": " << run.error << "\n";
+        }
+        if (done % 10 == 0 || done == runs) {
+            std::cerr << "  " << done << "/" << runs << "\n";
+        }
+    };
+    if (paired) {
+        run_paired_ensemble(base, variant, common_random_numbers, runs, interval, options, threads,
+                            *acc, on_done);
+    } else {
+        run_ensemble(base, runs, interval, options, threads, *acc, on_done);
+    }
+
+    // Paired curves are differences; name them so they are not mistaken for levels
+    std::vector<std::string> delta_names;
+    std::vector<const char*> names(stats_column_names(), stats_column_names() + STATS_COLUMN_COUNT);
+    if (paired) {
+        for (const char* name : names) delta_names.push_back(std::string("delta_") + name);
+        for (std::size_t c = 0; c < names.size(); ++c) names[c] = delta_names[c].c_str();
+    }
+    write_ensemble_csv(*acc, names.data(), out);
+
+    const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "Done: " << done << " runs (" << failed << " failed), " << acc->rows()
+              << " samples each, " << sim_seconds << " simulated s in " << wall << " s wall\n";
+    return failed == 0 ? 0 : 1;
+}
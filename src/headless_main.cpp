@@ -0,0 +1,178 @@
+#include "ecs/world.h"
+#include "ecs/systems.h"
+#include "ecs/spawn.h"
+#include "ecs/stats.h"
+#include "ecs/trajectory.h"
+#include "ecs/runner.h"
+#include "ecs/checkpoint.h"
+#include "ecs/burn_in.h"
+#include "ecs/replay.h"
+#include "io/stats_stream.h"
+#include "components.h"
+#include <flecs.h>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+// ============================================================
+// boid_swarm without a window: fixed-dt batch runs
+// ============================================================
+
+static void print_usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0 << " [config.ini] [options]\n"
+              << "  --frames N            stop after N frames (default 3600, 0 = no limit)\n"
+              << "  --seconds T           stop after T simulated seconds\n"
+              << "  --dt S                fixed time step in seconds (default 1/60)\n"
+              << "  --no-extinction-stop  keep stepping after every boid has died\n"
+              << "  --summary <file>      write final stats as CSV (default: stdout)\n"
+              << "  --stats-out <file>    stream per-frame stats (see stats_to_csv)\n"
+              << "  --trajectory-out <file> record trajectories (see replay_viewer)\n"
+              << "  --resume <file>       continue from a checkpoint (its config replaces config.ini)\n"
+              << "  --checkpoint-out <file> write a checkpoint when the run ends\n"
+              << "  --checkpoint-every N  also rewrite it every N frames (crash-safe resume)\n"
+              << "  --burn-in-cache <dir> reuse burn-in snapshots (config burn_in_seconds) from <dir>\n"
+              << "  --replay-log <file>   log inputs and per-frame state hashes (see boid_replay)\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string config_path = "config.ini";
+    std::string summary_path;
+    std::string stats_out;
+    std::string trajectory_out;
+    std::string resume_path;
+    std::string checkpoint_out;
+    std::string replay_log_path;
+    uint64_t checkpoint_every = 0;
+    HeadlessOptions options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--frames" && has_value) {
+            options.max_frames = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--seconds" && has_value) {
+            options.max_time = std::atof(argv[++i]);
+            options.max_frames = 0;
+        } else if (arg == "--dt" && has_value) {
+            options.dt = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--no-extinction-stop") {
+            options.stop_on_extinction = false;
+        } else if (arg == "--summary" && has_value) {
+            summary_path = argv[++i];
+        } else if (arg == "--stats-out" && has_value) {
+            stats_out = argv[++i];
+        } else if (arg == "--trajectory-out" && has_value) {
+            trajectory_out = argv[++i];
+        } else if (arg == "--resume" && has_value) {
+            resume_path = argv[++i];
+        } else if (arg == "--checkpoint-out" && has_value) {
+            checkpoint_out = argv[++i];
+        } else if (arg == "--checkpoint-every" && has_value) {
+            checkpoint_every = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--replay-log" && has_value) {
+            replay_log_path = argv[++i];
+        } else if (arg == "--burn-in-cache" && has_value) {
+            options.burn_in_cache = argv[++i];
+        } else if (arg == "--help" || arg == "-h") {
+            print_usage(argv[0]);
+            return 0;
+        } else if (!arg.empty() && arg[0] == '-') {
+            print_usage(argv[0]);
+            return 2;
+        } else {
+            config_path = arg;
+        }
+    }
+    if (options.dt <= 0.0f) {
+        std::cerr << "--dt must be positive\n";
+        return 2;
+    }
+    if (checkpoint_every > 0 && checkpoint_out.empty()) {
+        std::cerr << "--checkpoint-every needs --checkpoint-out\n";
+        return 2;
+    }
+
+    HeadlessResult result;
+    try {
+        flecs::world world;
+        if (resume_path.empty()) {
+            init_world(world, config_path);
+        } else {
+            init_world(world, read_checkpoint_config(resume_path));
+        }
+        register_all_systems(world);
+        register_stats_system(world);
+        register_trajectory_system(world);
+        if (resume_path.empty()) {
+            const BurnInSource burn_in = spawn_settled_population(world, options.dt, options.burn_in_cache);
+            if (burn_in != BurnInSource::None) {
+                std::cerr << "Burn-in of " << world.get<SimConfig>().burn_in_seconds << " s: "
+                          << burn_in_source_name(burn_in) << "\n";
+            }
+        } else {
+            load_checkpoint(world, resume_path);
+            std::cerr << "Resumed " << resume_path << " at frame " << world.get<SimClock>().frame << "\n";
+        }
+
+        // Written to a temporary and renamed, so a crash mid-write keeps the last good one
+        auto write_checkpoint_file = [&](flecs::world& w) {
+            const std::string tmp = checkpoint_out + ".tmp";
+            save_checkpoint(w, tmp);
+            // rename replaces the target atomically on POSIX, so a kill never
+            // leaves the run without a checkpoint. Where it refuses to
+            // overwrite (Windows), fall back to remove and retry.
+            if (std::rename(tmp.c_str(), checkpoint_out.c_str()) != 0) {
+                std::remove(checkpoint_out.c_str());
+                if (std::rename(tmp.c_str(), checkpoint_out.c_str()) != 0) {
+                    throw std::runtime_error("Cannot replace checkpoint: " + checkpoint_out);
+                }
+            }
+        };
+        if (!replay_log_path.empty()) open_replay_log(world, replay_log_path);
+        if (checkpoint_every > 0 || !replay_log_path.empty()) {
+            options.on_frame = [&](flecs::world& w) {
+                record_replay_frame(w, options.dt);
+                if (checkpoint_every > 0 && w.get<SimClock>().frame % checkpoint_every == 0) {
+                    write_checkpoint_file(w);
+                }
+            };
+        }
+
+        if (!stats_out.empty()) open_stats_stream(world, stats_out);
+        if (!trajectory_out.empty()) {
+            open_trajectory_recording(world, trajectory_out);
+            options.render_sync = true;
+        }
+
+        result = run_headless(world, options);
+        if (!checkpoint_out.empty()) write_checkpoint_file(world);
+
+        close_stats_stream(world);
+        close_trajectory_recording(world);
+        close_replay_log(world);
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    std::cerr << "Simulated " << result.sim_time << " s (" << result.frames << " frames) in "
+              << result.wall_seconds << " s wall: "
+              << result.sim_seconds_per_wall_second() << " sim-s/wall-s"
+              << " [" << stop_reason_name(result.stop_reason) << "]\n";
+
+    const StatsRecord summary = make_stats_record(result.frames, result.sim_time, result.final_stats);
+    if (summary_path.empty()) {
+        write_stats_csv({summary}, std::cout);
+    } else {
+        std::ofstream out(summary_path);
+        if (!out) {
+            std::cerr << "Cannot open summary file: " << summary_path << "\n";
+            return 1;
+        }
+        write_stats_csv({summary}, out);
+    }
+    return 0;
+}
@@ -0,0 +1,127 @@
+#include "burn_in_cache.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+namespace {
+
+class Fnv1a {
+public:
+    template <typename T>
+    void add(const T& value) {
+        unsigned char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        for (unsigned char b : bytes) {
+            hash_ ^= b;
+            hash_ *= 0x100000001B3ull;
+        }
+    }
+
+    uint64_t value() const { return hash_; }
+
+private:
+    uint64_t hash_ = 0xCBF29CE484222325ull;
+};
+
+} // namespace
+
+uint64_t burn_in_key(const SimConfig& config, float dt) {
+    Fnv1a h;
+    h.add(BURN_IN_VERSION);
+    h.add(config.seed);
+    h.add(config.initial_normal_count);
+    h.add(config.initial_doctor_count);
+    h.add(config.world_width);
+    h.add(config.world_height);
+    h.add(config.p_antivax);
+    h.add(config.r_interact_normal);
+    h.add(config.r_interact_doctor);
+    h.add(config.toggle_state_tags);
+    h.add(config.max_speed);
+    h.add(config.max_force);
+    h.add(config.min_speed);
+    h.add(config.separation_weight);
+    h.add(config.alignment_weight);
+    h.add(config.cohesion_weight);
+    h.add(config.separation_radius);
+    h.add(config.alignment_radius);
+    h.add(config.cohesion_radius);
+    h.add(config.antivax_repulsion_radius);
+    h.add(config.antivax_repulsion_weight);
+    h.add(config.burn_in_seconds);
+    h.add(dt);
+    return h.value();
+}
+
+std::string burn_in_path(const std::string& dir, uint64_t key) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "burnin_%016llx.bin", static_cast<unsigned long long>(key));
+    if (dir.empty()) return name;
+    const char last = dir.back();
+    return (last == '/' || last == '\\') ? dir + name : dir + '/' + name;
+}
+
+bool read_burn_in(const std::string& path, uint64_t key, std::vector<BurnInBoid>& boids) {
+    boids.clear();
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+
+    BurnInHeader header;
+    const BurnInHeader expected;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 ||
+        header.version != BURN_IN_VERSION || header.record_size != sizeof(BurnInBoid) ||
+        header.key != key) {
+        return false;
+    }
+
+    // Size the read by the file, not by a count that may be corrupt
+    in.seekg(0, std::ios::end);
+    const auto bytes = static_cast<uint64_t>(in.tellg()) - sizeof(header);
+    if (bytes != header.count * sizeof(BurnInBoid)) return false;
+    in.seekg(sizeof(header));
+
+    boids.resize(static_cast<std::size_t>(header.count));
+    if (!in.read(reinterpret_cast<char*>(boids.data()),
+                 static_cast<std::streamsize>(boids.size() * sizeof(BurnInBoid)))) {
+        boids.clear();
+        return false;
+    }
+    return true;
+}
+
+bool write_burn_in(const std::string& path, uint64_t key, const std::vector<BurnInBoid>& boids) {
+    // Unique per writer in this process; writers in other processes differ by
+    // the clock, and every writer of a key writes the same bytes anyway
+    static std::atomic<uint64_t> counter{0};
+    const auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+    const std::string tmp = path + ".tmp" + std::to_string(stamp) + "_" + std::to_string(counter++);
+
+    BurnInHeader header;
+    header.record_size = sizeof(BurnInBoid);
+    header.key = key;
+    header.count = boids.size();
+    {
+        std::ofstream out(tmp, std::ios::binary);
+        if (!out) return false;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(boids.data()),
+                  static_cast<std::streamsize>(boids.size() * sizeof(BurnInBoid)));
+        if (!out) {
+            out.close();
+            std::remove(tmp.c_str());
+            return false;
+        }
+    }
+    // Renaming onto an existing file fails on some platforms; the file already
+    // there was written for the same key
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        std::ifstream existing(path, std::ios::binary);
+        return static_cast<bool>(existing);
+    }
+    return true;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "components.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ============================================================
+// Burn-in cache files
+// ============================================================
+//
+// A burn-in snapshot is the settled kinematics of every initial boid, keyed
+// by BoidId. Only what the warm-up can change is stored; everything else is
+// re-spawned from the run's own config. Native byte order:
+//   header (BurnInHeader) | BurnInBoid[count], sorted by uid
+// Files are named by their key; a file whose header does not match is
+// treated as a miss and overwritten.
+
+constexpr uint32_t BURN_IN_VERSION = 1;
+
+struct BurnInHeader {
+    char magic[4] = {'B', 'U', 'R', 'N'};
+    uint32_t version = BURN_IN_VERSION;
+    uint32_t record_size = 0;
+    uint32_t reserved = 0;
+    uint64_t key = 0;
+    uint64_t count = 0;
+};
+
+struct BurnInBoid {
+    uint64_t uid = 0;
+    Position position{};
+    Velocity velocity{};
+    Heading heading{};
+    uint32_t reserved = 0;   // keeps the record free of padding
+};
+
+// FNV-1a over everything that decides a burn-in: the seed, population,
+// world size, swarm mix (p_antivax), grid cell size (r_interact_*), tag
+// layout, every movement parameter, burn_in_seconds and the time step.
+// Epidemic parameters are deliberately left out.
+uint64_t burn_in_key(const SimConfig& config, float dt);
+
+// "<dir>/burnin_<16 hex digits>.bin"
+std::string burn_in_path(const std::string& dir, uint64_t key);
+
+// False (leaving `boids` empty) if the file is missing, truncated or was
+// written for another key or build
+bool read_burn_in(const std::string& path, uint64_t key, std::vector<BurnInBoid>& boids);
+
+// Writes through a temporary file and a rename, so concurrent writers of the
+// same key never leave a torn file. False if the file cannot be written.
+bool write_burn_in(const std::string& path, uint64_t key, const std::vector<BurnInBoid>& boids);
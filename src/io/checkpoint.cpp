@@ -0,0 +1,174 @@
+#include "checkpoint.h"
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+constexpr std::size_t ALIGN = 8;
+
+std::size_t padded(std::size_t bytes) { return (bytes + ALIGN - 1) / ALIGN * ALIGN; }
+
+// Zero bytes up to the next section boundary after `bytes` bytes
+void pad(std::ostream& out, std::size_t bytes) {
+    static const char zeros[ALIGN] = {};
+    out.write(zeros, static_cast<std::streamsize>(padded(bytes) - bytes));
+}
+
+void put(std::ostream& out, const void* data, std::size_t bytes) {
+    out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+    pad(out, bytes);
+}
+
+template <typename T>
+void put_column(std::ostream& out, const T* column, uint64_t rows) {
+    put(out, column, static_cast<std::size_t>(rows) * sizeof(T));
+}
+
+// Bounds-checked cursor over the file image
+class Cursor {
+public:
+    Cursor(const uint8_t* data, std::size_t size) : data_(data), size_(size) {}
+
+    const uint8_t* take(std::size_t bytes) {
+        const std::size_t step = padded(bytes);
+        if (step < bytes || size_ - pos_ < step) {
+            throw std::runtime_error("checkpoint is truncated");
+        }
+        const uint8_t* p = data_ + pos_;
+        pos_ += step;
+        return p;
+    }
+
+    template <typename T>
+    void read(T& value) {
+        std::memcpy(&value, take(sizeof(T)), sizeof(T));
+    }
+
+    template <typename T>
+    const T* column(uint64_t rows) {
+        if (rows > size_ / sizeof(T)) throw std::runtime_error("checkpoint is truncated");
+        return reinterpret_cast<const T*>(take(static_cast<std::size_t>(rows) * sizeof(T)));
+    }
+
+    std::size_t remaining() const { return size_ - pos_; }
+
+private:
+    const uint8_t* data_;
+    std::size_t size_;
+    std::size_t pos_ = 0;
+};
+
+} // namespace
+
+void write_checkpoint(std::ostream& out, const CheckpointGlobals& globals,
+                      const std::vector<CheckpointTable>& tables) {
+    CheckpointHeader header;
+    header.history_levels = static_cast<uint32_t>(globals.history.size());
+    header.history_capacity = globals.history_capacity;
+    header.history_total = globals.history_total;
+    header.recycled_entities = globals.recycled_entities;
+    header.table_count = tables.size();
+    for (const auto& t : tables) header.boid_count += t.rows;
+    put(out, &header, sizeof(header));
+
+    put(out, &globals.config, sizeof(globals.config));
+    put(out, &globals.stats, sizeof(globals.stats));
+    put(out, &globals.clock, sizeof(globals.clock));
+    const uint64_t rng[4] = {globals.rng_seed, globals.rng_epoch, globals.rng_spawned[0],
+                             globals.rng_spawned[1]};
+    put(out, rng, sizeof(rng));
+
+    for (const auto& level : globals.history) {
+        const uint64_t n = level.size();
+        put(out, &n, sizeof(n));
+        // Deques are not contiguous; write bucket by bucket, padded as one block
+        for (const HistoryBucket& b : level) out.write(reinterpret_cast<const char*>(&b), sizeof(b));
+        pad(out, static_cast<std::size_t>(n) * sizeof(HistoryBucket));
+    }
+
+    for (const auto& t : tables) {
+        const uint32_t tags[2] = {t.tags, t.toggled};
+        put(out, tags, sizeof(tags));
+        put(out, &t.rows, sizeof(t.rows));
+        put_column(out, t.position, t.rows);
+        put_column(out, t.velocity, t.rows);
+        put_column(out, t.heading, t.rows);
+        put_column(out, t.health, t.rows);
+        put_column(out, t.cooldown, t.rows);
+        put_column(out, t.uid, t.rows);
+        if (t.tags & CKPT_INFECTION_STATE) put_column(out, t.infection, t.rows);
+        if (t.toggled & CKPT_INFECTED) put_column(out, t.infected_enabled, checkpoint_bit_words(t.rows));
+        if (t.toggled & CKPT_ALIVE) put_column(out, t.alive_enabled, checkpoint_bit_words(t.rows));
+    }
+
+    if (!out) throw std::runtime_error("failed to write checkpoint");
+}
+
+void read_checkpoint(const uint8_t* data, std::size_t size, CheckpointGlobals& globals,
+                     std::vector<CheckpointTable>& tables) {
+    if (reinterpret_cast<std::uintptr_t>(data) % ALIGN != 0) {
+        throw std::runtime_error("checkpoint image is not 8-byte aligned");
+    }
+    Cursor in(data, size);
+
+    CheckpointHeader header;
+    in.read(header);
+    const CheckpointHeader expected;
+    if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("not a checkpoint file");
+    }
+    if (header.version != CHECKPOINT_VERSION) {
+        throw std::runtime_error("unsupported checkpoint version " + std::to_string(header.version));
+    }
+    if (header.config_size != expected.config_size || header.stats_size != expected.stats_size ||
+        header.bucket_size != expected.bucket_size) {
+        throw std::runtime_error("checkpoint was written by an incompatible build");
+    }
+
+    in.read(globals.config);
+    in.read(globals.stats);
+    in.read(globals.clock);
+    uint64_t rng[4];
+    in.read(rng);
+    globals.rng_seed = rng[0];
+    globals.rng_epoch = rng[1];
+    globals.rng_spawned[0] = rng[2];
+    globals.rng_spawned[1] = rng[3];
+
+    // A level holds 2^L samples per bucket; 64 levels cover any uint64 count
+    if (header.history_levels > 64) throw std::runtime_error("checkpoint history is corrupt");
+    globals.history_capacity = header.history_capacity;
+    globals.history_total = header.history_total;
+    globals.recycled_entities = header.recycled_entities;
+    globals.history.assign(header.history_levels, {});
+    for (auto& level : globals.history) {
+        uint64_t n = 0;
+        in.read(n);
+        const HistoryBucket* buckets = in.column<HistoryBucket>(n);
+        level.assign(buckets, buckets + n);
+    }
+
+    tables.clear();
+    if (header.table_count > in.remaining() / 16) throw std::runtime_error("checkpoint is truncated");
+    tables.reserve(static_cast<std::size_t>(header.table_count));
+    for (uint64_t i = 0; i < header.table_count; ++i) {
+        CheckpointTable t;
+        uint32_t tags[2];
+        in.read(tags);
+        t.tags = tags[0];
+        t.toggled = tags[1];
+        in.read(t.rows);
+        t.position = in.column<Position>(t.rows);
+        t.velocity = in.column<Velocity>(t.rows);
+        t.heading = in.column<Heading>(t.rows);
+        t.health = in.column<Health>(t.rows);
+        t.cooldown = in.column<ReproductionCooldown>(t.rows);
+        t.uid = in.column<BoidId>(t.rows);
+        if (t.tags & CKPT_INFECTION_STATE) t.infection = in.column<InfectionState>(t.rows);
+        if (t.toggled & CKPT_INFECTED) t.infected_enabled = in.column<uint64_t>(checkpoint_bit_words(t.rows));
+        if (t.toggled & CKPT_ALIVE) t.alive_enabled = in.column<uint64_t>(checkpoint_bit_words(t.rows));
+        tables.push_back(t);
+    }
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "components.h"
+#include "sim/population_history.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iosfwd>
+#include <vector>
+
+// ============================================================
+// Binary world checkpoints
+// ============================================================
+//
+// The file is the SoA columns of every boid table, back to back, so saving
+// is a sequence of raw column writes and loading can point straight into a
+// memory-mapped file. Native byte order; every section starts 8-byte aligned.
+//   header (CheckpointHeader)
+//   SimConfig | SimStats | SimClock | rng seed, epoch, spawned[2] (u64 each)
+//   history: per level u64 n, HistoryBucket[n]
+//   tables, in flecs table order: u32 tags | u32 toggled | u64 rows, then
+//     Position[] Velocity[] Heading[] Health[] ReproductionCooldown[] BoidId[]
+//     InfectionState[] (if CKPT_INFECTION_STATE)
+//     u64 enabled-bit words, ceil(rows / 64) per toggled tag (Infected, Alive)
+// Struct sizes are recorded in the header; a file from a build with
+// different layouts is rejected rather than misread.
+
+constexpr uint32_t CHECKPOINT_VERSION = 3;
+
+// Archetype of a boid table
+enum CheckpointTag : uint32_t {
+    CKPT_NORMAL          = 1u << 0,
+    CKPT_DOCTOR          = 1u << 1,
+    CKPT_ANTIVAX         = 1u << 2,
+    CKPT_MALE            = 1u << 3,
+    CKPT_FEMALE          = 1u << 4,
+    CKPT_INFECTED        = 1u << 5,
+    CKPT_ALIVE           = 1u << 6,
+    CKPT_DEAD            = 1u << 7,
+    CKPT_INFECTION_STATE = 1u << 8,
+    CKPT_INFECTED_TOGGLE = 1u << 9,    // toggle bitset of Infected (ECS_TOGGLE|Infected)
+    CKPT_ALIVE_TOGGLE    = 1u << 10,   // toggle bitset of Alive
+};
+
+struct CheckpointHeader {
+    char magic[4] = {'B', 'C', 'K', 'P'};
+    uint32_t version = CHECKPOINT_VERSION;
+    uint32_t config_size = sizeof(SimConfig);
+    uint32_t stats_size = sizeof(SimStats);
+    uint32_t bucket_size = sizeof(HistoryBucket);
+    uint32_t history_levels = 0;
+    uint64_t history_capacity = 0;
+    uint64_t history_total = 0;
+    uint64_t table_count = 0;
+    uint64_t boid_count = 0;
+    uint64_t recycled_entities = 0;
+};
+
+// Everything outside the boid tables
+struct CheckpointGlobals {
+    SimConfig config{};
+    SimStats stats{};
+    SimClock clock{};
+    uint64_t rng_seed = 0;
+    uint64_t rng_epoch = 0;
+    uint64_t rng_spawned[2] = {0, 0};
+    uint64_t history_capacity = 0;
+    uint64_t history_total = 0;
+    uint64_t recycled_entities = 0;   // parked BoidRecycler entities (recycle_entities)
+    std::vector<std::deque<HistoryBucket>> history;
+};
+
+// One table's columns. Writers point these at live storage; readers point
+// them into the loaded (or mapped) file. Bit words: bit i of word i / 64 is
+// row i's enabled state.
+struct CheckpointTable {
+    uint32_t tags = 0;      // CheckpointTag bits
+    uint32_t toggled = 0;   // CKPT_INFECTED / CKPT_ALIVE: per-row enabled bits follow
+    uint64_t rows = 0;
+    const Position* position = nullptr;
+    const Velocity* velocity = nullptr;
+    const Heading* heading = nullptr;
+    const Health* health = nullptr;
+    const ReproductionCooldown* cooldown = nullptr;
+    const BoidId* uid = nullptr;
+    const InfectionState* infection = nullptr;    // CKPT_INFECTION_STATE only
+    const uint64_t* infected_enabled = nullptr;   // toggled & CKPT_INFECTED only
+    const uint64_t* alive_enabled = nullptr;      // toggled & CKPT_ALIVE only
+};
+
+inline std::size_t checkpoint_bit_words(uint64_t rows) {
+    return static_cast<std::size_t>((rows + 63) / 64);
+}
+
+// Throws std::runtime_error if the stream fails
+void write_checkpoint(std::ostream& out, const CheckpointGlobals& globals,
+                      const std::vector<CheckpointTable>& tables);
+
+// Parses a checkpoint held in memory. `data` must be 8-byte aligned and
+// outlive `tables`, whose columns point into it. Throws std::runtime_error
+// on a truncated, foreign or incompatible file.
+void read_checkpoint(const uint8_t* data, std::size_t size, CheckpointGlobals& globals,
+                     std::vector<CheckpointTable>& tables);
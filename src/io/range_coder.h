@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Adaptive binary range coder (LZMA-style: 11-bit probabilities, carries
+// propagated through a cached byte). Encoder and decoder must make the same
+// sequence of calls against the same models; all arithmetic is integer, so
+// both sides agree exactly.
+
+struct BitModel {
+    uint16_t p = 1024;   // probability of a 0 bit, out of 2048
+};
+
+class RangeEncoder {
+public:
+    explicit RangeEncoder(std::vector<uint8_t>& out) : out_(out) {}
+
+    void bit(BitModel& m, unsigned b) {
+        const uint32_t bound = (range_ >> 11) * m.p;
+        if (b == 0) {
+            range_ = bound;
+            m.p = static_cast<uint16_t>(m.p + ((2048 - m.p) >> 5));
+        } else {
+            low_ += bound;
+            range_ -= bound;
+            m.p = static_cast<uint16_t>(m.p - (m.p >> 5));
+        }
+        normalize();
+    }
+
+    // Equiprobable bits, most significant first
+    void direct_bits(uint32_t value, int count) {
+        while (count-- > 0) {
+            range_ >>= 1;
+            if ((value >> count) & 1) low_ += range_;
+            normalize();
+        }
+    }
+
+    void finish() {
+        for (int i = 0; i < 5; ++i) shift_low();
+    }
+
+private:
+    void normalize() {
+        while (range_ < (1u << 24)) {
+            range_ <<= 8;
+            shift_low();
+        }
+    }
+
+    void shift_low() {
+        if (static_cast<uint32_t>(low_) < 0xFF000000u || (low_ >> 32) != 0) {
+            uint8_t carry = static_cast<uint8_t>(low_ >> 32);
+            uint8_t byte = cache_;
+            do {
+                out_.push_back(static_cast<uint8_t>(byte + carry));
+                byte = 0xFF;
+            } while (--cache_size_ != 0);
+            cache_ = static_cast<uint8_t>(low_ >> 24);
+        }
+        cache_size_++;
+        low_ = (low_ & 0x00FFFFFFu) << 8;
+    }
+
+    std::vector<uint8_t>& out_;
+    uint64_t low_ = 0;
+    uint32_t range_ = 0xFFFFFFFFu;
+    uint8_t cache_ = 0;
+    uint64_t cache_size_ = 1;
+};
+
+// Reads past the end of the data as zero bytes: the caller bounds the coded
+// segment, and the encoder's flush covers every bit it wrote.
+class RangeDecoder {
+public:
+    RangeDecoder(const uint8_t* data, std::size_t size) : data_(data), size_(size) {
+        for (int i = 0; i < 5; ++i) code_ = (code_ << 8) | next_byte();
+    }
+
+    unsigned bit(BitModel& m) {
+        const uint32_t bound = (range_ >> 11) * m.p;
+        unsigned b;
+        if (code_ < bound) {
+            range_ = bound;
+            m.p = static_cast<uint16_t>(m.p + ((2048 - m.p) >> 5));
+            b = 0;
+        } else {
+            code_ -= bound;
+            range_ -= bound;
+            m.p = static_cast<uint16_t>(m.p - (m.p >> 5));
+            b = 1;
+        }
+        normalize();
+        return b;
+    }
+
+    uint32_t direct_bits(int count) {
+        uint32_t value = 0;
+        while (count-- > 0) {
+            range_ >>= 1;
+            unsigned b = 0;
+            if (code_ >= range_) {
+                code_ -= range_;
+                b = 1;
+            }
+            value = (value << 1) | b;
+            normalize();
+        }
+        return value;
+    }
+
+private:
+    uint8_t next_byte() { return pos_ < size_ ? data_[pos_++] : 0; }
+
+    void normalize() {
+        while (range_ < (1u << 24)) {
+            range_ <<= 8;
+            code_ = (code_ << 8) | next_byte();
+        }
+    }
+
+    const uint8_t* data_;
+    std::size_t size_;
+    std::size_t pos_ = 0;
+    uint32_t code_ = 0;
+    uint32_t range_ = 0xFFFFFFFFu;
+};
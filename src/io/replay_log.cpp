@@ -0,0 +1,133 @@
+#include "replay_log.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+constexpr std::size_t ALIGN = 8;
+
+std::size_t padded(std::size_t bytes) { return (bytes + ALIGN - 1) / ALIGN * ALIGN; }
+
+bool frame_differs(const ReplayFrame& a, const ReplayFrame& b) {
+    return a.frame != b.frame || a.hash != b.hash;
+}
+
+} // namespace
+
+std::vector<ReplayFrame> ReplayLog::frames() const {
+    std::vector<ReplayFrame> out;
+    for (const ReplayEvent& e : events) {
+        if (e.type == ReplayRecord::Frame) out.push_back(e.frame);
+    }
+    return out;
+}
+
+ReplayLogWriter::ReplayLogWriter(const std::string& path, const uint8_t* image, std::size_t image_bytes,
+                                 const StateHash& start)
+    : out_(path, std::ios::binary) {
+    if (!out_) throw std::runtime_error("Cannot create replay log: " + path);
+    ReplayLogHeader header;
+    header.image_bytes = image_bytes;
+    header.start = start;
+    out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out_.write(reinterpret_cast<const char*>(image), static_cast<std::streamsize>(image_bytes));
+    static const char zeros[ALIGN] = {};
+    out_.write(zeros, static_cast<std::streamsize>(padded(image_bytes) - image_bytes));
+    if (!out_) throw std::runtime_error("Cannot write replay log: " + path);
+}
+
+void ReplayLogWriter::put(ReplayRecord type, const void* payload, std::size_t bytes) {
+    const uint32_t tag = static_cast<uint32_t>(type);
+    out_.write(reinterpret_cast<const char*>(&tag), sizeof(tag));
+    if (bytes > 0) out_.write(static_cast<const char*>(payload), static_cast<std::streamsize>(bytes));
+}
+
+void ReplayLogWriter::config(const SimConfig& config) { put(ReplayRecord::Config, &config, sizeof(config)); }
+
+void ReplayLogWriter::reset() { put(ReplayRecord::Reset, nullptr, 0); }
+
+void ReplayLogWriter::frame(const ReplayFrame& frame) { put(ReplayRecord::Frame, &frame, sizeof(frame)); }
+
+ReplayLog read_replay_log(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("Cannot open replay log: " + path);
+
+    ReplayLogHeader header;
+    const ReplayLogHeader expected;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("not a replay log: " + path);
+    }
+    if (header.version != REPLAY_LOG_VERSION || header.config_size != expected.config_size) {
+        throw std::runtime_error("replay log was written by an incompatible build: " + path);
+    }
+
+    in.seekg(0, std::ios::end);
+    const auto file_bytes = static_cast<uint64_t>(in.tellg());
+    if (header.image_bytes > file_bytes - sizeof(header)) {
+        throw std::runtime_error("replay log is truncated: " + path);
+    }
+    in.seekg(sizeof(header));
+
+    ReplayLog log;
+    log.image_bytes = static_cast<std::size_t>(header.image_bytes);
+    log.start = header.start;
+    log.image.resize(padded(log.image_bytes) / ALIGN);
+    if (!in.read(reinterpret_cast<char*>(log.image.data()),
+                 static_cast<std::streamsize>(log.image.size() * ALIGN))) {
+        throw std::runtime_error("replay log is truncated: " + path);
+    }
+
+    uint32_t tag = 0;
+    while (in.read(reinterpret_cast<char*>(&tag), sizeof(tag))) {
+        ReplayEvent event;
+        event.type = static_cast<ReplayRecord>(tag);
+        bool complete = true;
+        switch (event.type) {
+            case ReplayRecord::Config:
+                complete = static_cast<bool>(
+                    in.read(reinterpret_cast<char*>(&event.config), sizeof(event.config)));
+                break;
+            case ReplayRecord::Reset:
+                break;
+            case ReplayRecord::Frame:
+                complete = static_cast<bool>(
+                    in.read(reinterpret_cast<char*>(&event.frame), sizeof(event.frame)));
+                break;
+            default:
+                throw std::runtime_error("replay log is corrupt (record type " + std::to_string(tag) +
+                                         "): " + path);
+        }
+        if (!complete) break;
+        log.events.push_back(event);
+    }
+    return log;
+}
+
+long long first_divergent_frame(const std::vector<ReplayFrame>& a, const std::vector<ReplayFrame>& b) {
+    const std::size_t n = std::min(a.size(), b.size());
+    if (n == 0 || !frame_differs(a[n - 1], b[n - 1])) return -1;
+    std::size_t lo = 0, hi = n - 1;   // hi differs
+    while (lo < hi) {
+        const std::size_t mid = lo + (hi - lo) / 2;
+        if (frame_differs(a[mid], b[mid])) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return static_cast<long long>(lo);
+}
+
+std::string describe_hash_difference(const StateHash& a, const StateHash& b) {
+    std::string parts;
+    auto add = [&](const char* name) {
+        if (!parts.empty()) parts += ',';
+        parts += name;
+    };
+    if (a.kinematics != b.kinematics) add("kinematics");
+    if (a.epidemic != b.epidemic) add("epidemic");
+    if (a.globals != b.globals) add("globals");
+    return parts;
+}
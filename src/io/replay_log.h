@@ -0,0 +1,105 @@
+#pragma once
+
+#include "components.h"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// ============================================================
+// Replay logs: inputs and per-frame state hashes of one run
+// ============================================================
+//
+// A log holds the world as it was when logging started (a checkpoint image,
+// see ecs/checkpoint.h) followed by everything that drove it since, in
+// order, so the run can be re-simulated and checked frame by frame:
+//   header (ReplayLogHeader, with the starting world's hash)
+//   checkpoint image, padded to 8 bytes
+//   records: u32 type | payload
+//     Config  SimConfig in effect from the next frame on (UI sliders)
+//     Reset   reset_simulation() before the next frame
+//     Frame   ReplayFrame: one world.progress(dt) and the resulting hashes
+// Native byte order; SimConfig's size is recorded and checked.
+
+constexpr uint32_t REPLAY_LOG_VERSION = 1;
+
+enum class ReplayRecord : uint32_t {
+    Config = 1,
+    Reset = 2,
+    Frame = 3,
+};
+
+// World state split by what it covers, so a divergence says where it started
+struct StateHash {
+    uint64_t kinematics = 0;   // Position, Velocity, Heading, BoidId columns
+    uint64_t epidemic = 0;     // tags, enabled bits, Health, InfectionState, cooldowns
+    uint64_t globals = 0;      // SimStats, SimClock, SimRng, population history length
+
+    bool operator==(const StateHash& o) const {
+        return kinematics == o.kinematics && epidemic == o.epidemic && globals == o.globals;
+    }
+    bool operator!=(const StateHash& o) const { return !(*this == o); }
+};
+
+struct ReplayLogHeader {
+    char magic[4] = {'B', 'R', 'P', 'L'};
+    uint32_t version = REPLAY_LOG_VERSION;
+    uint32_t config_size = sizeof(SimConfig);
+    uint32_t reserved = 0;
+    uint64_t image_bytes = 0;
+    StateHash start;           // the starting world's hash
+};
+
+struct ReplayFrame {
+    uint64_t frame = 0;        // SimClock::frame after the step
+    float dt = 0.0f;
+    uint32_t reserved = 0;
+    StateHash hash;
+};
+
+struct ReplayEvent {
+    ReplayRecord type = ReplayRecord::Frame;
+    SimConfig config{};        // Config only
+    ReplayFrame frame;         // Frame only
+};
+
+struct ReplayLog {
+    std::vector<uint64_t> image;     // initial checkpoint, 8-byte aligned
+    std::size_t image_bytes = 0;
+    StateHash start;
+    std::vector<ReplayEvent> events;
+
+    std::vector<ReplayFrame> frames() const;
+};
+
+class ReplayLogWriter {
+public:
+    // Writes the header and the initial checkpoint image. Throws
+    // std::runtime_error if the file cannot be created.
+    ReplayLogWriter(const std::string& path, const uint8_t* image, std::size_t image_bytes,
+                    const StateHash& start);
+
+    void config(const SimConfig& config);
+    void reset();
+    void frame(const ReplayFrame& frame);
+    void flush() { out_.flush(); }
+
+private:
+    void put(ReplayRecord type, const void* payload, std::size_t bytes);
+
+    std::ofstream out_;
+};
+
+// Throws std::runtime_error on a missing, foreign or corrupt file. A log cut
+// short mid-record (a crashed run) keeps its complete records.
+ReplayLog read_replay_log(const std::string& path);
+
+// Index of the first frame whose hash differs between `a` and `b` (within
+// their common length), or -1 if none does. Flocking is chaotic, so once two
+// runs differ they stay different; the search relies on that and bisects,
+// comparing O(log n) frames.
+long long first_divergent_frame(const std::vector<ReplayFrame>& a, const std::vector<ReplayFrame>& b);
+
+// Comma-separated parts of `a` that differ from `b` ("kinematics", ...)
+std::string describe_hash_difference(const StateHash& a, const StateHash& b);
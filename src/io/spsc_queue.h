@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Bounded lock-free single-producer / single-consumer ring buffer.
+// One thread may call try_push, one (other) thread may call try_pop.
+// Capacity is rounded up to a power of two; one slot is kept free.
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(std::size_t capacity) {
+        std::size_t size = 2;
+        while (size < capacity + 1) size <<= 1;
+        slots_.resize(size);
+        mask_ = size - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer side. Returns false (and drops nothing) when the queue is full.
+    bool try_push(const T& value) {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        const std::size_t next = (head + 1) & mask_;
+        if (next == tail_.load(std::memory_order_acquire)) return false;
+        slots_[head] = value;
+        head_.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Moves value in on success; leaves it untouched when the queue is full
+    bool try_push(T&& value) {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        const std::size_t next = (head + 1) & mask_;
+        if (next == tail_.load(std::memory_order_acquire)) return false;
+        slots_[head] = std::move(value);
+        head_.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false when the queue is empty.
+    bool try_pop(T& out) {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) return false;
+        out = std::move(slots_[tail]);
+        tail_.store((tail + 1) & mask_, std::memory_order_release);
+        return true;
+    }
+
+    std::size_t capacity() const { return mask_; }
+
+private:
+    std::vector<T> slots_;
+    std::size_t mask_ = 0;
+    // Separate cache lines: producer writes head_, consumer writes tail_
+    alignas(64) std::atomic<std::size_t> head_{0};
+    alignas(64) std::atomic<std::size_t> tail_{0};
+};
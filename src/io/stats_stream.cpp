@@ -0,0 +1,251 @@
+#include "stats_stream.h"
+#include "components.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+
+namespace {
+
+constexpr char HEADER_MAGIC[4]  = {'B', 'S', 'T', 'S'};
+constexpr char CHUNK_MAGIC[4]   = {'C', 'H', 'N', 'K'};
+constexpr char INDEX_MAGIC[4]   = {'B', 'S', 'T', 'I'};
+constexpr char TRAILER_MAGIC[4] = {'B', 'S', 'T', 'E'};
+
+const char* const COLUMN_NAMES[STATS_COLUMN_COUNT] = {
+    "normal_alive",   "doctor_alive",    "antivax_alive",    "infected_alive",
+    "dead_total",     "dead_normal",     "dead_doctor",      "dead_antivax",
+    "newborns_total", "newborns_normal", "newborns_doctor",  "newborns_antivax",
+};
+
+template <typename T>
+void write_pod(std::ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool read_pod(std::istream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+bool read_magic(std::istream& in, const char (&magic)[4]) {
+    char buf[4];
+    if (!in.read(buf, 4)) return false;
+    return std::memcmp(buf, magic, 4) == 0;
+}
+
+// Reads one chunk body (after its magic) and appends its records
+void read_chunk(std::istream& in, std::vector<StatsRecord>& out) {
+    uint32_t n = 0;
+    if (!read_pod(in, n)) throw std::runtime_error("Truncated stats stream chunk");
+    const std::size_t base = out.size();
+    out.resize(base + n);
+    for (uint32_t i = 0; i < n; ++i) read_pod(in, out[base + i].frame);
+    for (uint32_t i = 0; i < n; ++i) read_pod(in, out[base + i].time);
+    for (int c = 0; c < STATS_COLUMN_COUNT; ++c)
+        for (uint32_t i = 0; i < n; ++i) read_pod(in, out[base + i].values[c]);
+    if (!in) throw std::runtime_error("Truncated stats stream chunk");
+}
+
+} // namespace
+
+const char* const* stats_column_names() {
+    return COLUMN_NAMES;
+}
+
+StatsRecord make_stats_record(uint64_t frame, double time, const SimStats& stats) {
+    StatsRecord r;
+    r.frame = frame;
+    r.time = time;
+    r.values[0]  = stats.normal_alive;
+    r.values[1]  = stats.doctor_alive;
+    r.values[2]  = stats.antivax_alive;
+    r.values[3]  = stats.infected_alive;
+    r.values[4]  = stats.dead_total;
+    r.values[5]  = stats.dead_normal;
+    r.values[6]  = stats.dead_doctor;
+    r.values[7]  = stats.dead_antivax;
+    r.values[8]  = stats.newborns_total;
+    r.values[9]  = stats.newborns_normal;
+    r.values[10] = stats.newborns_doctor;
+    r.values[11] = stats.newborns_antivax;
+    return r;
+}
+
+// ============================================================
+// StatsStreamWriter
+// ============================================================
+
+StatsStreamWriter::StatsStreamWriter(const std::string& path,
+                                     std::size_t chunk_records,
+                                     std::size_t queue_capacity)
+    : out_(path, std::ios::binary | std::ios::trunc),
+      chunk_records_(chunk_records > 0 ? chunk_records : 1),
+      queue_(queue_capacity) {
+    if (!out_) {
+        throw std::runtime_error("Cannot open stats stream file: " + path);
+    }
+    out_.write(HEADER_MAGIC, 4);
+    write_pod(out_, STATS_STREAM_VERSION);
+    write_pod(out_, static_cast<uint32_t>(STATS_COLUMN_COUNT));
+    pending_.reserve(chunk_records_);
+    thread_ = std::thread(&StatsStreamWriter::run, this);
+}
+
+StatsStreamWriter::~StatsStreamWriter() {
+    close();
+}
+
+bool StatsStreamWriter::push(const StatsRecord& record) {
+    if (queue_.try_push(record)) return true;
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void StatsStreamWriter::run() {
+    StatsRecord record;
+    for (;;) {
+        bool got_any = false;
+        while (queue_.try_pop(record)) {
+            got_any = true;
+            pending_.push_back(record);
+            if (pending_.size() >= chunk_records_) flush_chunk();
+        }
+        if (!got_any) {
+            // Check stop only after an empty pop so close() drains everything
+            if (stop_.load(std::memory_order_acquire)) {
+                while (queue_.try_pop(record)) {
+                    pending_.push_back(record);
+                    if (pending_.size() >= chunk_records_) flush_chunk();
+                }
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+}
+
+void StatsStreamWriter::flush_chunk() {
+    if (pending_.empty()) return;
+    const uint32_t n = static_cast<uint32_t>(pending_.size());
+    index_.push_back({static_cast<uint64_t>(out_.tellp()), pending_.front().frame, n});
+
+    out_.write(CHUNK_MAGIC, 4);
+    write_pod(out_, n);
+    for (const auto& r : pending_) write_pod(out_, r.frame);
+    for (const auto& r : pending_) write_pod(out_, r.time);
+    for (int c = 0; c < STATS_COLUMN_COUNT; ++c)
+        for (const auto& r : pending_) write_pod(out_, r.values[c]);
+    out_.flush();
+    pending_.clear();
+}
+
+void StatsStreamWriter::close() {
+    if (closed_) return;
+    closed_ = true;
+    stop_.store(true, std::memory_order_release);
+    if (thread_.joinable()) thread_.join();
+
+    flush_chunk();
+    const uint64_t index_offset = static_cast<uint64_t>(out_.tellp());
+    out_.write(INDEX_MAGIC, 4);
+    write_pod(out_, static_cast<uint32_t>(index_.size()));
+    for (const auto& ci : index_) {
+        write_pod(out_, ci.offset);
+        write_pod(out_, ci.first_frame);
+        write_pod(out_, ci.count);
+    }
+    write_pod(out_, index_offset);
+    out_.write(TRAILER_MAGIC, 4);
+    out_.close();
+}
+
+// ============================================================
+// Reader / CSV conversion
+// ============================================================
+
+std::vector<StatsRecord> read_stats_stream(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("Cannot open stats stream file: " + path);
+
+    uint32_t version = 0, columns = 0;
+    if (!read_magic(in, HEADER_MAGIC) || !read_pod(in, version) || !read_pod(in, columns)) {
+        throw std::runtime_error("Not a stats stream file: " + path);
+    }
+    if (version != STATS_STREAM_VERSION || columns != STATS_COLUMN_COUNT) {
+        throw std::runtime_error("Unsupported stats stream version/schema: " + path);
+    }
+    const std::streamoff data_start = in.tellg();
+
+    std::vector<StatsRecord> records;
+
+    // Fast path: trailer -> index -> seek to each chunk
+    in.seekg(0, std::ios::end);
+    const std::streamoff file_size = in.tellg();
+    const std::streamoff trailer_size = sizeof(uint64_t) + 4;
+    if (file_size >= data_start + trailer_size) {
+        in.seekg(file_size - trailer_size);
+        uint64_t index_offset = 0;
+        if (read_pod(in, index_offset) && read_magic(in, TRAILER_MAGIC)) {
+            in.seekg(static_cast<std::streamoff>(index_offset));
+            uint32_t chunk_count = 0;
+            if (!read_magic(in, INDEX_MAGIC) || !read_pod(in, chunk_count)) {
+                throw std::runtime_error("Corrupt stats stream index: " + path);
+            }
+            std::vector<uint64_t> offsets(chunk_count);
+            for (uint32_t i = 0; i < chunk_count; ++i) {
+                uint64_t first_frame = 0;
+                uint32_t count = 0;
+                read_pod(in, offsets[i]);
+                read_pod(in, first_frame);
+                read_pod(in, count);
+            }
+            if (!in) throw std::runtime_error("Corrupt stats stream index: " + path);
+            for (uint64_t off : offsets) {
+                in.seekg(static_cast<std::streamoff>(off));
+                if (!read_magic(in, CHUNK_MAGIC)) {
+                    throw std::runtime_error("Corrupt stats stream chunk: " + path);
+                }
+                read_chunk(in, records);
+            }
+            return records;
+        }
+    }
+
+    // No trailer (writer did not close): scan complete chunks sequentially
+    in.clear();
+    in.seekg(data_start);
+    for (;;) {
+        if (!read_magic(in, CHUNK_MAGIC)) break;
+        const std::size_t before = records.size();
+        try {
+            read_chunk(in, records);
+        } catch (const std::runtime_error&) {
+            // Partially written tail chunk: keep what was complete
+            records.resize(before);
+            break;
+        }
+    }
+    return records;
+}
+
+std::string format_sim_time(double time) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.15g", time);
+    if (std::strtod(buf, nullptr) != time) std::snprintf(buf, sizeof(buf), "%.17g", time);
+    return buf;
+}
+
+void write_stats_csv(const std::vector<StatsRecord>& records, std::ostream& out) {
+    const char* const* names = stats_column_names();
+    out << "frame,time";
+    for (int c = 0; c < STATS_COLUMN_COUNT; ++c) out << ',' << names[c];
+    out << '\n';
+    for (const auto& r : records) {
+        out << r.frame << ',' << format_sim_time(r.time);
+        for (int c = 0; c < STATS_COLUMN_COUNT; ++c) out << ',' << r.values[c];
+        out << '\n';
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "spsc_queue.h"
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct SimStats;
+
+// ============================================================
+// Streaming binary time series of SimStats
+// ============================================================
+//
+// File layout (little-endian, as written by the host):
+//   header   "BSTS" | u32 version | u32 int column count
+//   chunk*   "CHNK" | u32 n | u64 frame[n] | f64 time[n] | i32 column_c[n] for each column c
+//   index    "BSTI" | u32 chunk count | (u64 offset, u64 first_frame, u32 n) per chunk
+//   trailer  u64 index offset | "BSTE"
+// Chunks are columnar so a reader can pull one series without touching the
+// rest. The index is only written on close(); a reader falls back to scanning
+// chunks when it is missing (crashed run).
+
+constexpr uint32_t STATS_STREAM_VERSION = 1;
+constexpr int STATS_COLUMN_COUNT = 12;
+
+struct StatsRecord {
+    uint64_t frame = 0;
+    double time = 0.0;
+    int32_t values[STATS_COLUMN_COUNT] = {};
+};
+
+// Names of the int columns, in StatsRecord::values order
+const char* const* stats_column_names();
+
+StatsRecord make_stats_record(uint64_t frame, double time, const SimStats& stats);
+
+// Background writer. push() is called from the simulation thread and never
+// blocks: records go through a lock-free SPSC queue to a writer thread that
+// packs them into chunks. Throws std::runtime_error if the file cannot be opened.
+class StatsStreamWriter {
+public:
+    explicit StatsStreamWriter(const std::string& path,
+                               std::size_t chunk_records = 4096,
+                               std::size_t queue_capacity = 1 << 14);
+    ~StatsStreamWriter();
+
+    StatsStreamWriter(const StatsStreamWriter&) = delete;
+    StatsStreamWriter& operator=(const StatsStreamWriter&) = delete;
+
+    // Returns false (record dropped and counted) if the writer fell behind
+    bool push(const StatsRecord& record);
+
+    // Drains the queue, writes the last chunk and the index, joins the thread.
+    // Idempotent; also called by the destructor.
+    void close();
+
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    struct ChunkIndex {
+        uint64_t offset;
+        uint64_t first_frame;
+        uint32_t count;
+    };
+
+    void run();
+    void flush_chunk();
+
+    std::ofstream out_;
+    std::size_t chunk_records_;
+    SpscQueue<StatsRecord> queue_;
+    std::vector<StatsRecord> pending_;
+    std::vector<ChunkIndex> index_;
+    std::atomic<bool> stop_{false};
+    std::atomic<uint64_t> dropped_{0};
+    std::thread thread_;
+    bool closed_ = false;
+};
+
+// Reads every record of a stats stream (index if present, else chunk scan).
+// Throws std::runtime_error on a malformed file.
+std::vector<StatsRecord> read_stats_stream(const std::string& path);
+
+// Formats a sim time for CSV: the shortest of 15 or 17 significant digits
+// that reads back as the same double, so long runs keep sub-frame precision
+std::string format_sim_time(double time);
+
+// Writes records as CSV with a header row
+void write_stats_csv(const std::vector<StatsRecord>& records, std::ostream& out);
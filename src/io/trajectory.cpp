@@ -0,0 +1,640 @@
+#include "trajectory.h"
+#include "range_coder.h"
+#include "varint.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+constexpr char FILE_MAGIC[4]    = {'B', 'T', 'R', 'J'};
+constexpr char INDEX_MAGIC[4]   = {'T', 'R', 'J', 'I'};
+constexpr char TRAILER_MAGIC[4] = {'T', 'R', 'J', 'E'};
+constexpr uint8_t BLOCK_KEY   = 'K';
+constexpr uint8_t BLOCK_DELTA = 'D';
+constexpr std::size_t BLOCK_HEADER = 1 + sizeof(uint32_t);
+constexpr std::size_t FILE_HEADER = 4 + sizeof(uint32_t) + 2 * sizeof(float);
+constexpr float TWO_PI = 6.28318530718f;
+
+constexpr uint32_t GRID_BITS = 28;   // 16-bit cells in 1/4096ths
+constexpr uint32_t GRID_MASK = (1u << GRID_BITS) - 1;
+constexpr double GRID_SIZE = 1 << GRID_BITS;
+constexpr uint32_t CELL_SHIFT = GRID_BITS - 16;
+constexpr uint32_t CELL = 1u << CELL_SHIFT;
+
+uint8_t pack_flags(uint8_t swarm_type, bool infected) {
+    return static_cast<uint8_t>((swarm_type & 0x3) | (infected ? 0x4 : 0));
+}
+
+// Signed difference of two grid coordinates, the short way around
+int32_t wrapped_delta(uint32_t to, uint32_t from) {
+    const uint32_t d = (to - from) & GRID_MASK;
+    return d >= (1u << (GRID_BITS - 1)) ? static_cast<int32_t>(d) - (1 << GRID_BITS)
+                                        : static_cast<int32_t>(d);
+}
+
+int32_t round_div(int32_t value, int32_t quantum) {
+    return value >= 0 ? (value + quantum / 2) / quantum : -((-value + quantum / 2) / quantum);
+}
+
+uint8_t quantize_angle(double angle) {
+    return static_cast<uint8_t>(static_cast<int64_t>(std::lround(angle / TWO_PI * 256.0)));
+}
+
+// Velocities are kept in x grid units on both axes so that directions and
+// rotations are those of world space; y positions scale by the aspect.
+// Q16 factors, computed the same way on both sides
+struct GridAspect {
+    int64_t y_per_x, x_per_y;
+};
+
+GridAspect grid_aspect(float world_width, float world_height) {
+    if (world_width <= 0.0f || world_height <= 0.0f) return {1 << 16, 1 << 16};
+    return {std::llround(static_cast<double>(world_width) / world_height * 65536.0),
+            std::llround(static_cast<double>(world_height) / world_width * 65536.0)};
+}
+
+// Heading the boid is predicted to fly at: along its velocity plus the kept
+// offset
+uint8_t predicted_heading(const TrajectoryBoidState& s) {
+    const uint8_t along = (s.vx == 0 && s.vy == 0)
+        ? 0 : quantize_angle(std::atan2(static_cast<double>(s.vy), static_cast<double>(s.vx)));
+    return static_cast<uint8_t>(along + s.heading_offset);
+}
+
+// Keyframe entries hold whole cells; the state starts at the cell center,
+// at rest, and is corrected on the next delta
+TrajectoryBoidState entry_state(uint64_t id, uint16_t cell_x, uint16_t cell_y,
+                                uint8_t heading, uint8_t flags) {
+    TrajectoryBoidState s{};
+    s.id = id;
+    s.x = s.anchor_x = (static_cast<uint32_t>(cell_x) << CELL_SHIFT) | (CELL / 2);
+    s.y = s.anchor_y = (static_cast<uint32_t>(cell_y) << CELL_SHIFT) | (CELL / 2);
+    s.heading_offset = heading;
+    s.flags = flags;
+    s.corrected = 1;
+    return s;
+}
+
+void put_entry(std::vector<uint8_t>& out, uint64_t id_gap, uint32_t x, uint32_t y,
+               uint8_t heading, uint8_t flags) {
+    put_varint(out, id_gap);
+    put_u16(out, static_cast<uint16_t>(x >> CELL_SHIFT));
+    put_u16(out, static_cast<uint16_t>(y >> CELL_SHIFT));
+    out.push_back(heading);
+    out.push_back(flags);
+}
+
+TrajectoryBoidState read_entry(ByteReader& in, uint64_t& id) {
+    id += in.varint();
+    const uint16_t x = in.u16();
+    const uint16_t y = in.u16();
+    const uint8_t heading = in.u8();
+    const uint8_t flags = in.u8();
+    return entry_state(id, x, y, heading, flags);
+}
+
+// Turn rates and angles are Q20 radians; rotations use the small-angle
+// series, accurate to ~1e-4 within the clamps below
+constexpr int ANGLE_BITS = 20;
+constexpr int64_t MAX_TURN = 1 << (ANGLE_BITS - 2);   // 0.25 rad per frame
+constexpr int64_t MAX_ROTATION = 1 << (ANGLE_BITS - 1);  // 0.5 rad
+// Over shorter spans a turn cannot be told apart from residual rounding
+constexpr uint32_t MIN_TURN_HISTORY = 4;
+
+void rotate(int32_t& vx, int32_t& vy, int64_t angle) {
+    const int64_t a2 = (angle * angle) >> ANGLE_BITS;
+    const int64_t c = (int64_t{1} << ANGLE_BITS) - a2 / 2 + ((a2 * a2) >> ANGLE_BITS) / 24;
+    const int64_t sn = angle - ((a2 * angle) >> ANGLE_BITS) / 6;
+    const int64_t x = (vx * c - vy * sn) >> ANGLE_BITS;
+    const int64_t y = (vx * sn + vy * c) >> ANGLE_BITS;
+    vx = static_cast<int32_t>(x);
+    vy = static_cast<int32_t>(y);
+}
+
+// Signed angle from one step to the next, 0 if either is zero or they are
+// more than a right angle apart
+int64_t turn_angle(int64_t ax, int64_t ay, int64_t bx, int64_t by) {
+    // Scale both down (keeping direction) so the products below fit
+    while (std::max({std::abs(ax), std::abs(ay), std::abs(bx), std::abs(by)}) >= (int64_t{1} << 20)) {
+        ax /= 2; ay /= 2; bx /= 2; by /= 2;
+    }
+    const int64_t dot = ax * bx + ay * by;
+    if (dot <= 0) return 0;
+    const int64_t t = (ax * by - ay * bx) * (int64_t{1} << ANGLE_BITS) / dot;  // tan
+    if (t > MAX_ROTATION || t < -MAX_ROTATION) return t > 0 ? MAX_ROTATION : -MAX_ROTATION;
+    const int64_t t2 = (t * t) >> ANGLE_BITS;
+    return t - ((t2 * t) >> ANGLE_BITS) / 3 + ((((t2 * t2) >> ANGLE_BITS) * t) >> ANGLE_BITS) / 5;
+}
+
+// One recorded frame of dead reckoning: step, then turn the velocity
+void advance(TrajectoryBoidState& s, const GridAspect& aspect) {
+    s.x = (s.x + static_cast<uint32_t>(s.vx)) & GRID_MASK;
+    s.y = (s.y + static_cast<uint32_t>((s.vy * aspect.y_per_x) >> 16)) & GRID_MASK;
+    if (s.turn != 0) rotate(s.vx, s.vy, s.turn);
+    s.since_correction++;
+}
+
+// Moves an advanced survivor by a residual and refits its motion: the mean
+// step since the previous correction is the velocity halfway through that
+// interval, and its turn against the mean step before gives the turn rate
+void correct_position(TrajectoryBoidState& s, int32_t rx, int32_t ry,
+                      uint32_t quantum_x, uint32_t quantum_y, const GridAspect& aspect) {
+    s.x = (s.x + static_cast<uint32_t>(rx) * quantum_x) & GRID_MASK;
+    s.y = (s.y + static_cast<uint32_t>(ry) * quantum_y) & GRID_MASK;
+    const int64_t frames = std::max<uint32_t>(1, s.since_correction);
+    const int32_t mean_x = static_cast<int32_t>(wrapped_delta(s.x, s.anchor_x) / frames);
+    const int32_t mean_y = static_cast<int32_t>(((wrapped_delta(s.y, s.anchor_y) * aspect.x_per_y) >> 16) / frames);
+
+    int64_t turn = 0;
+    if (s.last_interval > 0 && frames + s.last_interval >= MIN_TURN_HISTORY) {
+        turn = 2 * turn_angle(s.mean_x, s.mean_y, mean_x, mean_y) / (frames + s.last_interval);
+        turn = std::max(-MAX_TURN, std::min(MAX_TURN, turn));
+    }
+    s.turn = static_cast<int32_t>(turn);
+    s.vx = mean_x;
+    s.vy = mean_y;
+    rotate(s.vx, s.vy, std::max(-MAX_ROTATION, std::min(MAX_ROTATION, turn * (frames + 1) / 2)));
+
+    s.mean_x = mean_x;
+    s.mean_y = mean_y;
+    s.anchor_x = s.x;
+    s.anchor_y = s.y;
+    s.last_interval = static_cast<uint32_t>(frames);
+    s.since_correction = 0;
+}
+
+bool by_id(const TrajectoryBoidState& a, const TrajectoryBoidState& b) {
+    return a.id < b.id;
+}
+
+// Adaptive contexts of the motion stream, fresh per block
+struct ValueModels {
+    BitModel zero, sign;
+    BitModel length[16];
+};
+
+struct MotionModels {
+    BitModel corrected[2];   // by whether the survivor was corrected last frame
+    ValueModels position;
+    ValueModels heading;
+};
+
+// Signed residuals as zero flag, sign, unary bit length, then the bits below
+// the leading one
+void put_residual(RangeEncoder& rc, ValueModels& m, int32_t value) {
+    rc.bit(m.zero, value != 0);
+    if (value == 0) return;
+    rc.bit(m.sign, value < 0);
+    const uint32_t magnitude = static_cast<uint32_t>(value < 0 ? -value : value);
+    int length = 1;
+    while ((magnitude >> length) != 0) ++length;
+    for (int i = 0; i + 1 < length; ++i) rc.bit(m.length[std::min(i, 15)], 1);
+    rc.bit(m.length[std::min(length - 1, 15)], 0);
+    rc.direct_bits(magnitude & ((1u << (length - 1)) - 1), length - 1);
+}
+
+int32_t get_residual(RangeDecoder& rc, ValueModels& m) {
+    if (!rc.bit(m.zero)) return 0;
+    const bool negative = rc.bit(m.sign) != 0;
+    int length = 1;
+    while (rc.bit(m.length[std::min(length - 1, 15)])) {
+        if (++length > static_cast<int>(GRID_BITS) + 1) {
+            throw std::runtime_error("Malformed trajectory block");
+        }
+    }
+    const int32_t magnitude = static_cast<int32_t>((1u << (length - 1)) | rc.direct_bits(length - 1));
+    return negative ? -magnitude : magnitude;
+}
+
+} // namespace
+
+// ============================================================
+// Encoder
+// ============================================================
+
+TrajectoryEncoder::TrajectoryEncoder(float world_width, float world_height,
+                                     uint32_t keyframe_interval, float tolerance,
+                                     float heading_tolerance)
+    : world_width_(world_width), world_height_(world_height),
+      keyframe_interval_(std::max<uint32_t>(1, keyframe_interval)) {
+    // Below half a cell there is nothing to gain. Residuals come in half
+    // the tolerance: coarser ones leave corrected positions too rough to
+    // refit velocities from, finer ones cost bits for nothing
+    const auto grid_tolerance = [&](float extent) {
+        return static_cast<uint32_t>(std::max(0.0, tolerance / extent * GRID_SIZE));
+    };
+    threshold_x_ = std::max<uint32_t>(CELL / 2, grid_tolerance(world_width));
+    threshold_y_ = std::max<uint32_t>(CELL / 2, grid_tolerance(world_height));
+    quantum_x_ = std::max<uint32_t>(CELL, threshold_x_ / 2);
+    quantum_y_ = std::max<uint32_t>(CELL, threshold_y_ / 2);
+    threshold_heading_ = static_cast<uint32_t>(std::max(0.0, heading_tolerance / TWO_PI * 256.0));
+    quantum_heading_ = std::max<uint32_t>(1, threshold_heading_);
+}
+
+void TrajectoryEncoder::quantize(const TrajectorySample& s, Target& t) const {
+    t.id = s.id;
+    t.x = static_cast<uint32_t>(static_cast<int64_t>(std::lround(s.x / world_width_ * GRID_SIZE))) & GRID_MASK;
+    t.y = static_cast<uint32_t>(static_cast<int64_t>(std::lround(s.y / world_height_ * GRID_SIZE))) & GRID_MASK;
+    t.heading = quantize_angle(s.angle);
+    t.flags = pack_flags(s.swarm_type, s.infected);
+}
+
+bool TrajectoryEncoder::encode(const TrajectoryFrame& frame, std::vector<uint8_t>& out) {
+    targets_.resize(frame.boids.size());
+    for (std::size_t i = 0; i < frame.boids.size(); ++i) quantize(frame.boids[i], targets_[i]);
+    std::sort(targets_.begin(), targets_.end(),
+              [](const Target& a, const Target& b) { return a.id < b.id; });
+
+    const bool keyframe = !has_state_ || frame.keyframe || since_keyframe_ >= keyframe_interval_;
+
+    const std::size_t block_start = out.size();
+    out.push_back(keyframe ? BLOCK_KEY : BLOCK_DELTA);
+    out.resize(out.size() + sizeof(uint32_t));  // payload size, patched below
+    const std::size_t payload_start = out.size();
+    put_varint(out, frame.frame);
+    put_raw(out, frame.time);
+
+    scratch_.clear();
+    if (keyframe) {
+        put_varint(out, targets_.size());
+        uint64_t prev_id = 0;
+        for (const Target& t : targets_) {
+            put_entry(out, t.id - prev_id, t.x, t.y, t.heading, t.flags);
+            prev_id = t.id;
+            scratch_.push_back(entry_state(t.id, static_cast<uint16_t>(t.x >> CELL_SHIFT),
+                                           static_cast<uint16_t>(t.y >> CELL_SHIFT), t.heading, t.flags));
+        }
+        since_keyframe_ = 1;
+    } else {
+        put_varint(out, quantum_x_);
+        put_varint(out, quantum_y_);
+        put_varint(out, quantum_heading_);
+
+        // Match previous and current boids by id (both sorted)
+        std::vector<std::size_t> removed, added;
+        std::vector<std::pair<std::size_t, std::size_t>> kept;  // (prev index, cur index)
+        std::size_t i = 0, j = 0;
+        while (i < state_.size() || j < targets_.size()) {
+            if (j == targets_.size() || (i < state_.size() && state_[i].id < targets_[j].id)) {
+                removed.push_back(i++);
+            } else if (i == state_.size() || targets_[j].id < state_[i].id) {
+                added.push_back(j++);
+            } else {
+                kept.emplace_back(i++, j++);
+            }
+        }
+
+        put_varint(out, removed.size());
+        std::size_t prev_index = 0;
+        for (std::size_t r : removed) {
+            put_varint(out, r - prev_index);
+            prev_index = r;
+        }
+
+        put_varint(out, added.size());
+        uint64_t prev_id = 0;
+        std::vector<TrajectoryBoidState> added_states;
+        added_states.reserve(added.size());
+        for (std::size_t a : added) {
+            const Target& t = targets_[a];
+            put_entry(out, t.id - prev_id, t.x, t.y, t.heading, t.flags);
+            prev_id = t.id;
+            added_states.push_back(entry_state(t.id, static_cast<uint16_t>(t.x >> CELL_SHIFT),
+                                               static_cast<uint16_t>(t.y >> CELL_SHIFT), t.heading, t.flags));
+        }
+
+        // Survivors: correct only those whose prediction left the tolerance
+        std::vector<std::pair<std::size_t, uint8_t>> flag_changes;
+        std::vector<TrajectoryBoidState> kept_states;
+        kept_states.reserve(kept.size());
+        motion_.clear();
+        RangeEncoder rc(motion_);
+        MotionModels models;
+        const GridAspect aspect = grid_aspect(world_width_, world_height_);
+        for (std::size_t k = 0; k < kept.size(); ++k) {
+            TrajectoryBoidState s = state_[kept[k].first];
+            const Target& t = targets_[kept[k].second];
+
+            advance(s, aspect);
+            const int32_t ex = wrapped_delta(t.x, s.x);
+            const int32_t ey = wrapped_delta(t.y, s.y);
+            int32_t eh = static_cast<int8_t>(static_cast<uint8_t>(
+                t.heading - predicted_heading(s)));
+            const bool correct = static_cast<uint32_t>(std::abs(ex)) > threshold_x_ ||
+                                 static_cast<uint32_t>(std::abs(ey)) > threshold_y_ ||
+                                 static_cast<uint32_t>(std::abs(eh)) > threshold_heading_;
+            rc.bit(models.corrected[s.corrected], correct);
+            s.corrected = correct;
+            if (correct) {
+                const int32_t rx = round_div(ex, static_cast<int32_t>(quantum_x_));
+                const int32_t ry = round_div(ey, static_cast<int32_t>(quantum_y_));
+                correct_position(s, rx, ry, quantum_x_, quantum_y_, aspect);
+                // The heading residual is taken against the new velocity
+                eh = static_cast<int8_t>(static_cast<uint8_t>(
+                    t.heading - predicted_heading(s)));
+                const int32_t rh = round_div(eh, static_cast<int32_t>(quantum_heading_));
+                s.heading_offset = static_cast<uint8_t>(s.heading_offset + rh * static_cast<int32_t>(quantum_heading_));
+                put_residual(rc, models.position, rx);
+                put_residual(rc, models.position, ry);
+                put_residual(rc, models.heading, rh);
+            }
+
+            if (t.flags != s.flags) {
+                flag_changes.emplace_back(k, t.flags);
+                s.flags = t.flags;
+            }
+            kept_states.push_back(s);
+        }
+        rc.finish();
+
+        put_varint(out, flag_changes.size());
+        std::size_t prev_k = 0;
+        for (const auto& fc : flag_changes) {
+            put_varint(out, fc.first - prev_k);
+            out.push_back(fc.second);
+            prev_k = fc.first;
+        }
+        out.insert(out.end(), motion_.begin(), motion_.end());
+
+        scratch_.resize(kept_states.size() + added_states.size());
+        std::merge(kept_states.begin(), kept_states.end(), added_states.begin(), added_states.end(),
+                   scratch_.begin(), by_id);
+        since_keyframe_++;
+    }
+    state_.swap(scratch_);
+
+    has_state_ = true;
+    const uint32_t payload = static_cast<uint32_t>(out.size() - payload_start);
+    std::memcpy(out.data() + block_start + 1, &payload, sizeof(payload));
+    return keyframe;
+}
+
+// ============================================================
+// Decoder
+// ============================================================
+
+TrajectoryDecoder::TrajectoryDecoder(float world_width, float world_height)
+    : world_width_(world_width), world_height_(world_height) {}
+
+std::size_t TrajectoryDecoder::decode(const uint8_t* data, std::size_t size, TrajectoryFrame& out) {
+    ByteReader header(data, size);
+    const uint8_t type = header.u8();
+    const uint32_t payload = header.raw<uint32_t>();
+    if (type != BLOCK_KEY && type != BLOCK_DELTA) {
+        throw std::runtime_error("Malformed trajectory block");
+    }
+    if (header.remaining() < payload) throw std::runtime_error("Truncated trajectory block");
+    if (type == BLOCK_DELTA && !has_state_) {
+        throw std::runtime_error("Trajectory delta block without a preceding keyframe");
+    }
+
+    ByteReader in(data + BLOCK_HEADER, payload);
+    out.frame = in.varint();
+    out.time = in.raw<double>();
+    out.keyframe = (type == BLOCK_KEY);
+
+    next_.clear();
+    if (type == BLOCK_KEY) {
+        const uint64_t n = in.varint();
+        uint64_t id = 0;
+        for (uint64_t k = 0; k < n; ++k) next_.push_back(read_entry(in, id));
+    } else {
+        const uint64_t quantum_x = in.varint();
+        const uint64_t quantum_y = in.varint();
+        const uint64_t quantum_heading = in.varint();
+        if (quantum_x == 0 || quantum_x > GRID_MASK || quantum_y == 0 || quantum_y > GRID_MASK ||
+            quantum_heading == 0 || quantum_heading > 255) {
+            throw std::runtime_error("Malformed trajectory block");
+        }
+
+        std::vector<bool> removed(state_.size(), false);
+        const uint64_t n_removed = in.varint();
+        std::size_t index = 0;
+        for (uint64_t k = 0; k < n_removed; ++k) {
+            index += in.varint();
+            if (index >= state_.size()) throw std::runtime_error("Malformed trajectory block");
+            removed[index] = true;
+        }
+
+        std::vector<TrajectoryBoidState> added;
+        const uint64_t n_added = in.varint();
+        uint64_t id = 0;
+        for (uint64_t k = 0; k < n_added; ++k) added.push_back(read_entry(in, id));
+
+        std::vector<TrajectoryBoidState> kept;
+        kept.reserve(state_.size());
+        for (std::size_t i = 0; i < state_.size(); ++i) {
+            if (!removed[i]) kept.push_back(state_[i]);
+        }
+
+        std::vector<std::pair<std::size_t, uint8_t>> flag_changes;
+        const uint64_t n_flags = in.varint();
+        std::size_t k = 0;
+        for (uint64_t f = 0; f < n_flags; ++f) {
+            k += in.varint();
+            if (k >= kept.size()) throw std::runtime_error("Malformed trajectory block");
+            flag_changes.emplace_back(k, in.u8());
+        }
+
+        // The rest of the payload is the motion stream
+        RangeDecoder rc(data + BLOCK_HEADER + in.pos(), in.remaining());
+        MotionModels models;
+        const GridAspect aspect = grid_aspect(world_width_, world_height_);
+        for (TrajectoryBoidState& s : kept) {
+            advance(s, aspect);
+            const bool correct = rc.bit(models.corrected[s.corrected]) != 0;
+            s.corrected = correct;
+            if (correct) {
+                const int32_t rx = get_residual(rc, models.position);
+                const int32_t ry = get_residual(rc, models.position);
+                const int32_t rh = get_residual(rc, models.heading);
+                correct_position(s, rx, ry, static_cast<uint32_t>(quantum_x),
+                                 static_cast<uint32_t>(quantum_y), aspect);
+                s.heading_offset = static_cast<uint8_t>(s.heading_offset + rh * static_cast<int32_t>(quantum_heading));
+            }
+        }
+        for (const auto& fc : flag_changes) kept[fc.first].flags = fc.second;
+
+        next_.resize(kept.size() + added.size());
+        std::merge(kept.begin(), kept.end(), added.begin(), added.end(), next_.begin(), by_id);
+    }
+    state_.swap(next_);
+    has_state_ = true;
+
+    out.boids.resize(state_.size());
+    for (std::size_t i = 0; i < state_.size(); ++i) {
+        const TrajectoryBoidState& q = state_[i];
+        TrajectorySample& s = out.boids[i];
+        s.id = q.id;
+        s.x = static_cast<float>(q.x / GRID_SIZE * world_width_);
+        s.y = static_cast<float>(q.y / GRID_SIZE * world_height_);
+        s.angle = static_cast<int8_t>(predicted_heading(q)) * (TWO_PI / 256.0f);
+        s.swarm_type = q.flags & 0x3;
+        s.infected = (q.flags & 0x4) != 0;
+    }
+    return BLOCK_HEADER + payload;
+}
+
+// ============================================================
+// Writer
+// ============================================================
+
+TrajectoryWriter::TrajectoryWriter(const std::string& path, float world_width, float world_height,
+                                   uint32_t keyframe_interval, float tolerance,
+                                   float heading_tolerance, std::size_t queue_capacity)
+    : out_(path, std::ios::binary | std::ios::trunc),
+      encoder_(world_width, world_height, keyframe_interval, tolerance, heading_tolerance),
+      queue_(queue_capacity) {
+    if (!out_) {
+        throw std::runtime_error("Cannot open trajectory file: " + path);
+    }
+    std::vector<uint8_t> header;
+    header.insert(header.end(), FILE_MAGIC, FILE_MAGIC + 4);
+    put_raw(header, TRAJECTORY_VERSION);
+    put_raw(header, world_width);
+    put_raw(header, world_height);
+    out_.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+    offset_ = header.size();
+    thread_ = std::thread(&TrajectoryWriter::run, this);
+}
+
+TrajectoryWriter::~TrajectoryWriter() {
+    close();
+}
+
+bool TrajectoryWriter::push(TrajectoryFrame&& frame) {
+    if (force_keyframe_) frame.keyframe = true;
+    if (queue_.try_push(std::move(frame))) {
+        force_keyframe_ = false;
+        return true;
+    }
+    force_keyframe_ = true;
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void TrajectoryWriter::write_frame(const TrajectoryFrame& frame) {
+    buffer_.clear();
+    if (encoder_.encode(frame, buffer_)) {
+        index_.push_back({frame.frame, offset_});
+    }
+    out_.write(reinterpret_cast<const char*>(buffer_.data()), static_cast<std::streamsize>(buffer_.size()));
+    offset_ += buffer_.size();
+    last_frame_ = frame.frame;
+}
+
+void TrajectoryWriter::run() {
+    TrajectoryFrame frame;
+    for (;;) {
+        if (queue_.try_pop(frame)) {
+            write_frame(frame);
+            continue;
+        }
+        // Check stop only after an empty pop so close() drains everything
+        if (stop_.load(std::memory_order_acquire)) {
+            while (queue_.try_pop(frame)) write_frame(frame);
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+}
+
+void TrajectoryWriter::close() {
+    if (closed_) return;
+    closed_ = true;
+    stop_.store(true, std::memory_order_release);
+    if (thread_.joinable()) thread_.join();
+
+    std::vector<uint8_t> tail;
+    tail.insert(tail.end(), INDEX_MAGIC, INDEX_MAGIC + 4);
+    put_raw(tail, static_cast<uint32_t>(index_.size()));
+    put_raw(tail, last_frame_);
+    for (const auto& k : index_) {
+        put_raw(tail, k.frame);
+        put_raw(tail, k.offset);
+    }
+    put_raw(tail, offset_);
+    tail.insert(tail.end(), TRAILER_MAGIC, TRAILER_MAGIC + 4);
+    out_.write(reinterpret_cast<const char*>(tail.data()), static_cast<std::streamsize>(tail.size()));
+    out_.close();
+}
+
+// ============================================================
+// Reader
+// ============================================================
+
+TrajectoryReader::TrajectoryReader(const std::string& path)
+    : file_(path), data_(file_.data()), size_(file_.size()), decoder_(0.0f, 0.0f) {
+    if (size_ < FILE_HEADER || std::memcmp(data_, FILE_MAGIC, 4) != 0) {
+        throw std::runtime_error("Not a trajectory file: " + path);
+    }
+    ByteReader header(data_ + 4, FILE_HEADER - 4);
+    if (header.raw<uint32_t>() != TRAJECTORY_VERSION) {
+        throw std::runtime_error("Unsupported trajectory version: " + path);
+    }
+    world_width_ = header.raw<float>();
+    world_height_ = header.raw<float>();
+    decoder_ = TrajectoryDecoder(world_width_, world_height_);
+    data_start_ = FILE_HEADER;
+    cursor_ = data_start_;
+
+    // Fast path: trailer -> index
+    const std::size_t trailer = sizeof(uint64_t) + 4;
+    if (size_ >= data_start_ + trailer &&
+        std::memcmp(data_ + size_ - 4, TRAILER_MAGIC, 4) == 0) {
+        ByteReader t(data_ + size_ - trailer, trailer);
+        const uint64_t index_offset = t.raw<uint64_t>();
+        if (index_offset < data_start_ || index_offset + 4 > size_ ||
+            std::memcmp(data_ + index_offset, INDEX_MAGIC, 4) != 0) {
+            throw std::runtime_error("Corrupt trajectory index: " + path);
+        }
+        ByteReader idx(data_ + index_offset + 4, size_ - index_offset - 4);
+        const uint32_t n = idx.raw<uint32_t>();
+        last_frame_ = idx.raw<uint64_t>();
+        for (uint32_t k = 0; k < n; ++k) {
+            TrajectoryKeyframe kf;
+            kf.frame = idx.raw<uint64_t>();
+            kf.offset = idx.raw<uint64_t>();
+            keyframes_.push_back(kf);
+        }
+        data_end_ = static_cast<std::size_t>(index_offset);
+        return;
+    }
+
+    // No index (writer did not close): walk block headers, stop at a torn block
+    std::size_t pos = data_start_;
+    while (size_ - pos >= BLOCK_HEADER) {
+        const uint8_t type = data_[pos];
+        uint32_t payload;
+        std::memcpy(&payload, data_ + pos + 1, sizeof(payload));
+        if ((type != BLOCK_KEY && type != BLOCK_DELTA) || size_ - pos - BLOCK_HEADER < payload) break;
+        ByteReader p(data_ + pos + BLOCK_HEADER, payload);
+        const uint64_t frame = p.varint();
+        if (type == BLOCK_KEY) keyframes_.push_back({frame, pos});
+        last_frame_ = frame;
+        pos += BLOCK_HEADER + payload;
+    }
+    data_end_ = pos;
+}
+
+bool TrajectoryReader::next(TrajectoryFrame& out) {
+    if (cursor_ >= data_end_) return false;
+    cursor_ += decoder_.decode(data_ + cursor_, data_end_ - cursor_, out);
+    return true;
+}
+
+bool TrajectoryReader::seek(uint64_t target, TrajectoryFrame& out) {
+    if (keyframes_.empty()) return false;
+    auto it = std::upper_bound(keyframes_.begin(), keyframes_.end(), target,
+                               [](uint64_t f, const TrajectoryKeyframe& k) { return f < k.frame; });
+    if (it != keyframes_.begin()) --it;
+    cursor_ = static_cast<std::size_t>(it->offset);
+    while (next(out)) {
+        if (out.frame >= target) return true;
+    }
+    return false;
+}
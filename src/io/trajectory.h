@@ -0,0 +1,201 @@
+#pragma once
+
+#include "mapped_file.h"
+#include "spsc_queue.h"
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ============================================================
+// Per-boid trajectory recording
+// ============================================================
+//
+// Positions live on a 28-bit fixed-point grid across the (toroidal) world
+// (16-bit cells in 1/4096ths), so a wrap at the edge is just overflow.
+// Headings are quantized to 8 bits. Each frame is one block:
+//   u8 type ('K' keyframe | 'D' delta) | u32 payload size | payload
+//   payload = varint frame | f64 time | body
+// Keyframe body: varint n, then per boid (ascending id)
+//   varint id gap | u16 x cell | u16 y cell | u8 heading | u8 flags
+// Delta body, against the previous recorded frame:
+//   quanta:  varint x, varint y (grid units), varint heading
+//   removed: varint n, varint index gaps into the previous boid list
+//   added:   varint n, keyframe-style entries (ascending id)
+//   flags:   varint n, (varint survivor index gap, u8 flags) per change
+//   moved:   range-coded (range_coder.h) to the end of the payload. Every
+//            survivor dead-reckons: it steps by its velocity, the velocity
+//            turns at the survivor's turn rate, and the heading is the
+//            velocity's direction plus a kept offset. One adaptive bit per
+//            survivor says whether it is corrected this frame; a
+//            correction carries x, y and heading residuals in units of the
+//            quanta (adaptive Exp-Golomb), and the velocity and turn rate
+//            are refit from the positions of the last three corrections.
+// The encoder corrects a boid only once its prediction drifts past the
+// tolerance, so a boid flying straight or on a steady curve costs a
+// fraction of a bit per frame. Tolerance 0 keeps positions within one
+// 16-bit cell and headings exact. The state is integer arithmetic on both
+// sides; only the reported heading goes through atan2.
+// File: "BTRJ" | u32 version | f32 world w | f32 world h | blocks...
+//       | "TRJI" | u32 n | u64 last frame | (u64 frame, u64 offset) per keyframe
+//       | u64 index offset | "TRJE"
+// Keyframes every keyframe_interval recorded frames make seeking cheap; the
+// index is written on close and rebuilt by scanning block headers otherwise.
+
+constexpr uint32_t TRAJECTORY_VERSION = 3;
+
+struct TrajectorySample {
+    uint64_t id = 0;          // stable per boid (BoidId)
+    float x = 0.0f, y = 0.0f;
+    float angle = 0.0f;       // radians
+    uint8_t swarm_type = 0;   // 0=normal, 1=doctor, 2=antivax
+    bool infected = false;
+};
+
+struct TrajectoryFrame {
+    uint64_t frame = 0;
+    double time = 0.0;
+    bool keyframe = false;    // writer side: force a keyframe; reader side: was a keyframe
+    std::vector<TrajectorySample> boids;  // decoded frames are sorted by id
+};
+
+struct TrajectoryKeyframe {
+    uint64_t frame;
+    uint64_t offset;          // byte offset of the block in the file
+};
+
+// Shared dead-reckoning state of the previous frame (encoder and decoder
+// keep identical copies so deltas reproduce exactly)
+struct TrajectoryBoidState {
+    uint64_t id;
+    uint32_t x, y;                // 1/4096ths of a cell, 28 bits
+    int32_t vx, vy;               // next predicted step, x units on both axes
+    int32_t turn;                 // predicted turn of the step per frame, Q20 radians
+    uint32_t anchor_x, anchor_y;  // position at the last correction
+    int32_t mean_x, mean_y;       // mean step between the last two corrections, as vx, vy
+    uint32_t since_correction;    // recorded frames since the last correction
+    uint32_t last_interval;       // frames between the last two corrections (0 = none)
+    uint8_t heading_offset;       // heading minus the direction of (vx, vy)
+    uint8_t flags;
+    uint8_t corrected;            // corrected on the previous frame (coding context)
+};
+
+class TrajectoryEncoder {
+public:
+    // tolerance (world units) and heading_tolerance (radians) bound how far a
+    // decoded boid may drift from the recorded one; 0 records at full
+    // quantized precision
+    TrajectoryEncoder(float world_width, float world_height, uint32_t keyframe_interval,
+                      float tolerance = 0.0f, float heading_tolerance = 0.0f);
+
+    // Appends one block to out. Returns true if it was written as a keyframe.
+    bool encode(const TrajectoryFrame& frame, std::vector<uint8_t>& out);
+
+private:
+    struct Target {
+        uint64_t id;
+        uint32_t x, y;            // 1/4096ths of a cell
+        uint8_t heading;
+        uint8_t flags;
+    };
+
+    void quantize(const TrajectorySample& s, Target& t) const;
+
+    float world_width_, world_height_;
+    uint32_t keyframe_interval_;
+    uint32_t since_keyframe_ = 0;
+    bool has_state_ = false;
+    uint32_t threshold_x_, threshold_y_, threshold_heading_;  // largest error left uncorrected
+    uint32_t quantum_x_, quantum_y_, quantum_heading_;        // residual units
+
+    std::vector<TrajectoryBoidState> state_;
+    std::vector<TrajectoryBoidState> scratch_;
+    std::vector<Target> targets_;
+    std::vector<uint8_t> motion_;
+};
+
+class TrajectoryDecoder {
+public:
+    TrajectoryDecoder(float world_width, float world_height);
+
+    // Decodes the block at data. Delta blocks require the previous block to
+    // have been decoded by this decoder. Returns bytes consumed; throws
+    // std::runtime_error on malformed input.
+    std::size_t decode(const uint8_t* data, std::size_t size, TrajectoryFrame& out);
+
+private:
+    float world_width_, world_height_;
+    bool has_state_ = false;
+    std::vector<TrajectoryBoidState> state_;
+    std::vector<TrajectoryBoidState> next_;
+};
+
+// Background writer. push() never blocks: a full queue drops the frame and
+// forces the next accepted one to be a keyframe, so the delta chain never
+// spans a gap. Throws std::runtime_error if the file cannot be opened.
+class TrajectoryWriter {
+public:
+    TrajectoryWriter(const std::string& path, float world_width, float world_height,
+                     uint32_t keyframe_interval = 300, float tolerance = 0.0f,
+                     float heading_tolerance = 0.0f, std::size_t queue_capacity = 4);
+    ~TrajectoryWriter();
+
+    TrajectoryWriter(const TrajectoryWriter&) = delete;
+    TrajectoryWriter& operator=(const TrajectoryWriter&) = delete;
+
+    bool push(TrajectoryFrame&& frame);
+    void close();
+
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    void run();
+    void write_frame(const TrajectoryFrame& frame);
+
+    std::ofstream out_;
+    TrajectoryEncoder encoder_;
+    SpscQueue<TrajectoryFrame> queue_;
+    std::vector<uint8_t> buffer_;
+    std::vector<TrajectoryKeyframe> index_;
+    uint64_t offset_ = 0;
+    uint64_t last_frame_ = 0;
+    bool force_keyframe_ = false;   // producer-side only
+    std::atomic<bool> stop_{false};
+    std::atomic<uint64_t> dropped_{0};
+    std::thread thread_;
+    bool closed_ = false;
+};
+
+// Sequential/seekable reader over a memory-mapped trajectory file.
+// Throws std::runtime_error on open or format errors.
+class TrajectoryReader {
+public:
+    explicit TrajectoryReader(const std::string& path);
+
+    float world_width() const { return world_width_; }
+    float world_height() const { return world_height_; }
+    uint64_t first_frame() const { return keyframes_.empty() ? 0 : keyframes_.front().frame; }
+    uint64_t last_frame() const { return last_frame_; }
+    const std::vector<TrajectoryKeyframe>& keyframes() const { return keyframes_; }
+
+    // Decodes the next frame; false at end of data
+    bool next(TrajectoryFrame& out);
+
+    // Positions at the first frame >= target (via the nearest keyframe before
+    // it) and decodes it into out. False if no such frame exists.
+    bool seek(uint64_t target, TrajectoryFrame& out);
+
+private:
+    MappedFile file_;
+    const uint8_t* data_ = nullptr;
+    std::size_t size_ = 0;
+    std::size_t data_start_ = 0;
+    std::size_t data_end_ = 0;      // start of the index (or end of complete blocks)
+    std::size_t cursor_ = 0;
+    float world_width_ = 0.0f, world_height_ = 0.0f;
+    uint64_t last_frame_ = 0;
+    std::vector<TrajectoryKeyframe> keyframes_;
+    TrajectoryDecoder decoder_;
+};
@@ -0,0 +1,90 @@
+#include "trajectory_player.h"
+#include <stdexcept>
+#include <utility>
+
+TrajectoryPlayer::TrajectoryPlayer(const std::string& path, std::size_t buffer_frames)
+    : reader_(path),
+      world_width_(reader_.world_width()),
+      world_height_(reader_.world_height()),
+      first_frame_(reader_.first_frame()),
+      last_frame_(reader_.last_frame()),
+      capacity_(buffer_frames > 0 ? buffer_frames : 1) {
+    seek_target_ = first_frame_;
+    seek_pending_ = true;
+    thread_ = std::thread(&TrajectoryPlayer::run, this);
+}
+
+TrajectoryPlayer::~TrajectoryPlayer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+}
+
+void TrajectoryPlayer::seek(uint64_t target) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        seek_target_ = target;
+        seek_pending_ = true;
+        generation_++;
+        ready_.clear();
+        at_end_ = false;
+    }
+    cv_.notify_all();
+}
+
+bool TrajectoryPlayer::advance(uint64_t playhead, TrajectoryFrame& current) {
+    bool changed = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        while (!ready_.empty() && ready_.front().frame <= playhead) {
+            current = std::move(ready_.front());
+            ready_.pop_front();
+            changed = true;
+        }
+    }
+    if (changed) cv_.notify_all();
+    return changed;
+}
+
+bool TrajectoryPlayer::at_end() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return at_end_ && ready_.empty() && !seek_pending_;
+}
+
+void TrajectoryPlayer::run() {
+    for (;;) {
+        bool do_seek;
+        uint64_t target, generation;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] {
+                return stop_ || seek_pending_ || (!at_end_ && ready_.size() < capacity_);
+            });
+            if (stop_) return;
+            do_seek = seek_pending_;
+            seek_pending_ = false;
+            target = seek_target_;
+            generation = generation_;
+        }
+
+        // Decode without holding the lock
+        TrajectoryFrame frame;
+        bool ok;
+        try {
+            ok = do_seek ? reader_.seek(target, frame) : reader_.next(frame);
+        } catch (const std::runtime_error&) {
+            ok = false;  // corrupt tail: play what decoded cleanly
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (generation != generation_) continue;  // a newer seek superseded this frame
+        if (ok) {
+            ready_.push_back(std::move(frame));
+        } else {
+            at_end_ = true;
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "trajectory.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Decodes a trajectory file ahead of the playhead on a background thread.
+// The UI thread only seeks and collects finished frames, so decode cost never
+// lands on the render loop. Throws std::runtime_error if the file is invalid.
+class TrajectoryPlayer {
+public:
+    explicit TrajectoryPlayer(const std::string& path, std::size_t buffer_frames = 8);
+    ~TrajectoryPlayer();
+
+    TrajectoryPlayer(const TrajectoryPlayer&) = delete;
+    TrajectoryPlayer& operator=(const TrajectoryPlayer&) = delete;
+
+    float world_width() const { return world_width_; }
+    float world_height() const { return world_height_; }
+    uint64_t first_frame() const { return first_frame_; }
+    uint64_t last_frame() const { return last_frame_; }
+
+    // Discards buffered frames and restarts decoding at the first frame >= target
+    void seek(uint64_t target);
+
+    // Moves the newest buffered frame with frame <= playhead into current
+    // (dropping older ones). Returns false if nothing new was ready.
+    bool advance(uint64_t playhead, TrajectoryFrame& current);
+
+    // True once the decoder has run out of frames (or hit corrupt data)
+    bool at_end() const;
+
+private:
+    void run();
+
+    TrajectoryReader reader_;   // used only by the decode thread after construction
+    float world_width_, world_height_;
+    uint64_t first_frame_, last_frame_;
+    std::size_t capacity_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<TrajectoryFrame> ready_;
+    uint64_t seek_target_ = 0;
+    uint64_t generation_ = 0;   // bumped per seek; stale decodes are discarded
+    bool seek_pending_ = false;
+    bool at_end_ = false;
+    bool stop_ = false;
+    std::thread thread_;
+};
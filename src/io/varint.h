@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+// LEB128-style unsigned varints and zigzag mapping for signed deltas,
+// shared by the binary stream formats in src/io.
+
+inline void put_varint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+inline uint64_t zigzag_encode(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t zigzag_decode(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+// Bounds-checked little-endian reader over a byte range.
+// Throws std::runtime_error on overrun.
+class ByteReader {
+public:
+    ByteReader(const uint8_t* data, std::size_t size) : data_(data), size_(size) {}
+
+    uint8_t u8() {
+        need(1);
+        return data_[pos_++];
+    }
+
+    uint16_t u16() {
+        need(2);
+        uint16_t v = static_cast<uint16_t>(data_[pos_] | (data_[pos_ + 1] << 8));
+        pos_ += 2;
+        return v;
+    }
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            const uint8_t byte = u8();
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return value;
+        }
+        throw std::runtime_error("Malformed varint");
+    }
+
+    template <typename T>
+    T raw() {
+        need(sizeof(T));
+        T value;
+        const uint8_t* src = data_ + pos_;
+        uint8_t* dst = reinterpret_cast<uint8_t*>(&value);
+        for (std::size_t i = 0; i < sizeof(T); ++i) dst[i] = src[i];
+        pos_ += sizeof(T);
+        return value;
+    }
+
+    std::size_t pos() const { return pos_; }
+    std::size_t remaining() const { return size_ - pos_; }
+
+private:
+    void need(std::size_t n) const {
+        if (size_ - pos_ < n) throw std::runtime_error("Unexpected end of data");
+    }
+
+    const uint8_t* data_;
+    std::size_t size_;
+    std::size_t pos_ = 0;
+};
+
+inline void put_u16(std::vector<uint8_t>& out, uint16_t value) {
+    out.push_back(static_cast<uint8_t>(value));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+template <typename T>
+inline void put_raw(std::vector<uint8_t>& out, const T& value) {
+    const uint8_t* src = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), src, src + sizeof(T));
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// ============================================================
+// XXH64 (Yann Collet's xxHash, 64-bit variant)
+// ============================================================
+//
+// Fast non-cryptographic hash for change detection over large buffers.
+// Output matches the reference implementation for the same bytes and seed,
+// so values can be compared across machines of the same byte order. Chain
+// buffers by passing the previous hash as the next seed.
+
+uint64_t xxh64(const void* data, std::size_t size, uint64_t seed = 0);
@@ -2,25 +2,83 @@
 #include "ecs/systems.h"
 #include "ecs/spawn.h"
 #include "ecs/stats.h"
+#include "ecs/trajectory.h"
+#include "ecs/replay.h"
 #include "render/renderer.h"
+#include "sim/ensemble.h"
 #include "components.h"
 #include "render_state.h"
 #include <flecs.h>
 #include <raylib.h>
+#include <iostream>
+#include <stdexcept>
 #include <string>
 
 int main(int argc, char* argv[]) {
-    std::string config_path = (argc > 1) ? argv[1] : "config.ini";
+    // Usage: boid_swarm [config.ini] [--stats-out <file>] [--trajectory-out <file>]
+    //                  [--ensemble-bands <boid_ensemble csv>] [--replay-log <file>]
+    std::string config_path = "config.ini";
+    std::string stats_out;
+    std::string trajectory_out;
+    std::string ensemble_bands;
+    std::string replay_log_path;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--stats-out" && i + 1 < argc) {
+            stats_out = argv[++i];
+        } else if (arg == "--trajectory-out" && i + 1 < argc) {
+            trajectory_out = argv[++i];
+        } else if (arg == "--ensemble-bands" && i + 1 < argc) {
+            ensemble_bands = argv[++i];
+        } else if (arg == "--replay-log" && i + 1 < argc) {
+            replay_log_path = argv[++i];
+        } else {
+            config_path = arg;
+        }
+    }
 
     // Initialize FLECS world
     flecs::world world;
     init_world(world, config_path);
     register_all_systems(world);
     register_stats_system(world);
+    register_trajectory_system(world);
+
+    // Optional full-run stats time series and per-boid trajectories,
+    // both written off the frame loop
+    try {
+        if (!stats_out.empty()) {
+            open_stats_stream(world, stats_out);
+            std::cout << "Streaming stats to " << stats_out << "\n";
+        }
+        if (!trajectory_out.empty()) {
+            open_trajectory_recording(world, trajectory_out);
+            std::cout << "Recording trajectories to " << trajectory_out << "\n";
+        }
+        if (!ensemble_bands.empty()) {
+            // Reference curves drawn as bands behind the live population graph
+            world.set(read_ensemble_csv(ensemble_bands));
+            std::cout << "Loaded ensemble bands from " << ensemble_bands << "\n";
+        }
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
 
     // Spawn initial population
     spawn_initial_population(world);
 
+    // Inputs and per-frame state hashes, for boid_replay
+    if (!replay_log_path.empty()) {
+        try {
+            open_replay_log(world, replay_log_path);
+            std::cout << "Logging replay to " << replay_log_path << "\n";
+        } catch (const std::runtime_error& e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+    }
+
     // Initialize Raylib renderer
     const SimConfig& config = world.get<SimConfig>();
     init_renderer(static_cast<int>(config.world_width),
@@ -48,6 +106,7 @@ int main(int argc, char* argv[]) {
 
         if (sim_state.reset_requested) {
             reset_simulation(world);
+            record_replay_reset(world);
             sim_state.reset_requested = false;
             sim_state.is_paused = false;  // Unpause after reset
         }
@@ -55,6 +114,7 @@ int main(int argc, char* argv[]) {
         // Advance all FLECS systems only if not paused
         if (!sim_state.is_paused) {
             world.progress(dt);
+            record_replay_frame(world, dt);
         }
 
         // Get render state populated by RenderSyncSystem
@@ -65,6 +125,9 @@ int main(int argc, char* argv[]) {
     }
 
     // Cleanup
+    close_stats_stream(world);
+    close_trajectory_recording(world);
+    close_replay_log(world);
     close_renderer();
 
     return 0;
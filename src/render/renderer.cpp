@@ -1,17 +1,58 @@
 #include "renderer.h"
 #include "render_config.h"
+#include "sim/population_history.h"
+#include "sim/ensemble.h"
 #include <raylib.h>
+#include <algorithm>
 #include <cmath>
 #include <fstream>
+#include <memory>
+#include <string>
 #include <vector>
 #include <cstddef>
 
 #define RAYGUI_IMPLEMENTATION
 #include <raygui.h>
 
-// CSV export state
-static float export_feedback_timer = 0.0f;
-static const char* export_feedback_text = "";
+// ============================================================
+// Overlay UI state
+// ============================================================
+
+struct SliderSpec {
+    const char* label;
+    float* value;
+    float min_val;
+    float max_val;
+    int category;
+};
+
+// Everything the overlay remembers between frames. raylib drives one window
+// per process, so this lives with the window (init_renderer/close_renderer)
+// rather than in scattered statics; simulation state stays in the world.
+struct OverlayState {
+    // CSV export feedback
+    float export_feedback_timer = 0.0f;
+    const char* export_feedback_text = "";
+
+    // Population graph: smoothed Y-axis max and per-frame scratch
+    float smoothed_max = 1.0f;
+    std::vector<HistoryBucket> buckets;
+    std::vector<float> xs, ys;
+    std::vector<std::size_t> picked;
+
+    // Parameter sliders
+    std::vector<SliderSpec> slider_specs;
+    SimConfig* last_config = nullptr;
+    int active_category = 0;
+    bool dropdown_edit_mode = false;
+};
+
+static std::unique_ptr<OverlayState> s_overlay;
+
+static OverlayState& overlay_state() {
+    if (!s_overlay) s_overlay = std::make_unique<OverlayState>();
+    return *s_overlay;
+}
 
 // ============================================================
 // Helper: Convert uint32_t RGBA to Raylib Color
@@ -33,9 +74,11 @@ static Color uint32_to_color(uint32_t rgba) {
 void init_renderer(int width, int height, const char* title) {
     InitWindow(width, height, title);
     SetTargetFPS(RenderConfig::FPS_TARGET);
+    s_overlay = std::make_unique<OverlayState>();
 }
 
 void close_renderer() {
+    s_overlay.reset();
     CloseWindow();
 }
 
@@ -90,25 +133,116 @@ void draw_interaction_radius(float x, float y, float radius, uint32_t color) {
 // Population graph helper
 // ============================================================
 
-static bool export_population_csv(const SimStats& stats) {
+static bool export_population_csv(const PopulationHistory* history) {
+    if (!history) return false;
     std::ofstream file("population_data.csv");
     if (!file.is_open()) return false;
 
-    file << "frame,normal,doctor,antivax,infected\n";
-
-    for (int i = 0; i < stats.history_count; i++) {
-        int read_index = (stats.history_index - stats.history_count + i + SimStats::HISTORY_SIZE) % SimStats::HISTORY_SIZE;
-        const auto& pt = stats.history[read_index];
-        file << (i + 1) << "," << pt.normal_alive << "," << pt.doctor_alive
-             << "," << pt.antivax_alive << "," << pt.infected_count << "\n";
+    // One row per stored bucket: raw frames for the recent window, min/max/mean
+    // aggregates of 2^level frames further back
+    file << "frame,samples,normal,doctor,antivax,infected,"
+            "normal_min,normal_max,doctor_min,doctor_max,"
+            "antivax_min,antivax_max,infected_min,infected_max\n";
+
+    std::vector<HistoryBucket> buckets;
+    history->buckets(buckets);
+    for (const HistoryBucket& b : buckets) {
+        file << (b.first_sample + 1) << "," << b.count
+             << "," << b.mean(HistorySeries::Normal) << "," << b.mean(HistorySeries::Doctor)
+             << "," << b.mean(HistorySeries::Antivax) << "," << b.mean(HistorySeries::Infected)
+             << "," << b.min.normal_alive << "," << b.max.normal_alive
+             << "," << b.min.doctor_alive << "," << b.max.doctor_alive
+             << "," << b.min.antivax_alive << "," << b.max.antivax_alive
+             << "," << b.min.infected_count << "," << b.max.infected_count << "\n";
     }
 
     return file.good();
 }
 
-static void draw_population_graph(const SimStats& stats, int x, int y, int width, int height) {
+// Draws one series as an LTTB-downsampled polyline over the whole run
+static void draw_history_series(const std::vector<HistoryBucket>& buckets, HistorySeries series,
+                                std::size_t max_points, float x0, float x_scale,
+                                float y_base, float y_scale, float thickness, Color color) {
+    OverlayState& ui = overlay_state();
+    std::vector<float>& xs = ui.xs;
+    std::vector<float>& ys = ui.ys;
+    std::vector<std::size_t>& picked = ui.picked;
+    xs.clear();
+    ys.clear();
+    for (const HistoryBucket& b : buckets) {
+        xs.push_back(static_cast<float>(b.center()));
+        ys.push_back(b.mean(series));
+    }
+    lttb_indices(xs, ys, max_points, picked);
+
+    for (std::size_t k = 0; k + 1 < picked.size(); ++k) {
+        std::size_t i = picked[k];
+        std::size_t j = picked[k + 1];
+        Vector2 p1 = {x0 + xs[i] * x_scale, y_base - ys[i] * y_scale};
+        Vector2 p2 = {x0 + xs[j] * x_scale, y_base - ys[j] * y_scale};
+        DrawLineEx(p1, p2, thickness, color);
+    }
+}
+
+// Index of the lowest and highest quantile levels of an ensemble (band edges)
+static bool ensemble_band_levels(const EnsembleSummary& ensemble, std::size_t& lo, std::size_t& hi) {
+    const auto& levels = ensemble.quantile_levels;
+    if (levels.size() < 2) return false;
+    lo = static_cast<std::size_t>(std::min_element(levels.begin(), levels.end()) - levels.begin());
+    hi = static_cast<std::size_t>(std::max_element(levels.begin(), levels.end()) - levels.begin());
+    return true;
+}
+
+// Ensemble reference band (outer quantiles, or mean ± sd) and mean line for
+// one series. Ensemble row r was recorded at frame frames[r], which is live
+// history sample frames[r] - 1.
+static void draw_ensemble_band(const EnsembleSummary& ensemble, const char* column, int plot_width,
+                               std::size_t max_points, float x0, float x_scale,
+                               float y_base, float y_scale, Color color) {
+    const EnsembleSeries* s = ensemble.find(column);
+    if (!s || s->mean.empty()) return;
+    const std::vector<uint64_t>& frames = ensemble.frames;
+    std::size_t lo_level = 0, hi_level = 0;
+    const bool quantile_band = ensemble_band_levels(ensemble, lo_level, hi_level);
+
+    // Band: one vertical span per pixel column
+    Color band = color;
+    band.a = 45;
+    for (int px = 0; px < plot_width; ++px) {
+        const uint64_t sample = static_cast<uint64_t>(static_cast<float>(px) / x_scale);
+        auto it = std::lower_bound(frames.begin(), frames.end(), sample + 1);
+        if (it == frames.end()) break;
+        const std::size_t r = static_cast<std::size_t>(it - frames.begin());
+        float lo, hi;
+        if (quantile_band) {
+            lo = s->quantiles[lo_level][r];
+            hi = s->quantiles[hi_level][r];
+        } else {
+            lo = s->mean[r] - s->sd[r];
+            hi = s->mean[r] + s->sd[r];
+        }
+        float bx = x0 + static_cast<float>(px);
+        DrawLineV({bx, y_base - std::max(lo, 0.0f) * y_scale}, {bx, y_base - hi * y_scale}, band);
+    }
+
+    // Mean: thin line, roughly one segment per 2 px like the live series
+    Color line = color;
+    line.a = 140;
+    const std::size_t step = std::max<std::size_t>(1, frames.size() / std::max<std::size_t>(max_points, 1));
+    for (std::size_t r = 0; r + step < frames.size(); r += step) {
+        const std::size_t n = r + step;
+        Vector2 p1 = {x0 + static_cast<float>(frames[r] - 1) * x_scale, y_base - s->mean[r] * y_scale};
+        Vector2 p2 = {x0 + static_cast<float>(frames[n] - 1) * x_scale, y_base - s->mean[n] * y_scale};
+        DrawLineEx(p1, p2, 1.0f, line);
+    }
+}
+
+static void draw_population_graph(const PopulationHistory* history, const EnsembleSummary* ensemble,
+                                  int x, int y, int width, int height) {
     // Smoothed max for stable Y-axis scaling
-    static float smoothed_max = 1.0f;
+    OverlayState& ui = overlay_state();
+    float& smoothed_max = ui.smoothed_max;
+    std::vector<HistoryBucket>& buckets = ui.buckets;
 
     // Graph title
     const char* title = "Population Over Time";
@@ -119,25 +253,48 @@ static void draw_population_graph(const SimStats& stats, int x, int y, int width
     DrawRectangle(x, y, width, height, Color{30, 30, 35, 255});
     DrawRectangleLines(x, y, width, height, Color{80, 80, 80, 255});
 
-    if (stats.history_count < 2) {
+    if (!history || history->total_samples() < 2) {
         smoothed_max = 1.0f;
         DrawText("Collecting data...", x + 5, y + height / 2 - 5, 10, LIGHTGRAY);
         return;
     }
 
+    history->buckets(buckets);
+
     // Find current max population
     int current_max = 1;
-    for (int i = 0; i < stats.history_count; i++) {
-        int total = stats.history[i].normal_alive + stats.history[i].doctor_alive + stats.history[i].antivax_alive;
+    for (const HistoryBucket& b : buckets) {
+        int total = b.max.normal_alive + b.max.doctor_alive + b.max.antivax_alive;
         if (total > current_max) current_max = total;
-        if (stats.history[i].infected_count > current_max) current_max = stats.history[i].infected_count;
+        if (b.max.infected_count > current_max) current_max = b.max.infected_count;
+    }
+
+    // Ensemble reference curves, if loaded, share the axes with the live run
+    static const char* const BAND_COLUMNS[] = {"infected_alive", "normal_alive", "doctor_alive", "antivax_alive"};
+    uint64_t x_span = history->total_samples() - 1;
+    if (ensemble && ensemble->rows() > 0) {
+        if (ensemble->frames.back() > 0) x_span = std::max<uint64_t>(x_span, ensemble->frames.back() - 1);
+        std::size_t lo_level = 0, hi_level = 0;
+        const bool quantile_band = ensemble_band_levels(*ensemble, lo_level, hi_level);
+        for (const char* column : BAND_COLUMNS) {
+            const EnsembleSeries* s = ensemble->find(column);
+            if (!s) continue;
+            for (std::size_t r = 0; r < ensemble->rows(); ++r) {
+                float top = quantile_band ? s->quantiles[hi_level][r] : s->mean[r] + s->sd[r];
+                current_max = std::max(current_max, static_cast<int>(std::ceil(top)));
+            }
+        }
     }
 
     smoothed_max = std::max(smoothed_max * 0.99f, static_cast<float>(current_max));
     int max_pop = static_cast<int>(std::ceil(smoothed_max));
 
+    // X axis spans the whole run; each series is downsampled to ~1 point per 2 px
     float y_scale = static_cast<float>(height - 4) / static_cast<float>(max_pop);
-    float x_scale = static_cast<float>(width - 4) / static_cast<float>(SimStats::HISTORY_SIZE - 1);
+    float x_scale = static_cast<float>(width - 4) / static_cast<float>(std::max<uint64_t>(x_span, 1));
+    std::size_t max_points = static_cast<std::size_t>(std::max(3, (width - 4) / 2));
+    float x0 = static_cast<float>(x + 2);
+    float y_base = static_cast<float>(y + height - 2);
 
     // Horizontal grid lines at 25%, 50%, 75%, 100%
     Color grid_color = {60, 60, 65, 255};
@@ -152,59 +309,29 @@ static void draw_population_graph(const SimStats& stats, int x, int y, int width
 
     // Draw infected line first (behind population lines) with transparency
     Color infected_color = {255, 60, 60, 180};
-    for (int i = 0; i < stats.history_count - 1; i++) {
-        int ri = (stats.history_index - stats.history_count + i + SimStats::HISTORY_SIZE) % SimStats::HISTORY_SIZE;
-        int ni = (ri + 1) % SimStats::HISTORY_SIZE;
-
-        float x1 = x + 2 + i * x_scale;
-        float y1 = y + height - 2 - stats.history[ri].infected_count * y_scale;
-        float x2 = x + 2 + (i + 1) * x_scale;
-        float y2 = y + height - 2 - stats.history[ni].infected_count * y_scale;
-
-        DrawLineEx(Vector2{x1, y1}, Vector2{x2, y2}, 1.5f, infected_color);
-    }
-
-    // Normal population (green)
     Color normal_color = {0, 230, 0, 230};
-    for (int i = 0; i < stats.history_count - 1; i++) {
-        int ri = (stats.history_index - stats.history_count + i + SimStats::HISTORY_SIZE) % SimStats::HISTORY_SIZE;
-        int ni = (ri + 1) % SimStats::HISTORY_SIZE;
-
-        float x1 = x + 2 + i * x_scale;
-        float y1 = y + height - 2 - stats.history[ri].normal_alive * y_scale;
-        float x2 = x + 2 + (i + 1) * x_scale;
-        float y2 = y + height - 2 - stats.history[ni].normal_alive * y_scale;
+    Color doctor_color = {0, 120, 255, 230};
+    Color antivax_color = {255, 165, 0, 230};
 
-        DrawLineEx(Vector2{x1, y1}, Vector2{x2, y2}, 2.0f, normal_color);
+    // Ensemble bands sit behind every live line
+    if (ensemble && ensemble->rows() > 0) {
+        const Color band_colors[] = {infected_color, normal_color, doctor_color, antivax_color};
+        for (int i = 0; i < 4; ++i) {
+            draw_ensemble_band(*ensemble, BAND_COLUMNS[i], width - 4, max_points, x0, x_scale,
+                               y_base, y_scale, band_colors[i]);
+        }
     }
 
-    // Doctor population (blue)
-    Color doctor_color = {0, 120, 255, 230};
-    for (int i = 0; i < stats.history_count - 1; i++) {
-        int ri = (stats.history_index - stats.history_count + i + SimStats::HISTORY_SIZE) % SimStats::HISTORY_SIZE;
-        int ni = (ri + 1) % SimStats::HISTORY_SIZE;
+    draw_history_series(buckets, HistorySeries::Infected, max_points, x0, x_scale, y_base, y_scale, 1.5f, infected_color);
 
-        float x1 = x + 2 + i * x_scale;
-        float y1 = y + height - 2 - stats.history[ri].doctor_alive * y_scale;
-        float x2 = x + 2 + (i + 1) * x_scale;
-        float y2 = y + height - 2 - stats.history[ni].doctor_alive * y_scale;
+    // Normal population (green)
+    draw_history_series(buckets, HistorySeries::Normal, max_points, x0, x_scale, y_base, y_scale, 2.0f, normal_color);
 
-        DrawLineEx(Vector2{x1, y1}, Vector2{x2, y2}, 2.0f, doctor_color);
-    }
+    // Doctor population (blue)
+    draw_history_series(buckets, HistorySeries::Doctor, max_points, x0, x_scale, y_base, y_scale, 2.0f, doctor_color);
 
     // Antivax population (orange)
-    Color antivax_color = {255, 165, 0, 230};
-    for (int i = 0; i < stats.history_count - 1; i++) {
-        int ri = (stats.history_index - stats.history_count + i + SimStats::HISTORY_SIZE) % SimStats::HISTORY_SIZE;
-        int ni = (ri + 1) % SimStats::HISTORY_SIZE;
-
-        float x1 = x + 2 + i * x_scale;
-        float y1 = y + height - 2 - stats.history[ri].antivax_alive * y_scale;
-        float x2 = x + 2 + (i + 1) * x_scale;
-        float y2 = y + height - 2 - stats.history[ni].antivax_alive * y_scale;
-
-        DrawLineEx(Vector2{x1, y1}, Vector2{x2, y2}, 2.0f, antivax_color);
-    }
+    draw_history_series(buckets, HistorySeries::Antivax, max_points, x0, x_scale, y_base, y_scale, 2.0f, antivax_color);
 
     // Legend (top-right, vertical)
     int lx = x + width - 68;
@@ -224,90 +351,89 @@ static void draw_population_graph(const SimStats& stats, int x, int y, int width
 
     // Max value label (top-left)
     DrawText(TextFormat("Max: %d", max_pop), x + 3, y + 3, 8, Color{130, 130, 130, 255});
+
+    if (ensemble && ensemble->rows() > 0) {
+        std::size_t lo_level = 0, hi_level = 0;
+        std::string band = ensemble_band_levels(*ensemble, lo_level, hi_level)
+            ? quantile_label(ensemble->quantile_levels[lo_level]) + "-" +
+              quantile_label(ensemble->quantile_levels[hi_level])
+            : std::string("mean +/- sd");
+        DrawText(TextFormat("Bands: ensemble %s", band.c_str()), x + 3, y + 13, 8, Color{130, 130, 130, 255});
+    }
 }
 
 // ============================================================
 // Stats overlay with interactive controls (dropdown categories)
 // ============================================================
 
-struct SliderSpec {
-    const char* label;
-    float* value;
-    float min_val;
-    float max_val;
-    int category;
-};
-
-static std::vector<SliderSpec> s_slider_specs;
-static SimConfig* s_last_config = nullptr;
-static int s_active_category = 0;
-static bool s_dropdown_edit_mode = false;
-
-static void build_slider_specs(SimConfig* config) {
-    s_slider_specs.clear();
-    s_last_config = config;
+static void build_slider_specs(OverlayState& ui, SimConfig* config) {
+    std::vector<SliderSpec>& specs = ui.slider_specs;
+    specs.clear();
+    ui.last_config = config;
 
     // Category 0: Infection
-    s_slider_specs.push_back({"p_init_inf_nrm", &config->p_initial_infect_normal,  0.0f,   1.0f, 0});
-    s_slider_specs.push_back({"p_init_inf_doc", &config->p_initial_infect_doctor,  0.0f,   1.0f, 0});
-    s_slider_specs.push_back({"p_infect_nrm",   &config->p_infect_normal,          0.0f,   1.0f, 0});
-    s_slider_specs.push_back({"p_infect_doc",   &config->p_infect_doctor,          0.0f,   1.0f, 0});
+    specs.push_back({"p_init_inf_nrm", &config->p_initial_infect_normal,  0.0f,   1.0f, 0});
+    specs.push_back({"p_init_inf_doc", &config->p_initial_infect_doctor,  0.0f,   1.0f, 0});
+    specs.push_back({"p_infect_nrm",   &config->p_infect_normal,          0.0f,   1.0f, 0});
+    specs.push_back({"p_infect_doc",   &config->p_infect_doctor,          0.0f,   1.0f, 0});
+    specs.push_back({"infect_tick_hz", &config->infection_tick_rate,      0.0f,  10.0f, 0});
 
     // Category 1: Cure
-    s_slider_specs.push_back({"p_cure",          &config->p_cure,                   0.0f,   1.0f, 1});
+    specs.push_back({"p_cure",          &config->p_cure,                   0.0f,   1.0f, 1});
 
     // Category 2: Reproduction
-    s_slider_specs.push_back({"p_offspr_nrm",   &config->p_offspring_normal,       0.0f,   1.0f, 2});
-    s_slider_specs.push_back({"p_offspr_doc",   &config->p_offspring_doctor,       0.0f,   1.0f, 2});
-    s_slider_specs.push_back({"mean_offspr_nrm", &config->offspring_mean_normal,   0.0f,  10.0f, 2});
-    s_slider_specs.push_back({"std_offspr_nrm", &config->offspring_stddev_normal,  0.0f,   5.0f, 2});
-    s_slider_specs.push_back({"mean_offspr_doc", &config->offspring_mean_doctor,   0.0f,  10.0f, 2});
-    s_slider_specs.push_back({"std_offspr_doc", &config->offspring_stddev_doctor,  0.0f,   5.0f, 2});
-    s_slider_specs.push_back({"repro_cooldown", &config->reproduction_cooldown,    0.0f,  30.0f, 2});
+    specs.push_back({"p_offspr_nrm",   &config->p_offspring_normal,       0.0f,   1.0f, 2});
+    specs.push_back({"p_offspr_doc",   &config->p_offspring_doctor,       0.0f,   1.0f, 2});
+    specs.push_back({"mean_offspr_nrm", &config->offspring_mean_normal,   0.0f,  10.0f, 2});
+    specs.push_back({"std_offspr_nrm", &config->offspring_stddev_normal,  0.0f,   5.0f, 2});
+    specs.push_back({"mean_offspr_doc", &config->offspring_mean_doctor,   0.0f,  10.0f, 2});
+    specs.push_back({"std_offspr_doc", &config->offspring_stddev_doctor,  0.0f,   5.0f, 2});
+    specs.push_back({"repro_cooldown", &config->reproduction_cooldown,    0.0f,  30.0f, 2});
 
     // Category 3: Transition
-    s_slider_specs.push_back({"p_become_doc",   &config->p_become_doctor,          0.0f,   1.0f, 3});
-    s_slider_specs.push_back({"p_antivax",      &config->p_antivax,               0.0f,   1.0f, 3});
+    specs.push_back({"p_become_doc",   &config->p_become_doctor,          0.0f,   1.0f, 3});
+    specs.push_back({"p_antivax",      &config->p_antivax,               0.0f,   1.0f, 3});
 
     // Category 4: Interaction
-    s_slider_specs.push_back({"r_interact_nrm", &config->r_interact_normal,        1.0f, 200.0f, 4});
-    s_slider_specs.push_back({"r_interact_doc", &config->r_interact_doctor,        1.0f, 200.0f, 4});
+    specs.push_back({"r_interact_nrm", &config->r_interact_normal,        1.0f, 200.0f, 4});
+    specs.push_back({"r_interact_doc", &config->r_interact_doctor,        1.0f, 200.0f, 4});
 
     // Category 5: Movement
-    s_slider_specs.push_back({"max_speed",      &config->max_speed,               10.0f, 500.0f, 5});
-    s_slider_specs.push_back({"max_force",      &config->max_force,               10.0f, 500.0f, 5});
-    s_slider_specs.push_back({"min_speed",      &config->min_speed,                0.0f, 500.0f, 5});
-    s_slider_specs.push_back({"sep_weight",     &config->separation_weight,        0.0f,   5.0f, 5});
-    s_slider_specs.push_back({"align_weight",   &config->alignment_weight,         0.0f,   5.0f, 5});
-    s_slider_specs.push_back({"cohes_weight",   &config->cohesion_weight,          0.0f,   5.0f, 5});
-    s_slider_specs.push_back({"sep_radius",     &config->separation_radius,        1.0f, 200.0f, 5});
-    s_slider_specs.push_back({"align_radius",   &config->alignment_radius,         1.0f, 200.0f, 5});
-    s_slider_specs.push_back({"cohes_radius",   &config->cohesion_radius,          1.0f, 200.0f, 5});
+    specs.push_back({"max_speed",      &config->max_speed,               10.0f, 500.0f, 5});
+    specs.push_back({"max_force",      &config->max_force,               10.0f, 500.0f, 5});
+    specs.push_back({"min_speed",      &config->min_speed,                0.0f, 500.0f, 5});
+    specs.push_back({"sep_weight",     &config->separation_weight,        0.0f,   5.0f, 5});
+    specs.push_back({"align_weight",   &config->alignment_weight,         0.0f,   5.0f, 5});
+    specs.push_back({"cohes_weight",   &config->cohesion_weight,          0.0f,   5.0f, 5});
+    specs.push_back({"sep_radius",     &config->separation_radius,        1.0f, 200.0f, 5});
+    specs.push_back({"align_radius",   &config->alignment_radius,         1.0f, 200.0f, 5});
+    specs.push_back({"cohes_radius",   &config->cohesion_radius,          1.0f, 200.0f, 5});
 
     // Category 6: Debuffs
-    s_slider_specs.push_back({"db_p_cure",      &config->debuff_p_cure_infected,            0.0f, 2.0f, 6});
-    s_slider_specs.push_back({"db_r_int_doc",   &config->debuff_r_interact_doctor_infected, 0.0f, 2.0f, 6});
-    s_slider_specs.push_back({"db_p_off_doc",   &config->debuff_p_offspring_doctor_infected, 0.0f, 2.0f, 6});
-    s_slider_specs.push_back({"db_r_int_nrm",   &config->debuff_r_interact_normal_infected, 0.0f, 2.0f, 6});
-    s_slider_specs.push_back({"db_p_off_nrm",   &config->debuff_p_offspring_normal_infected, 0.0f, 2.0f, 6});
+    specs.push_back({"db_p_cure",      &config->debuff_p_cure_infected,            0.0f, 2.0f, 6});
+    specs.push_back({"db_r_int_doc",   &config->debuff_r_interact_doctor_infected, 0.0f, 2.0f, 6});
+    specs.push_back({"db_p_off_doc",   &config->debuff_p_offspring_doctor_infected, 0.0f, 2.0f, 6});
+    specs.push_back({"db_r_int_nrm",   &config->debuff_r_interact_normal_infected, 0.0f, 2.0f, 6});
+    specs.push_back({"db_p_off_nrm",   &config->debuff_p_offspring_normal_infected, 0.0f, 2.0f, 6});
 
     // Category 7: Antivax
-    s_slider_specs.push_back({"av_repul_radius", &config->antivax_repulsion_radius, 1.0f, 300.0f, 7});
-    s_slider_specs.push_back({"av_repul_weight", &config->antivax_repulsion_weight, 0.0f,  10.0f, 7});
+    specs.push_back({"av_repul_radius", &config->antivax_repulsion_radius, 1.0f, 300.0f, 7});
+    specs.push_back({"av_repul_weight", &config->antivax_repulsion_weight, 0.0f,  10.0f, 7});
 
     // Category 8: Time
-    s_slider_specs.push_back({"t_death",        &config->t_death,                  0.5f,  30.0f, 8});
-    s_slider_specs.push_back({"t_adult",        &config->t_adult,                  0.5f,  60.0f, 8});
+    specs.push_back({"t_death",        &config->t_death,                  0.5f,  30.0f, 8});
+    specs.push_back({"t_adult",        &config->t_adult,                  0.5f,  60.0f, 8});
 }
 
 void draw_stats_overlay(const RenderState& state) {
     const SimStats& stats = state.stats;
     SimConfig* config = state.config;
     SimulationState* sim_state = state.sim_state;
+    OverlayState& ui = overlay_state();
 
     // Rebuild slider specs if config pointer changed (e.g. after reset)
-    if (config && config != s_last_config) {
-        build_slider_specs(config);
+    if (config && config != ui.last_config) {
+        build_slider_specs(ui, config);
     }
 
     // Draw panel background
@@ -388,22 +514,22 @@ void draw_stats_overlay(const RenderState& state) {
                                     static_cast<float>(RenderConfig::STATS_PANEL_WIDTH - 20), 24};
 
         // When dropdown is open, skip sliders to avoid z-overlap
-        if (s_dropdown_edit_mode) {
+        if (ui.dropdown_edit_mode) {
             // Draw dropdown on top (edit mode = open)
-            if (GuiDropdownBox(dropdown_rect, categories, &s_active_category, true)) {
-                s_dropdown_edit_mode = false;
+            if (GuiDropdownBox(dropdown_rect, categories, &ui.active_category, true)) {
+                ui.dropdown_edit_mode = false;
             }
         } else {
             // Draw dropdown (closed)
-            if (GuiDropdownBox(dropdown_rect, categories, &s_active_category, false)) {
-                s_dropdown_edit_mode = true;
+            if (GuiDropdownBox(dropdown_rect, categories, &ui.active_category, false)) {
+                ui.dropdown_edit_mode = true;
             }
             y += 28;
 
             // Draw sliders for the active category
-            for (std::size_t i = 0; i < s_slider_specs.size(); ++i) {
-                const SliderSpec& spec = s_slider_specs[i];
-                if (spec.category != s_active_category) continue;
+            for (std::size_t i = 0; i < ui.slider_specs.size(); ++i) {
+                const SliderSpec& spec = ui.slider_specs[i];
+                if (spec.category != ui.active_category) continue;
 
                 GuiLabel(Rectangle{static_cast<float>(x), static_cast<float>(y),
                                     static_cast<float>(label_width), 20},
@@ -417,7 +543,7 @@ void draw_stats_overlay(const RenderState& state) {
             }
 
             // Cross-parameter guard: min_speed <= max_speed
-            if (s_active_category == 5) {
+            if (ui.active_category == 5) {
                 if (config->min_speed > config->max_speed) {
                     config->min_speed = config->max_speed;
                 }
@@ -439,7 +565,7 @@ void draw_stats_overlay(const RenderState& state) {
     y += line_height + 14;
     const int graph_width = RenderConfig::STATS_PANEL_WIDTH - 20;
     const int graph_height = 150;
-    draw_population_graph(stats, x, y, graph_width, graph_height);
+    draw_population_graph(state.history, state.ensemble, x, y, graph_width, graph_height);
     y += graph_height + 8;
 
     // ========================================================
@@ -449,20 +575,20 @@ void draw_stats_overlay(const RenderState& state) {
         if (GuiButton(Rectangle{static_cast<float>(x), static_cast<float>(y),
                                  static_cast<float>(button_width), static_cast<float>(button_height)},
                       "Export CSV")) {
-            if (export_population_csv(stats)) {
-                export_feedback_text = "Exported to population_data.csv!";
+            if (export_population_csv(state.history)) {
+                ui.export_feedback_text = "Exported to population_data.csv!";
             } else {
-                export_feedback_text = "Export failed!";
+                ui.export_feedback_text = "Export failed!";
             }
-            export_feedback_timer = 2.0f;
+            ui.export_feedback_timer = 2.0f;
         }
     }
 
     // Show export feedback
-    if (export_feedback_timer > 0.0f) {
-        export_feedback_timer -= GetFrameTime();
-        unsigned char alpha = static_cast<unsigned char>(255 * std::min(1.0f, export_feedback_timer));
-        DrawText(export_feedback_text, x, y + button_height + 4, 10, Color{200, 255, 200, alpha});
+    if (ui.export_feedback_timer > 0.0f) {
+        ui.export_feedback_timer -= GetFrameTime();
+        unsigned char alpha = static_cast<unsigned char>(255 * std::min(1.0f, ui.export_feedback_timer));
+        DrawText(ui.export_feedback_text, x, y + button_height + 4, 10, Color{200, 255, 200, alpha});
     }
 }
 
@@ -470,9 +596,7 @@ void draw_stats_overlay(const RenderState& state) {
 // Render complete frame
 // ============================================================
 
-void render_frame(const RenderState& state) {
-    begin_frame();
-
+void draw_world(const RenderState& state) {
     // Draw interaction radii first (background layer)
     for (const auto& boid : state.boids) {
         uint32_t radius_color;
@@ -490,6 +614,12 @@ void render_frame(const RenderState& state) {
     for (const auto& boid : state.boids) {
         draw_boid(boid.x, boid.y, boid.angle, boid.color, RenderConfig::BOID_BASE_RADIUS);
     }
+}
+
+void render_frame(const RenderState& state) {
+    begin_frame();
+
+    draw_world(state);
 
     // Draw stats overlay with interactive controls
     if (state.sim_state && state.sim_state->show_stats_overlay) {
@@ -30,5 +30,9 @@ void draw_interaction_radius(float x, float y, float radius, uint32_t color);
 // Gets config and sim_state pointers from RenderState
 void draw_stats_overlay(const RenderState& state);
 
+// Draw interaction radii and boids (no overlay, no begin/end frame).
+// Lets callers with their own HUD (replay_viewer) reuse the scene drawing.
+void draw_world(const RenderState& state);
+
 // Render a complete frame from the provided render state
 void render_frame(const RenderState& state);
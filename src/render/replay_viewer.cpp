@@ -0,0 +1,148 @@
+#include "renderer.h"
+#include "render_config.h"
+#include "config_loader.h"
+#include "io/trajectory_player.h"
+#include <raylib.h>
+#include <raygui.h>
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+// ============================================================
+// Trajectory replay viewer — renders a recording, no simulation
+// ============================================================
+//
+// Usage: replay_viewer <recording.btrj> [config.ini]
+// The config only supplies interaction radii for drawing.
+//
+// Controls: SPACE play/pause, LEFT/RIGHT seek -/+ 5 s, UP/DOWN speed x2 / /2,
+// HOME/END jump to start/end, drag the timeline to scrub.
+
+namespace {
+
+constexpr float MIN_SPEED = 0.125f;
+constexpr float MAX_SPEED = 16.0f;
+constexpr int TIMELINE_HEIGHT = 20;
+constexpr int SEEK_STEP_FRAMES = 5 * RenderConfig::FPS_TARGET;
+
+uint32_t swarm_color(uint8_t swarm_type) {
+    if (swarm_type == 2) return RenderConfig::COLOR_ANTIVAX;
+    if (swarm_type == 1) return RenderConfig::COLOR_DOCTOR;
+    return RenderConfig::COLOR_NORMAL;
+}
+
+// Converts a decoded frame to render data; counts go into the stats copy
+void fill_render_state(const TrajectoryFrame& frame, const SimConfig& config, RenderState& rs) {
+    rs.boids.clear();
+    rs.boids.reserve(frame.boids.size());
+    rs.stats = SimStats{};
+    for (const auto& s : frame.boids) {
+        BoidRenderData brd;
+        brd.x = s.x;
+        brd.y = s.y;
+        brd.angle = s.angle;
+        brd.swarm_type = s.swarm_type;
+        brd.id = s.id;
+        brd.infected = s.infected;
+        brd.color = s.infected ? RenderConfig::COLOR_INFECTED : swarm_color(s.swarm_type);
+        brd.radius = (s.swarm_type == 1) ? config.r_interact_doctor : config.r_interact_normal;
+        rs.boids.push_back(brd);
+
+        if (s.swarm_type == 1) rs.stats.doctor_alive++;
+        else if (s.swarm_type == 2) rs.stats.antivax_alive++;
+        else rs.stats.normal_alive++;
+        if (s.infected) rs.stats.infected_alive++;
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <recording.btrj> [config.ini]\n";
+        return 2;
+    }
+
+    SimConfig config{};
+    try {
+        load_config(argc > 2 ? argv[2] : "config.ini", config);
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    try {
+        TrajectoryPlayer player(argv[1]);
+        const double first = static_cast<double>(player.first_frame());
+        const double last = static_cast<double>(player.last_frame());
+
+        init_renderer(static_cast<int>(player.world_width()),
+                      static_cast<int>(player.world_height()),
+                      "Boid Swarm Replay");
+
+        RenderState rs;
+        TrajectoryFrame current;
+        double playhead = first;
+        float speed = 1.0f;
+        bool playing = true;
+
+        while (!WindowShouldClose()) {
+            // --- Input ---
+            auto seek_to = [&](double frame) {
+                playhead = std::clamp(frame, first, last);
+                player.seek(static_cast<uint64_t>(playhead));
+            };
+            if (IsKeyPressed(KEY_SPACE)) playing = !playing;
+            if (IsKeyPressed(KEY_UP)) speed = std::min(MAX_SPEED, speed * 2.0f);
+            if (IsKeyPressed(KEY_DOWN)) speed = std::max(MIN_SPEED, speed * 0.5f);
+            if (IsKeyPressed(KEY_RIGHT)) seek_to(playhead + SEEK_STEP_FRAMES);
+            if (IsKeyPressed(KEY_LEFT)) seek_to(playhead - SEEK_STEP_FRAMES);
+            if (IsKeyPressed(KEY_HOME)) seek_to(first);
+            if (IsKeyPressed(KEY_END)) seek_to(last);
+
+            // --- Advance playhead (recorded frames are simulation frames) ---
+            if (playing && playhead < last) {
+                playhead = std::min(last, playhead + GetFrameTime() * RenderConfig::FPS_TARGET * speed);
+            }
+            if (player.advance(static_cast<uint64_t>(playhead), current)) {
+                fill_render_state(current, config, rs);
+            }
+
+            // --- Draw ---
+            begin_frame();
+            draw_world(rs);
+
+            const float width = static_cast<float>(GetScreenWidth());
+            const float height = static_cast<float>(GetScreenHeight());
+            char hud[160];
+            std::snprintf(hud, sizeof(hud),
+                          "%s  x%.3g  frame %llu  t=%.1fs  normal %d  doctor %d  antivax %d  infected %d",
+                          playing ? "PLAY" : "PAUSE", speed,
+                          static_cast<unsigned long long>(current.frame), current.time,
+                          rs.stats.normal_alive, rs.stats.doctor_alive,
+                          rs.stats.antivax_alive, rs.stats.infected_alive);
+            DrawText(hud, 10, static_cast<int>(height) - TIMELINE_HEIGHT - 24, 16, RAYWHITE);
+
+            // Timeline: dragging scrubs (seeks every frame the value changes)
+            const float shown = static_cast<float>(playhead);
+            float scrub = shown;
+            GuiSliderBar(Rectangle{60.0f, height - TIMELINE_HEIGHT - 4, width - 120.0f,
+                                   static_cast<float>(TIMELINE_HEIGHT)},
+                         "start", "end", &scrub,
+                         static_cast<float>(first), static_cast<float>(std::max(last, first + 1.0)));
+            if (scrub != shown) {
+                seek_to(scrub);
+            }
+
+            end_frame();
+        }
+
+        close_renderer();
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
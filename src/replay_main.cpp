@@ -0,0 +1,134 @@
+#include "ecs/replay.h"
+#include "io/replay_log.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// ============================================================
+// Replay a logged run and find where it stops matching
+// ============================================================
+
+static void print_usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0 << " <log> [options]\n"
+              << "  (default)          re-simulate the log and check every frame's state hash\n"
+              << "  --threads T        sim_threads for the replay (default 1; 0 = all cores)\n"
+              << "  --compare <log>    compare two logs of the same run (e.g. from two machines)\n"
+              << "                     and bisect to the first frame where they diverge\n";
+}
+
+static std::string hex(uint64_t v) {
+    char buf[24];
+    std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(v));
+    return buf;
+}
+
+static void print_frame(const char* label, const ReplayFrame& f) {
+    std::cerr << "  " << label << " frame " << f.frame << " dt " << f.dt << ": kinematics "
+              << hex(f.hash.kinematics) << " epidemic " << hex(f.hash.epidemic) << " globals "
+              << hex(f.hash.globals) << "\n";
+}
+
+// Index of the first event whose inputs differ (dt, config, reset), or -1
+static long long first_input_difference(const ReplayLog& a, const ReplayLog& b) {
+    const std::size_t n = std::min(a.events.size(), b.events.size());
+    for (std::size_t i = 0; i < n; ++i) {
+        const ReplayEvent& x = a.events[i];
+        const ReplayEvent& y = b.events[i];
+        if (x.type != y.type) return static_cast<long long>(i);
+        if (x.type == ReplayRecord::Frame && x.frame.dt != y.frame.dt) return static_cast<long long>(i);
+        if (x.type == ReplayRecord::Config) {
+            SimConfig cx = x.config, cy = y.config;
+            cx.sim_threads = cy.sim_threads = 0;   // execution only; results do not depend on it
+            if (std::memcmp(&cx, &cy, sizeof(SimConfig)) != 0) return static_cast<long long>(i);
+        }
+    }
+    return -1;
+}
+
+static int compare_logs(const ReplayLog& a, const ReplayLog& b) {
+    if (a.start != b.start) {
+        std::cout << "The logs start from different worlds ("
+                  << describe_hash_difference(a.start, b.start) << " differ)\n";
+        return 1;
+    }
+    const long long input = first_input_difference(a, b);
+    if (input >= 0) std::cerr << "Inputs differ from event " << input << " on\n";
+
+    const std::vector<ReplayFrame> fa = a.frames();
+    const std::vector<ReplayFrame> fb = b.frames();
+    const long long diverged = first_divergent_frame(fa, fb);
+    if (diverged < 0) {
+        std::cout << "No divergence in " << std::min(fa.size(), fb.size()) << " common frames";
+        if (fa.size() != fb.size()) std::cout << " (logs have " << fa.size() << " and " << fb.size() << ")";
+        std::cout << "\n";
+        return input >= 0 ? 1 : 0;
+    }
+    const ReplayFrame& x = fa[static_cast<std::size_t>(diverged)];
+    const ReplayFrame& y = fb[static_cast<std::size_t>(diverged)];
+    std::cout << "First divergent frame: " << x.frame << " (logged frame #" << diverged << "), "
+              << describe_hash_difference(x.hash, y.hash) << " differ\n";
+    if (diverged > 0) print_frame("last equal", fa[static_cast<std::size_t>(diverged - 1)]);
+    print_frame("first log ", x);
+    print_frame("second log", y);
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    std::string log_path;
+    std::string compare_path;
+    int threads = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--threads" && has_value) {
+            threads = std::atoi(argv[++i]);
+        } else if (arg == "--compare" && has_value) {
+            compare_path = argv[++i];
+        } else if (arg == "--help" || arg == "-h") {
+            print_usage(argv[0]);
+            return 0;
+        } else if (!arg.empty() && arg[0] == '-') {
+            print_usage(argv[0]);
+            return 2;
+        } else {
+            log_path = arg;
+        }
+    }
+    if (log_path.empty() || threads < 0) {
+        print_usage(argv[0]);
+        return 2;
+    }
+
+    try {
+        const ReplayLog log = read_replay_log(log_path);
+        if (!compare_path.empty()) return compare_logs(log, read_replay_log(compare_path));
+
+        const std::vector<ReplayFrame> logged = log.frames();
+        std::cerr << "Replaying " << logged.size() << " frames of " << log_path << " with "
+                  << threads << " sim thread(s)\n";
+        const ReplayCheck check = replay_log(log, threads);
+        if (!check.start_matches) {
+            std::cout << "The restored starting world does not match the log\n";
+            return 1;
+        }
+        if (check.divergent < 0) {
+            std::cout << "All " << check.frames.size() << " frames match\n";
+            return 0;
+        }
+        const std::size_t i = static_cast<std::size_t>(check.divergent);
+        std::cout << "First divergent frame: " << logged[i].frame << " (logged frame #" << i << "), "
+                  << describe_hash_difference(logged[i].hash, check.frames[i].hash) << " differ\n";
+        print_frame("logged  ", logged[i]);
+        print_frame("replayed", check.frames[i]);
+        return 1;
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+}
@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <stdexcept>
 #include <iostream>
+#include <iterator>
 
 namespace {
 
@@ -17,23 +18,37 @@ std::string trim(const std::string& s) {
     return s.substr(start, end - start + 1);
 }
 
+// line_num 0 = value set programmatically (set_config_value)
+std::string location(int line_num) {
+    return line_num > 0 ? "config line " + std::to_string(line_num) : std::string("config override");
+}
+
 float parse_float(const std::string& val, int line_num) {
     try {
         return std::stof(val);
     } catch (...) {
         throw std::runtime_error(
-            "config line " + std::to_string(line_num) +
-            ": cannot parse '" + val + "' as float");
+            location(line_num) + ": cannot parse '" + val + "' as float");
     }
 }
 
+bool parse_bool(const std::string& val, int line_num) {
+    if (val == "1" || val == "true")  return true;
+    if (val == "0" || val == "false") return false;
+    throw std::runtime_error(
+        location(line_num) + ": cannot parse '" + val + "' as bool (use 0/1/true/false)");
+}
+
+// Whole string only: "12.5" is an error rather than a silent 12
 int parse_int(const std::string& val, int line_num) {
     try {
-        return std::stoi(val);
+        std::size_t used = 0;
+        const int v = std::stoi(val, &used);
+        if (used != val.size()) throw std::invalid_argument(val);
+        return v;
     } catch (...) {
         throw std::runtime_error(
-            "config line " + std::to_string(line_num) +
-            ": cannot parse '" + val + "' as int");
+            location(line_num) + ": cannot parse '" + val + "' as int");
     }
 }
 
@@ -44,6 +59,7 @@ bool apply_field(SimConfig& config, const std::string& key,
     else if (key == "p_initial_infect_doctor")  { config.p_initial_infect_doctor = parse_float(val, line_num); }
     else if (key == "p_infect_normal")          { config.p_infect_normal = parse_float(val, line_num); }
     else if (key == "p_infect_doctor")          { config.p_infect_doctor = parse_float(val, line_num); }
+    else if (key == "infection_tick_rate")      { config.infection_tick_rate = parse_float(val, line_num); }
     // Reproduction
     else if (key == "p_offspring_normal")       { config.p_offspring_normal = parse_float(val, line_num); }
     else if (key == "p_offspring_doctor")       { config.p_offspring_doctor = parse_float(val, line_num); }
@@ -68,6 +84,25 @@ bool apply_field(SimConfig& config, const std::string& key,
     // Population (int)
     else if (key == "initial_normal_count")     { config.initial_normal_count = parse_int(val, line_num); }
     else if (key == "initial_doctor_count")     { config.initial_doctor_count = parse_int(val, line_num); }
+    // Execution (int)
+    else if (key == "sim_threads")              { config.sim_threads = parse_int(val, line_num); }
+    else if (key == "seed")                     { config.seed = parse_int(val, line_num); }
+    else if (key == "toggle_state_tags")        { config.toggle_state_tags = parse_bool(val, line_num); }
+    else if (key == "recycle_entities")         { config.recycle_entities = parse_bool(val, line_num); }
+    else if (key == "stats_stream_interval")    { config.stats_stream_interval = parse_int(val, line_num); }
+    else if (key == "trajectory_interval")      { config.trajectory_interval = parse_int(val, line_num); }
+    else if (key == "trajectory_keyframe_interval") { config.trajectory_keyframe_interval = parse_int(val, line_num); }
+    else if (key == "trajectory_tolerance")     { config.trajectory_tolerance = parse_float(val, line_num); }
+    else if (key == "trajectory_heading_tolerance") { config.trajectory_heading_tolerance = parse_float(val, line_num); }
+    // Early termination
+    else if (key == "stop_on_normal_extinct")   { config.stop_on_normal_extinct = parse_bool(val, line_num); }
+    else if (key == "stop_on_doctor_extinct")   { config.stop_on_doctor_extinct = parse_bool(val, line_num); }
+    else if (key == "stop_on_antivax_extinct")  { config.stop_on_antivax_extinct = parse_bool(val, line_num); }
+    else if (key == "stop_no_infected_seconds") { config.stop_no_infected_seconds = parse_float(val, line_num); }
+    else if (key == "stop_steady_window")       { config.stop_steady_window = parse_float(val, line_num); }
+    else if (key == "stop_steady_variance")     { config.stop_steady_variance = parse_float(val, line_num); }
+    // Burn-in
+    else if (key == "burn_in_seconds")          { config.burn_in_seconds = parse_float(val, line_num); }
     // Movement
     else if (key == "max_speed")                { config.max_speed = parse_float(val, line_num); }
     else if (key == "max_force")                { config.max_force = parse_float(val, line_num); }
@@ -88,15 +123,27 @@ bool apply_field(SimConfig& config, const std::string& key,
     else if (key == "antivax_repulsion_radius")  { config.antivax_repulsion_radius = parse_float(val, line_num); }
     else if (key == "antivax_repulsion_weight")  { config.antivax_repulsion_weight = parse_float(val, line_num); }
     else {
-        std::cerr << "config warning: unknown key '" << key << "' on line "
-                  << line_num << " (ignored)\n";
         return false;
     }
     return true;
 }
 
+// Keys apply_field parses with parse_int
+const char* const INTEGER_KEYS[] = {
+    "initial_normal_count", "initial_doctor_count", "sim_threads", "seed",
+    "stats_stream_interval", "trajectory_interval", "trajectory_keyframe_interval",
+};
+
 } // anonymous namespace
 
+bool is_integer_config_key(const std::string& key) {
+    return std::find(std::begin(INTEGER_KEYS), std::end(INTEGER_KEYS), key) != std::end(INTEGER_KEYS);
+}
+
+bool set_config_value(SimConfig& config, const std::string& key, const std::string& value) {
+    return apply_field(config, key, value, 0);
+}
+
 bool load_config(const std::string& path, SimConfig& config) {
     std::ifstream file(path);
     if (!file.is_open()) {
@@ -143,7 +190,10 @@ bool load_config(const std::string& path, SimConfig& config) {
                 ": empty key or value");
         }
 
-        apply_field(config, key, val, line_num);
+        if (!apply_field(config, key, val, line_num)) {
+            std::cerr << "config warning: unknown key '" << key << "' on line "
+                      << line_num << " (ignored)\n";
+        }
     }
 
     return true;
@@ -1,9 +1,11 @@
 #pragma once
 
 #include <random>
+#include "rng.h"
 
 // Pure C++ cure logic — no FLECS includes
 
 // Attempt cure with given probability
 // Returns true if cure succeeds
 bool try_cure(float p_cure, std::mt19937& rng);
+bool try_cure(float p_cure, KeyedRng& rng);
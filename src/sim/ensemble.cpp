@@ -0,0 +1,259 @@
+#include "ensemble.h"
+#include "io/stats_stream.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+// ============================================================
+// P² quantile estimator
+// ============================================================
+
+P2Quantile::P2Quantile(double p) : p_(p) {}
+
+void P2Quantile::add(double x) {
+    if (count_ < 5) {
+        heights_[count_++] = x;
+        if (count_ == 5) {
+            std::sort(heights_, heights_ + 5);
+            for (int i = 0; i < 5; ++i) positions_[i] = i;
+            desired_[0] = 0.0;
+            desired_[1] = 2.0 * p_;
+            desired_[2] = 4.0 * p_;
+            desired_[3] = 2.0 + 2.0 * p_;
+            desired_[4] = 4.0;
+        }
+        return;
+    }
+    count_++;
+
+    // Cell containing x; extremes move the end markers
+    int k;
+    if (x < heights_[0]) {
+        heights_[0] = x;
+        k = 0;
+    } else if (x >= heights_[4]) {
+        heights_[4] = x;
+        k = 3;
+    } else {
+        k = 0;
+        while (k < 3 && x >= heights_[k + 1]) ++k;
+    }
+    for (int i = k + 1; i < 5; ++i) positions_[i] += 1.0;
+
+    const double increments[5] = {0.0, p_ / 2.0, p_, (1.0 + p_) / 2.0, 1.0};
+    for (int i = 0; i < 5; ++i) desired_[i] += increments[i];
+
+    // Move the middle markers toward their desired positions, one step at a time
+    for (int i = 1; i <= 3; ++i) {
+        double d = desired_[i] - positions_[i];
+        if ((d >= 1.0 && positions_[i + 1] - positions_[i] > 1.0) ||
+            (d <= -1.0 && positions_[i - 1] - positions_[i] < -1.0)) {
+            const double s = d > 0.0 ? 1.0 : -1.0;
+            const double n_lo = positions_[i - 1], n = positions_[i], n_hi = positions_[i + 1];
+            const double q_lo = heights_[i - 1], q = heights_[i], q_hi = heights_[i + 1];
+            double parabolic = q + s / (n_hi - n_lo) *
+                ((n - n_lo + s) * (q_hi - q) / (n_hi - n) + (n_hi - n - s) * (q - q_lo) / (n - n_lo));
+            if (q_lo < parabolic && parabolic < q_hi) {
+                heights_[i] = parabolic;
+            } else {
+                const int j = i + static_cast<int>(s);
+                heights_[i] = q + s * (heights_[j] - q) / (positions_[j] - n);
+            }
+            positions_[i] += s;
+        }
+    }
+}
+
+double P2Quantile::value() const {
+    if (count_ == 0) return 0.0;
+    if (count_ <= 5) {
+        // Exact, linearly interpolated between order statistics
+        double sorted[5];
+        std::copy(heights_, heights_ + count_, sorted);
+        std::sort(sorted, sorted + count_);
+        double h = p_ * static_cast<double>(count_ - 1);
+        std::size_t lo = static_cast<std::size_t>(std::floor(h));
+        std::size_t hi = std::min<std::size_t>(lo + 1, count_ - 1);
+        return sorted[lo] + (h - static_cast<double>(lo)) * (sorted[hi] - sorted[lo]);
+    }
+    return heights_[2];
+}
+
+// ============================================================
+// Ensemble accumulator
+// ============================================================
+
+EnsembleAccumulator::EnsembleAccumulator(std::size_t columns, std::vector<double> quantile_levels)
+    : columns_(columns), levels_(std::move(quantile_levels)) {
+    for (double level : levels_) {
+        if (!(level > 0.0 && level < 1.0)) {
+            throw std::invalid_argument("ensemble quantile levels must lie in (0, 1)");
+        }
+    }
+}
+
+void EnsembleAccumulator::add(std::size_t row, uint64_t frame, double time, const double* values) {
+    while (rows_.size() <= row) {
+        Row r;
+        r.moments.resize(columns_);
+        r.quantiles.reserve(columns_ * levels_.size());
+        for (std::size_t c = 0; c < columns_; ++c) {
+            for (double level : levels_) r.quantiles.emplace_back(level);
+        }
+        rows_.push_back(std::move(r));
+    }
+
+    Row& r = rows_[row];
+    if (r.moments.empty() || r.moments[0].count == 0) {
+        r.frame = frame;
+        r.time = time;
+    }
+    for (std::size_t c = 0; c < columns_; ++c) {
+        r.moments[c].add(values[c]);
+        for (std::size_t q = 0; q < levels_.size(); ++q) {
+            r.quantiles[c * levels_.size() + q].add(values[c]);
+        }
+    }
+}
+
+uint64_t EnsembleAccumulator::runs(std::size_t row) const {
+    return columns_ > 0 ? rows_[row].moments[0].count : 0;
+}
+
+std::string quantile_label(double level) {
+    char buf[32];
+    double percent = level * 100.0;
+    if (std::fabs(percent - std::round(percent)) < 1e-9) {
+        std::snprintf(buf, sizeof(buf), "q%02d", static_cast<int>(std::round(percent)));
+    } else {
+        std::snprintf(buf, sizeof(buf), "q%g", percent);
+    }
+    return buf;
+}
+
+void write_ensemble_csv(const EnsembleAccumulator& acc, const char* const* column_names,
+                        std::ostream& out) {
+    const auto& levels = acc.quantile_levels();
+    out << "frame,time,runs";
+    for (std::size_t c = 0; c < acc.columns(); ++c) {
+        out << ',' << column_names[c] << "_mean," << column_names[c] << "_sd";
+        for (double level : levels) out << ',' << column_names[c] << '_' << quantile_label(level);
+    }
+    out << '\n';
+
+    for (std::size_t r = 0; r < acc.rows(); ++r) {
+        out << acc.frame(r) << ',' << format_sim_time(acc.time(r)) << ',' << acc.runs(r);
+        for (std::size_t c = 0; c < acc.columns(); ++c) {
+            const RunningMoments& m = acc.moments(r, c);
+            out << ',' << m.mean << ',' << std::sqrt(m.variance());
+            for (std::size_t q = 0; q < levels.size(); ++q) out << ',' << acc.quantile(r, c, q);
+        }
+        out << '\n';
+    }
+}
+
+// ============================================================
+// Reading aggregate curves back
+// ============================================================
+
+namespace {
+
+std::vector<std::string> split_csv_line(const std::string& line) {
+    std::vector<std::string> cells;
+    std::stringstream ss(line);
+    std::string cell;
+    while (std::getline(ss, cell, ',')) {
+        if (!cell.empty() && cell.back() == '\r') cell.pop_back();
+        cells.push_back(cell);
+    }
+    return cells;
+}
+
+// Where a CSV column lands in the summary
+struct ColumnSlot {
+    std::size_t series = 0;
+    int kind = 0;            // 0 = mean, 1 = sd, 2 = quantile
+    std::size_t level = 0;
+};
+
+} // namespace
+
+const EnsembleSeries* EnsembleSummary::find(const std::string& name) const {
+    for (const auto& s : series) {
+        if (s.name == name) return &s;
+    }
+    return nullptr;
+}
+
+EnsembleSummary read_ensemble_csv(std::istream& in) {
+    std::string line;
+    if (!std::getline(in, line)) throw std::runtime_error("ensemble CSV is empty");
+    const std::vector<std::string> header = split_csv_line(line);
+    if (header.size() < 3 || header[0] != "frame" || header[1] != "time" || header[2] != "runs") {
+        throw std::runtime_error("ensemble CSV: expected a frame,time,runs header");
+    }
+
+    EnsembleSummary summary;
+    std::vector<ColumnSlot> slots;
+    for (std::size_t i = 3; i < header.size(); ++i) {
+        const std::string& name = header[i];
+        const std::size_t us = name.rfind('_');
+        if (us == std::string::npos) throw std::runtime_error("ensemble CSV: bad column '" + name + "'");
+        const std::string base = name.substr(0, us);
+        const std::string suffix = name.substr(us + 1);
+
+        if (summary.series.empty() || summary.series.back().name != base) {
+            summary.series.push_back(EnsembleSeries{base, {}, {}, {}});
+        }
+        ColumnSlot slot;
+        slot.series = summary.series.size() - 1;
+        if (suffix == "mean") {
+            slot.kind = 0;
+        } else if (suffix == "sd") {
+            slot.kind = 1;
+        } else if (suffix.size() > 1 && suffix[0] == 'q') {
+            slot.kind = 2;
+            const double level = std::atof(suffix.c_str() + 1) / 100.0;
+            // Levels are listed in the same order for every series
+            auto& quantiles = summary.series.back().quantiles;
+            slot.level = quantiles.size();
+            quantiles.emplace_back();
+            if (slot.series == 0) summary.quantile_levels.push_back(level);
+        } else {
+            throw std::runtime_error("ensemble CSV: bad column '" + name + "'");
+        }
+        slots.push_back(slot);
+    }
+
+    while (std::getline(in, line)) {
+        if (line.empty() || line == "\r") continue;
+        const std::vector<std::string> cells = split_csv_line(line);
+        if (cells.size() != header.size()) {
+            throw std::runtime_error("ensemble CSV: row " + std::to_string(summary.rows() + 1) +
+                                     " has " + std::to_string(cells.size()) + " cells, expected " +
+                                     std::to_string(header.size()));
+        }
+        summary.frames.push_back(std::strtoull(cells[0].c_str(), nullptr, 10));
+        summary.times.push_back(std::atof(cells[1].c_str()));
+        for (std::size_t i = 0; i < slots.size(); ++i) {
+            const float v = static_cast<float>(std::atof(cells[i + 3].c_str()));
+            EnsembleSeries& s = summary.series[slots[i].series];
+            switch (slots[i].kind) {
+                case 0: s.mean.push_back(v); break;
+                case 1: s.sd.push_back(v); break;
+                default: s.quantiles[slots[i].level].push_back(v); break;
+            }
+        }
+    }
+    return summary;
+}
+
+EnsembleSummary read_ensemble_csv(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("Cannot open ensemble file: " + path);
+    return read_ensemble_csv(in);
+}
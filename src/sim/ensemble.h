@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// ============================================================
+// Monte-Carlo ensemble statistics — pure C++, no FLECS
+// ============================================================
+//
+// Runs of one config with different seeds are reduced on the fly: every
+// (sample, column) cell keeps Welford moments and P² quantile markers, so
+// memory is independent of the number of runs and no run is ever stored.
+
+// Welford's online mean and variance
+struct RunningMoments {
+    uint64_t count = 0;
+    double mean = 0.0;
+    double m2 = 0.0;   // sum of squared deviations from the mean
+
+    void add(double x) {
+        count++;
+        double delta = x - mean;
+        mean += delta / static_cast<double>(count);
+        m2 += delta * (x - mean);
+    }
+    // Sample variance (n - 1); 0 for fewer than two observations
+    double variance() const { return count > 1 ? m2 / static_cast<double>(count - 1) : 0.0; }
+};
+
+// P² streaming quantile estimator (Jain & Chlamtac, 1985): five markers whose
+// heights track the min, p/2, p, (1+p)/2 and max quantiles. Exact for the
+// first five observations, approximate afterwards.
+class P2Quantile {
+public:
+    explicit P2Quantile(double p = 0.5);
+
+    void add(double x);
+    double value() const;
+    uint64_t count() const { return count_; }
+    double level() const { return p_; }
+
+private:
+    double p_;
+    uint64_t count_ = 0;
+    double heights_[5] = {};
+    double positions_[5] = {};
+    double desired_[5] = {};
+};
+
+// Per-sample aggregate over any number of runs. Rows are sample indices
+// (shared by every run), columns are the recorded counters.
+class EnsembleAccumulator {
+public:
+    EnsembleAccumulator(std::size_t columns, std::vector<double> quantile_levels = {0.05, 0.5, 0.95});
+
+    // Adds one run's `columns()` values at sample `row`. Rows are created on
+    // demand; frame/time label the row and are taken from its first sample.
+    void add(std::size_t row, uint64_t frame, double time, const double* values);
+
+    std::size_t rows() const { return rows_.size(); }
+    std::size_t columns() const { return columns_; }
+    const std::vector<double>& quantile_levels() const { return levels_; }
+
+    uint64_t frame(std::size_t row) const { return rows_[row].frame; }
+    double time(std::size_t row) const { return rows_[row].time; }
+    uint64_t runs(std::size_t row) const;   // runs that reached this sample
+    const RunningMoments& moments(std::size_t row, std::size_t column) const {
+        return rows_[row].moments[column];
+    }
+    double quantile(std::size_t row, std::size_t column, std::size_t level) const {
+        return rows_[row].quantiles[column * levels_.size() + level].value();
+    }
+
+private:
+    struct Row {
+        uint64_t frame = 0;
+        double time = 0.0;
+        std::vector<RunningMoments> moments;   // [column]
+        std::vector<P2Quantile> quantiles;     // [column * levels + level]
+    };
+
+    std::size_t columns_;
+    std::vector<double> levels_;
+    std::vector<Row> rows_;
+};
+
+// Column suffix for a quantile level: 0.05 -> "q05", 0.5 -> "q50", 0.025 -> "q2.5"
+std::string quantile_label(double level);
+
+// CSV: frame,time,runs then <name>_mean,<name>_sd,<name>_q.. for each column
+void write_ensemble_csv(const EnsembleAccumulator& acc, const char* const* column_names,
+                        std::ostream& out);
+
+// Aggregate curves read back from write_ensemble_csv output (overlay bands)
+struct EnsembleSeries {
+    std::string name;
+    std::vector<float> mean;
+    std::vector<float> sd;
+    std::vector<std::vector<float>> quantiles;   // [level][row]
+};
+
+struct EnsembleSummary {
+    std::vector<uint64_t> frames;
+    std::vector<double> times;
+    std::vector<double> quantile_levels;
+    std::vector<EnsembleSeries> series;
+
+    std::size_t rows() const { return frames.size(); }
+    const EnsembleSeries* find(const std::string& name) const;
+};
+
+// Throws std::runtime_error on a malformed file
+EnsembleSummary read_ensemble_csv(std::istream& in);
+EnsembleSummary read_ensemble_csv(const std::string& path);
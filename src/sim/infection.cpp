@@ -1,6 +1,35 @@
 #include "infection.h"
+#include <cmath>
 
 bool try_infect(float p_infect, std::mt19937& rng) {
     std::uniform_real_distribution<float> dist(0.0f, 1.0f);
     return dist(rng) < p_infect;
 }
+
+bool try_infect(float p_infect, KeyedRng& rng) {
+    return rng.uniform() < p_infect;
+}
+
+float hazard_probability(float p_per_frame, float interval, float reference_fps) {
+    if (p_per_frame <= 0.0f || interval <= 0.0f) return 0.0f;
+    if (p_per_frame >= 1.0f) return 1.0f;
+    // -expm1(n * log1p(-p)) == 1 - (1 - p)^n, without cancellation for small p
+    double frames = static_cast<double>(interval) * reference_fps;
+    return static_cast<float>(-std::expm1(frames * std::log1p(-static_cast<double>(p_per_frame))));
+}
+
+float infection_phase(uint64_t entity_id) {
+    // splitmix64 finalizer — consecutive ids map to well-spread phases
+    uint64_t z = entity_id + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    return static_cast<float>(z >> 40) / static_cast<float>(1ull << 24);
+}
+
+int infection_ticks_due(float phase, double t_prev, double t_now, float tick_rate) {
+    if (tick_rate <= 0.0f || t_now <= t_prev) return 0;
+    double before = std::floor(t_prev * tick_rate - phase);
+    double after = std::floor(t_now * tick_rate - phase);
+    return static_cast<int>(after - before);
+}
@@ -1,9 +1,27 @@
 #pragma once
 
+#include <cstdint>
 #include <random>
+#include "rng.h"
 
 // Pure C++ infection logic — no FLECS includes
 
+// Frame rate at which the per-frame p_infect_* values are calibrated
+constexpr float INFECTION_REFERENCE_FPS = 60.0f;
+
 // Attempt infection with given probability
 // Returns true if infection succeeds
 bool try_infect(float p_infect, std::mt19937& rng);
+bool try_infect(float p_infect, KeyedRng& rng);
+
+// Convert a per-contact, per-frame probability (calibrated at reference_fps) into the
+// probability of at least one transmission over `interval` seconds, assuming a constant
+// per-second hazard: 1 - (1 - p)^(interval * reference_fps)
+float hazard_probability(float p_per_frame, float interval,
+                         float reference_fps = INFECTION_REFERENCE_FPS);
+
+// Deterministic per-boid phase in [0, 1) used to stagger infection ticks
+float infection_phase(uint64_t entity_id);
+
+// Number of infection ticks (at tick_rate Hz, offset by phase) that fall in (t_prev, t_now]
+int infection_ticks_due(float phase, double t_prev, double t_now, float tick_rate);
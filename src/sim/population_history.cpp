@@ -0,0 +1,169 @@
+#include "population_history.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+    HistoryBucket make_bucket(const PopulationHistoryPoint& p, uint64_t index) {
+        HistoryBucket b;
+        b.first_sample = index;
+        b.count = 1;
+        b.min = p;
+        b.max = p;
+        for (int s = 0; s < HISTORY_SERIES_COUNT; ++s) {
+            b.sum[s] = history_value(p, static_cast<HistorySeries>(s));
+        }
+        return b;
+    }
+
+    // `older` and `newer` must be adjacent in time
+    HistoryBucket merge(const HistoryBucket& older, const HistoryBucket& newer) {
+        HistoryBucket b;
+        b.first_sample = older.first_sample;
+        b.count = older.count + newer.count;
+        b.min.normal_alive = std::min(older.min.normal_alive, newer.min.normal_alive);
+        b.min.doctor_alive = std::min(older.min.doctor_alive, newer.min.doctor_alive);
+        b.min.antivax_alive = std::min(older.min.antivax_alive, newer.min.antivax_alive);
+        b.min.infected_count = std::min(older.min.infected_count, newer.min.infected_count);
+        b.max.normal_alive = std::max(older.max.normal_alive, newer.max.normal_alive);
+        b.max.doctor_alive = std::max(older.max.doctor_alive, newer.max.doctor_alive);
+        b.max.antivax_alive = std::max(older.max.antivax_alive, newer.max.antivax_alive);
+        b.max.infected_count = std::max(older.max.infected_count, newer.max.infected_count);
+        for (int s = 0; s < HISTORY_SERIES_COUNT; ++s) {
+            b.sum[s] = older.sum[s] + newer.sum[s];
+        }
+        return b;
+    }
+}
+
+int history_value(const PopulationHistoryPoint& p, HistorySeries series) {
+    switch (series) {
+        case HistorySeries::Normal:   return p.normal_alive;
+        case HistorySeries::Doctor:   return p.doctor_alive;
+        case HistorySeries::Antivax:  return p.antivax_alive;
+        case HistorySeries::Infected: return p.infected_count;
+    }
+    return 0;
+}
+
+PopulationHistory::PopulationHistory(std::size_t level_capacity)
+    : capacity_(std::max<std::size_t>(level_capacity, 2)) {
+    levels_.emplace_back();
+}
+
+void PopulationHistory::push(const PopulationHistoryPoint& sample) {
+    levels_[0].push_back(make_bucket(sample, total_));
+    total_++;
+
+    // Cascade: fold the two oldest buckets of an overfull level into the next one.
+    // Everything in level i+1 is older than level i, so the merged bucket is its newest.
+    for (std::size_t i = 0; i < levels_.size(); ++i) {
+        if (levels_[i].size() <= capacity_) break;
+        if (i + 1 == levels_.size()) levels_.emplace_back();
+
+        HistoryBucket older = levels_[i].front();
+        levels_[i].pop_front();
+        HistoryBucket newer = levels_[i].front();
+        levels_[i].pop_front();
+        levels_[i + 1].push_back(merge(older, newer));
+    }
+}
+
+void PopulationHistory::clear() {
+    levels_.clear();
+    levels_.emplace_back();
+    total_ = 0;
+}
+
+void PopulationHistory::restore(std::size_t level_capacity,
+                                std::vector<std::deque<HistoryBucket>> levels,
+                                uint64_t total_samples) {
+    level_capacity = std::max<std::size_t>(level_capacity, 2);
+    for (const auto& level : levels) {
+        if (level.size() > level_capacity) {
+            throw std::invalid_argument("population history level exceeds its capacity");
+        }
+    }
+    capacity_ = level_capacity;
+    levels_ = std::move(levels);
+    if (levels_.empty()) levels_.emplace_back();
+    total_ = total_samples;
+}
+
+std::size_t PopulationHistory::bucket_count() const {
+    std::size_t n = 0;
+    for (const auto& level : levels_) n += level.size();
+    return n;
+}
+
+PopulationHistoryPoint PopulationHistory::latest() const {
+    if (levels_[0].empty()) return {};
+    return levels_[0].back().max;  // raw bucket: min == max == sample
+}
+
+void PopulationHistory::buckets(std::vector<HistoryBucket>& out) const {
+    out.clear();
+    out.reserve(bucket_count());
+    for (std::size_t i = levels_.size(); i-- > 0;) {
+        out.insert(out.end(), levels_[i].begin(), levels_[i].end());
+    }
+}
+
+void lttb_indices(const std::vector<float>& xs, const std::vector<float>& ys,
+                  std::size_t threshold, std::vector<std::size_t>& out) {
+    out.clear();
+    const std::size_t n = std::min(xs.size(), ys.size());
+    if (threshold >= n) {
+        for (std::size_t i = 0; i < n; ++i) out.push_back(i);
+        return;
+    }
+    if (threshold < 3) {
+        // Too few points for a middle bucket: keep the endpoints only
+        if (threshold >= 1) out.push_back(0);
+        if (threshold >= 2) out.push_back(n - 1);
+        return;
+    }
+
+    // First and last point are fixed; the n-2 points between them are split
+    // into threshold-2 buckets and one point is picked from each
+    const double every = static_cast<double>(n - 2) / static_cast<double>(threshold - 2);
+    std::size_t a = 0;
+    out.push_back(a);
+
+    for (std::size_t b = 0; b < threshold - 2; ++b) {
+        // Average of the next bucket (third triangle vertex)
+        std::size_t next_start = static_cast<std::size_t>(std::floor((b + 1) * every)) + 1;
+        std::size_t next_end = std::min(static_cast<std::size_t>(std::floor((b + 2) * every)) + 1, n);
+        double avg_x = 0.0, avg_y = 0.0;
+        std::size_t next_len = next_end > next_start ? next_end - next_start : 0;
+        if (next_len == 0) {
+            avg_x = xs[n - 1];
+            avg_y = ys[n - 1];
+        } else {
+            for (std::size_t i = next_start; i < next_end; ++i) {
+                avg_x += xs[i];
+                avg_y += ys[i];
+            }
+            avg_x /= static_cast<double>(next_len);
+            avg_y /= static_cast<double>(next_len);
+        }
+
+        // Pick the point of this bucket forming the largest triangle
+        std::size_t start = static_cast<std::size_t>(std::floor(b * every)) + 1;
+        std::size_t end = static_cast<std::size_t>(std::floor((b + 1) * every)) + 1;
+        double best_area = -1.0;
+        std::size_t best = start;
+        for (std::size_t i = start; i < end && i < n - 1; ++i) {
+            double area = std::fabs((xs[a] - avg_x) * (ys[i] - ys[a]) -
+                                    (xs[a] - xs[i]) * (avg_y - ys[a]));
+            if (area > best_area) {
+                best_area = area;
+                best = i;
+            }
+        }
+        out.push_back(best);
+        a = best;
+    }
+
+    out.push_back(n - 1);
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "components.h"
+
+// Pure C++ population history — no FLECS includes
+//
+// Keeps the whole run at decreasing resolution. Level 0 holds the most recent
+// raw samples; when a level exceeds its capacity its two oldest buckets are
+// merged into one bucket of the next level. Level L buckets therefore span 2^L
+// samples, every level holds at most `level_capacity` buckets, and memory grows
+// with log2(T / level_capacity) for a run of T samples.
+
+// Series stored per sample, in PopulationHistoryPoint field order
+enum class HistorySeries : int { Normal = 0, Doctor = 1, Antivax = 2, Infected = 3 };
+constexpr int HISTORY_SERIES_COUNT = 4;
+
+int history_value(const PopulationHistoryPoint& p, HistorySeries series);
+
+// Min/max/mean aggregate over `count` consecutive samples
+struct HistoryBucket {
+    uint64_t first_sample = 0;               // index of the first sample covered
+    uint32_t count = 0;                      // number of samples covered
+    PopulationHistoryPoint min;
+    PopulationHistoryPoint max;
+    double sum[HISTORY_SERIES_COUNT] = {};
+
+    float mean(HistorySeries series) const {
+        return count ? static_cast<float>(sum[static_cast<int>(series)] / count) : 0.0f;
+    }
+    // Sample index at the bucket's centre (x coordinate for plotting)
+    double center() const { return static_cast<double>(first_sample) + 0.5 * (count - 1); }
+};
+
+class PopulationHistory {
+public:
+    explicit PopulationHistory(std::size_t level_capacity = 512);
+
+    void push(const PopulationHistoryPoint& sample);
+    void clear();
+
+    // Replaces the whole history (checkpoint restore). Throws
+    // std::invalid_argument if a level holds more than level_capacity buckets.
+    void restore(std::size_t level_capacity, std::vector<std::deque<HistoryBucket>> levels,
+                 uint64_t total_samples);
+    std::size_t level_capacity() const { return capacity_; }
+
+    // Total samples pushed since construction/clear()
+    uint64_t total_samples() const { return total_; }
+    std::size_t level_count() const { return levels_.size(); }
+    const std::deque<HistoryBucket>& level(std::size_t i) const { return levels_[i]; }
+
+    // Buckets stored across all levels
+    std::size_t bucket_count() const;
+
+    // Most recent raw sample (zeroed if empty)
+    PopulationHistoryPoint latest() const;
+
+    // Every stored bucket in time order (coarsest/oldest first); covers the
+    // full run without gaps or overlaps
+    void buckets(std::vector<HistoryBucket>& out) const;
+
+private:
+    std::size_t capacity_;
+    std::vector<std::deque<HistoryBucket>> levels_;
+    uint64_t total_ = 0;
+};
+
+// Largest-Triangle-Three-Buckets downsampling. Picks at most `threshold` indices
+// of (xs, ys) — always including the first and last point — that best preserve
+// the visual shape of the line. Returns all indices when threshold >= size.
+void lttb_indices(const std::vector<float>& xs, const std::vector<float>& ys,
+                  std::size_t threshold, std::vector<std::size_t>& out);
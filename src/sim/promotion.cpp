@@ -8,3 +8,11 @@ bool try_promote(float age, float t_adult, float p_become_doctor, std::mt19937&
     std::uniform_real_distribution<float> dist(0.0f, 1.0f);
     return dist(rng) < p_become_doctor;
 }
+
+bool try_promote(float age, float t_adult, float p_become_doctor, KeyedRng& rng) {
+    if (age < t_adult) {
+        return false;
+    }
+
+    return rng.uniform() < p_become_doctor;
+}
@@ -2,13 +2,30 @@
 #include <algorithm>
 #include <cmath>
 
-int offspring_count(float mean, float stddev, std::mt19937& rng) {
+namespace {
+
+template <typename Rng>
+int draw_offspring_count(float mean, float stddev, Rng& rng) {
     std::normal_distribution<float> dist(mean, stddev);
     float count = dist(rng);
     return std::max(0, static_cast<int>(std::round(count)));
 }
 
+} // namespace
+
+int offspring_count(float mean, float stddev, std::mt19937& rng) {
+    return draw_offspring_count(mean, stddev, rng);
+}
+
+int offspring_count(float mean, float stddev, KeyedRng& rng) {
+    return draw_offspring_count(mean, stddev, rng);
+}
+
 bool try_reproduce(float p_offspring, std::mt19937& rng) {
     std::uniform_real_distribution<float> dist(0.0f, 1.0f);
     return dist(rng) < p_offspring;
 }
+
+bool try_reproduce(float p_offspring, KeyedRng& rng) {
+    return rng.uniform() < p_offspring;
+}
@@ -1,10 +1,124 @@
 #pragma once
 
+#include <cstdint>
 #include <random>
 
-// Shared seeded random engine for all simulation logic
-// Using inline to ensure single instance across translation units
-inline std::mt19937& sim_rng() {
-    static std::mt19937 engine(42);  // Fixed seed for reproducibility
-    return engine;
+// Default seed of every simulation random stream (SimConfig::seed)
+constexpr uint32_t SIM_RNG_SEED = 42;
+
+// ============================================================
+// SimRng singleton — all random state of one world
+// ============================================================
+//
+// Owned by the world (set in init_world) rather than process-global, so any
+// number of worlds can be stepped concurrently on different threads, and a
+// world's results never depend on what else ran in the process. Every draw is
+// a KeyedRng stream keyed by a BoidId, so the only state besides the seed is
+// what makes initial ids unique.
+
+struct SimRng {
+    uint64_t seed;                  // keys every KeyedRng stream
+    uint64_t epoch = 0;             // bumped by reset_simulation: a reset re-rolls the population
+    uint64_t spawned[2] = {0, 0};   // initial-spawn ids handed out per cohort (0 = normal, 1 = doctor)
+
+    explicit SimRng(uint32_t s = SIM_RNG_SEED) : seed(s) {}
+};
+
+// ============================================================
+// Keyed random streams
+// ============================================================
+//
+// A KeyedRng is a small counter-based generator whose stream is fully
+// determined by (seed, frame, entity, purpose). Draws therefore do not depend
+// on iteration order or on which thread processes an entity, which lets the
+// interaction systems run in parallel and still produce identical results.
+//
+// The entity key is a BoidId, not a flecs id: BoidIds name "the same" boid in
+// every run with the same seed, even when a config change alters what else
+// happens. Two variants run with one seed therefore share their random
+// numbers (common random numbers), and their difference reflects the
+// parameter rather than the seed.
+
+enum class RngPurpose : uint32_t {
+    Infection = 1,
+    Cure      = 2,
+    Spawn     = 3,   // initial position, heading, sex, swarm, infection
+    Mating    = 4,   // per mating attempt (ordered pair): success, litter size, litter infection
+    Birth     = 5,   // per newborn: heading, sex
+    Promotion = 6,
+};
+
+// splitmix64 finalizer
+inline uint64_t mix64(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+class KeyedRng {
+public:
+    using result_type = uint32_t;
+
+    KeyedRng(uint64_t seed, uint64_t frame, uint64_t entity, RngPurpose purpose) {
+        state_ = mix64(seed + 0x9E3779B97F4A7C15ull);
+        state_ = mix64(state_ ^ frame);
+        state_ = mix64(state_ ^ entity);
+        state_ = mix64(state_ ^ static_cast<uint64_t>(purpose));
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT32_MAX; }
+
+    result_type operator()() { return static_cast<result_type>(next() >> 32); }
+
+    // Uniform float in [0, 1) from the top 24 bits
+    float uniform() { return static_cast<float>(next() >> 40) * (1.0f / 16777216.0f); }
+
+private:
+    uint64_t next() {
+        state_ += 0x9E3779B97F4A7C15ull;
+        return mix64(state_);
+    }
+
+    uint64_t state_ = 0;
+};
+
+// ============================================================
+// Stable boid ids and pair draws
+// ============================================================
+
+// Id of the index-th boid of an initial-spawn cohort
+inline uint64_t root_boid_uid(uint64_t epoch, uint32_t cohort, uint64_t index) {
+    return mix64(mix64(epoch * 0x9E3779B97F4A7C15ull + cohort + 1) ^ index);
+}
+
+// Order-independent key of two boids (either may be the iterated one)
+inline uint64_t boid_pair_key(uint64_t a, uint64_t b) {
+    return a < b ? mix64(a ^ mix64(b)) : mix64(b ^ mix64(a));
+}
+
+// Key of the ordered pair (actor, partner). Both sexes iterate, so a pair gets
+// two attempts per frame, one from each side, each with its own draw
+inline uint64_t boid_attempt_key(uint64_t actor, uint64_t partner) {
+    return mix64(actor ^ mix64(partner * 0x9E3779B97F4A7C15ull));
+}
+
+// Id of the n-th newborn of a mating, which happens at most once per pair and frame
+inline uint64_t child_boid_uid(uint64_t pair_key, uint64_t frame, uint32_t n) {
+    return mix64(pair_key ^ mix64(frame * 0x9E3779B97F4A7C15ull + n));
+}
+
+// Per-frame key for pair draws; hoisted out of the pair loops
+inline uint64_t pair_stream_key(uint64_t seed, uint64_t frame, RngPurpose purpose) {
+    return mix64(mix64(mix64(seed + 0x9E3779B97F4A7C15ull) ^ frame) ^ static_cast<uint64_t>(purpose));
+}
+
+// Uniform float in [0, 1) for the ordered pair (actor, target). BoidIds are
+// already well mixed, so one finalizer per pair suffices. On a given frame the
+// same pair gets the same number whichever side of it a system iterates;
+// systems that skip frames must gate the pair on one side (InfectionSystem
+// uses the spreader's tick) so both directions roll on the same frames.
+inline float pair_uniform(uint64_t stream_key, uint64_t actor, uint64_t target) {
+    uint64_t z = mix64(stream_key ^ actor ^ (target * 0x9E3779B97F4A7C15ull));
+    return static_cast<float>(z >> 40) * (1.0f / 16777216.0f);
 }
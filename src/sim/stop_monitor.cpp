@@ -0,0 +1,85 @@
+#include "stop_monitor.h"
+
+const char* stop_reason_name(StopReason reason) {
+    switch (reason) {
+        case StopReason::None:           return "none";
+        case StopReason::FrameLimit:     return "frame_limit";
+        case StopReason::TimeLimit:      return "time_limit";
+        case StopReason::Extinct:        return "extinct";
+        case StopReason::NormalExtinct:  return "normal_extinct";
+        case StopReason::DoctorExtinct:  return "doctor_extinct";
+        case StopReason::AntivaxExtinct: return "antivax_extinct";
+        case StopReason::InfectionOver:  return "infection_over";
+        case StopReason::SteadyState:    return "steady_state";
+    }
+    return "unknown";
+}
+
+StopConditions stop_conditions_from(const SimConfig& config) {
+    StopConditions c;
+    c.normal_extinct = config.stop_on_normal_extinct;
+    c.doctor_extinct = config.stop_on_doctor_extinct;
+    c.antivax_extinct = config.stop_on_antivax_extinct;
+    c.no_infected_seconds = config.stop_no_infected_seconds;
+    c.steady_window = config.stop_steady_window;
+    c.steady_variance = config.stop_steady_variance;
+    return c;
+}
+
+StopMonitor::StopMonitor(const StopConditions& conditions) : cond_(conditions) {}
+
+StopReason StopMonitor::update(double time, const SimStats& stats) {
+    if (first_time_ < 0.0) first_time_ = time;
+
+    // Class extinction
+    const int alive[3] = {stats.normal_alive, stats.doctor_alive, stats.antivax_alive};
+    const bool enabled[3] = {cond_.normal_extinct, cond_.doctor_extinct, cond_.antivax_extinct};
+    const StopReason reasons[3] = {StopReason::NormalExtinct, StopReason::DoctorExtinct,
+                                   StopReason::AntivaxExtinct};
+    for (int c = 0; c < 3; ++c) {
+        if (alive[c] > 0) {
+            seen_[c] = true;
+        } else if (enabled[c] && seen_[c]) {
+            return reasons[c];
+        }
+    }
+
+    // Epidemic over: no infected boid for a continuous stretch
+    if (cond_.no_infected_seconds > 0.0) {
+        if (stats.infected_alive > 0) {
+            infection_free_ = false;
+        } else {
+            if (!infection_free_) {
+                infection_free_ = true;
+                infection_free_since_ = time;
+            }
+            if (time - infection_free_since_ >= cond_.no_infected_seconds) {
+                return StopReason::InfectionOver;
+            }
+        }
+    }
+
+    // Steady state: variance of the alive count over a sliding window. Counts
+    // are integers, so the running sums stay exact in double precision.
+    if (cond_.steady_window > 0.0) {
+        const double total = static_cast<double>(stats.normal_alive + stats.doctor_alive +
+                                                 stats.antivax_alive);
+        window_.push_back({time, total});
+        sum_ += total;
+        sum_sq_ += total * total;
+        while (window_.front().time < time - cond_.steady_window) {
+            sum_ -= window_.front().alive;
+            sum_sq_ -= window_.front().alive * window_.front().alive;
+            window_.pop_front();
+        }
+        // Only judge once the run has covered a full window
+        if (time - first_time_ >= cond_.steady_window) {
+            const double n = static_cast<double>(window_.size());
+            const double mean = sum_ / n;
+            const double variance = sum_sq_ / n - mean * mean;
+            if (variance < cond_.steady_variance) return StopReason::SteadyState;
+        }
+    }
+
+    return StopReason::None;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include "components.h"
+
+// ============================================================
+// Early termination for batch runs — pure C++, no FLECS
+// ============================================================
+//
+// Decides from SimStats alone whether a run is already decided: a boid class
+// died out, the epidemic has been over for a while, or the population has
+// settled. Evaluated once per frame; O(1) amortized per call.
+
+enum class StopReason {
+    None = 0,
+    FrameLimit,
+    TimeLimit,
+    Extinct,          // every boid is dead
+    NormalExtinct,
+    DoctorExtinct,
+    AntivaxExtinct,
+    InfectionOver,    // no infected boid for stop_no_infected_seconds
+    SteadyState,      // alive-count variance below stop_steady_variance over the window
+};
+
+// Short snake_case name for logs and CSV columns ("none", "frame_limit", ...)
+const char* stop_reason_name(StopReason reason);
+
+// The stop_* keys of SimConfig; all off by default
+struct StopConditions {
+    bool normal_extinct = false;
+    bool doctor_extinct = false;
+    bool antivax_extinct = false;
+    double no_infected_seconds = 0.0;   // 0 = off
+    double steady_window = 0.0;         // seconds; 0 = off
+    double steady_variance = 0.0;       // boids^2
+
+    bool any() const {
+        return normal_extinct || doctor_extinct || antivax_extinct ||
+               no_infected_seconds > 0.0 || steady_window > 0.0;
+    }
+};
+
+StopConditions stop_conditions_from(const SimConfig& config);
+
+class StopMonitor {
+public:
+    explicit StopMonitor(const StopConditions& conditions);
+
+    // Feeds the stats at the end of a frame, `time` seconds into the run.
+    // Returns the first condition that holds, or StopReason::None. A class
+    // only counts as extinct once it has been seen alive, so configs that
+    // never spawn it do not stop at frame one.
+    StopReason update(double time, const SimStats& stats);
+
+private:
+    struct Sample {
+        double time;
+        double alive;
+    };
+
+    StopConditions cond_;
+    bool seen_[3] = {false, false, false};   // normal, doctor, antivax
+    bool infection_free_ = false;
+    double infection_free_since_ = 0.0;
+    double first_time_ = -1.0;
+    std::deque<Sample> window_;
+    double sum_ = 0.0;
+    double sum_sq_ = 0.0;
+};
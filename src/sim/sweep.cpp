@@ -0,0 +1,145 @@
+#include "sweep.h"
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+double parse_number(const std::string& text, const std::string& spec) {
+    try {
+        std::size_t used = 0;
+        double v = std::stod(text, &used);
+        if (used != text.size()) throw std::invalid_argument(text);
+        return v;
+    } catch (const std::exception&) {
+        throw std::runtime_error("sweep parameter '" + spec + "': cannot parse '" + text + "' as a number");
+    }
+}
+
+std::vector<std::string> split(const std::string& s, char sep) {
+    std::vector<std::string> parts;
+    std::stringstream ss(s);
+    std::string part;
+    while (std::getline(ss, part, sep)) parts.push_back(part);
+    return parts;
+}
+
+// Values taken by a parameter in a grid design
+std::vector<double> grid_levels(const SweepParam& p) {
+    if (!p.values.empty()) return p.values;
+    std::vector<double> levels(p.levels);
+    for (std::size_t i = 0; i < p.levels; ++i) {
+        levels[i] = (p.levels == 1) ? p.lo : p.lo + (p.hi - p.lo) * static_cast<double>(i) / (p.levels - 1);
+    }
+    return levels;
+}
+
+} // namespace
+
+SweepParam parse_sweep_param(const std::string& spec) {
+    const auto eq = spec.find('=');
+    if (eq == std::string::npos || eq == 0 || eq + 1 == spec.size()) {
+        throw std::runtime_error("sweep parameter '" + spec + "': expected key=lo:hi:levels or key=v1,v2,...");
+    }
+
+    SweepParam p;
+    p.key = spec.substr(0, eq);
+    const std::string rhs = spec.substr(eq + 1);
+
+    if (rhs.find(':') != std::string::npos) {
+        const auto parts = split(rhs, ':');
+        if (parts.size() != 3) {
+            throw std::runtime_error("sweep parameter '" + spec + "': range must be lo:hi:levels");
+        }
+        p.lo = parse_number(parts[0], spec);
+        p.hi = parse_number(parts[1], spec);
+        const double levels = parse_number(parts[2], spec);
+        if (levels < 1.0 || levels != static_cast<double>(static_cast<std::size_t>(levels))) {
+            throw std::runtime_error("sweep parameter '" + spec + "': levels must be a positive integer");
+        }
+        p.levels = static_cast<std::size_t>(levels);
+    } else {
+        for (const auto& v : split(rhs, ',')) p.values.push_back(parse_number(v, spec));
+        if (p.values.empty()) {
+            throw std::runtime_error("sweep parameter '" + spec + "': empty value list");
+        }
+    }
+    return p;
+}
+
+std::vector<std::vector<double>> build_sweep_design(const std::vector<SweepParam>& params,
+                                                    SweepDesign design,
+                                                    std::size_t samples,
+                                                    uint64_t seed) {
+    std::vector<std::vector<double>> points;
+    if (params.empty()) return points;
+
+    if (design == SweepDesign::Grid) {
+        std::vector<std::vector<double>> levels;
+        std::size_t total = 1;
+        for (const auto& p : params) {
+            levels.push_back(grid_levels(p));
+            total *= levels.back().size();
+        }
+        points.reserve(total);
+        std::vector<std::size_t> digit(params.size(), 0);
+        for (std::size_t n = 0; n < total; ++n) {
+            std::vector<double> row(params.size());
+            for (std::size_t k = 0; k < params.size(); ++k) row[k] = levels[k][digit[k]];
+            points.push_back(std::move(row));
+            // Odometer increment, last parameter fastest
+            for (std::size_t k = params.size(); k-- > 0;) {
+                if (++digit[k] < levels[k].size()) break;
+                digit[k] = 0;
+            }
+        }
+        return points;
+    }
+
+    // Latin hypercube: each column is an independent permutation of strata
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    points.assign(samples, std::vector<double>(params.size()));
+    std::vector<std::size_t> strata(samples);
+    for (std::size_t k = 0; k < params.size(); ++k) {
+        const SweepParam& p = params[k];
+        std::iota(strata.begin(), strata.end(), 0);
+        std::shuffle(strata.begin(), strata.end(), rng);
+        for (std::size_t i = 0; i < samples; ++i) {
+            const double u = (static_cast<double>(strata[i]) + unit(rng)) / static_cast<double>(samples);
+            if (p.values.empty()) {
+                points[i][k] = p.lo + (p.hi - p.lo) * u;
+            } else {
+                std::size_t idx = static_cast<std::size_t>(u * static_cast<double>(p.values.size()));
+                points[i][k] = p.values[std::min(idx, p.values.size() - 1)];
+            }
+        }
+    }
+    return points;
+}
+
+std::vector<std::vector<double>> add_seed_replicates(const std::vector<std::vector<double>>& design,
+                                                     std::size_t replicates,
+                                                     int64_t first_seed,
+                                                     bool common_random_numbers) {
+    std::vector<std::vector<double>> rows;
+    rows.reserve(design.size() * replicates);
+    for (std::size_t point = 0; point < design.size(); ++point) {
+        for (std::size_t r = 0; r < replicates; ++r) {
+            const std::size_t offset = common_random_numbers ? r : point * replicates + r;
+            std::vector<double> row = design[point];
+            row.push_back(static_cast<double>(first_seed + static_cast<int64_t>(offset)));
+            rows.push_back(std::move(row));
+        }
+    }
+    return rows;
+}
+
+std::string format_sweep_value(double value) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.9g", value);
+    return buf;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ============================================================
+// Parameter sweep designs over config.ini keys
+// ============================================================
+
+enum class SweepDesign {
+    Grid,            // Cartesian product of every parameter's levels
+    LatinHypercube,  // `samples` points, each parameter stratified into `samples` bins
+};
+
+struct SweepParam {
+    std::string key;             // config.ini key
+    double lo = 0.0, hi = 0.0;   // range form: key=lo:hi:levels
+    std::size_t levels = 0;      // grid levels for the range form
+    std::vector<double> values;  // list form: key=v1,v2,... (empty for the range form)
+};
+
+// Parses "key=lo:hi:levels" or "key=v1,v2,...". Throws std::runtime_error.
+SweepParam parse_sweep_param(const std::string& spec);
+
+// Builds the design: one row per point, one column per parameter (in order).
+// Grid varies the last parameter fastest and ignores `samples`. Latin
+// hypercube draws uniformly within each stratum of a range parameter and
+// picks stratified entries of a list parameter; it is deterministic in `seed`.
+std::vector<std::vector<double>> build_sweep_design(const std::vector<SweepParam>& params,
+                                                    SweepDesign design,
+                                                    std::size_t samples,
+                                                    uint64_t seed);
+
+// Repeats every design point `replicates` times (point-major) and appends a
+// seed column. With common random numbers, replicate r of every point uses
+// seed first_seed + r, so points differ only in their parameters and paired
+// differences between them cancel most run-to-run noise. Otherwise each row
+// gets its own seed, first_seed + point * replicates + r.
+std::vector<std::vector<double>> add_seed_replicates(const std::vector<std::vector<double>>& design,
+                                                     std::size_t replicates,
+                                                     int64_t first_seed,
+                                                     bool common_random_numbers);
+
+// Formats a design value for set_config_value (integers print without a fraction)
+std::string format_sweep_value(double value);
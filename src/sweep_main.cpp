@@ -0,0 +1,145 @@
+#include "ecs/sweep_runner.h"
+#include "config_loader.h"
+#include "components.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// ============================================================
+// Parallel parameter sweep: one headless world per design point
+// ============================================================
+
+static void print_usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0 << " [base.ini] --param <spec> [--param <spec> ...] [options]\n"
+              << "  --param key=lo:hi:levels | key=v1,v2,...   swept config.ini key\n"
+              << "  --lhs N          Latin hypercube with N points (default: full grid)\n"
+              << "  --seed S         Latin hypercube seed (default 1)\n"
+              << "  --replicates R   run every point with R simulation seeds (adds a seed column)\n"
+              << "  --independent    give every replicate its own seed instead of sharing\n"
+              << "                   seeds across points (common random numbers)\n"
+              << "  --threads T      worker threads (default 0 = all cores)\n"
+              << "  --burn-in-cache <dir>  reuse burn-in snapshots (config burn_in_seconds)\n"
+              << "  --frames N       frames per run (default 3600)\n"
+              << "  --seconds T      simulated seconds per run (instead of --frames)\n"
+              << "  --dt S           fixed time step (default 1/60)\n"
+              << "  --out <file>     results CSV (default sweep_results.csv)\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string config_path = "config.ini";
+    std::string out_path = "sweep_results.csv";
+    std::vector<std::string> specs;
+    SweepDesign design = SweepDesign::Grid;
+    std::size_t samples = 0;
+    uint64_t seed = 1;
+    std::size_t replicates = 0;
+    bool common_random_numbers = true;
+    unsigned threads = 0;
+    HeadlessOptions options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--param" && has_value) {
+            specs.push_back(argv[++i]);
+        } else if (arg == "--lhs" && has_value) {
+            design = SweepDesign::LatinHypercube;
+            samples = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--seed" && has_value) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--replicates" && has_value) {
+            replicates = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--independent") {
+            common_random_numbers = false;
+        } else if (arg == "--burn-in-cache" && has_value) {
+            options.burn_in_cache = argv[++i];
+        } else if (arg == "--threads" && has_value) {
+            threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--frames" && has_value) {
+            options.max_frames = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--seconds" && has_value) {
+            options.max_time = std::atof(argv[++i]);
+            options.max_frames = 0;
+        } else if (arg == "--dt" && has_value) {
+            options.dt = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--out" && has_value) {
+            out_path = argv[++i];
+        } else if (arg == "--help" || arg == "-h") {
+            print_usage(argv[0]);
+            return 0;
+        } else if (!arg.empty() && arg[0] == '-') {
+            print_usage(argv[0]);
+            return 2;
+        } else {
+            config_path = arg;
+        }
+    }
+    if (specs.empty() || options.dt <= 0.0f ||
+        (design == SweepDesign::LatinHypercube && samples == 0)) {
+        print_usage(argv[0]);
+        return 2;
+    }
+
+    SimConfig base{};
+    std::vector<SweepParam> params;
+    try {
+        load_config(config_path, base);
+        for (const auto& spec : specs) {
+            params.push_back(parse_sweep_param(spec));
+            // Reject typos before spending compute on them
+            SimConfig probe = base;
+            if (!set_config_value(probe, params.back().key, "0")) {
+                throw std::runtime_error("unknown config key '" + params.back().key + "'");
+            }
+            if (replicates > 0 && params.back().key == "seed") {
+                throw std::runtime_error("--replicates sets the seed; do not also sweep it");
+            }
+        }
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    auto points = build_sweep_design(params, design, samples, seed);
+    if (replicates > 0) {
+        points = add_seed_replicates(points, replicates, base.seed, common_random_numbers);
+        SweepParam seed_param;
+        seed_param.key = "seed";
+        params.push_back(seed_param);
+    }
+
+    std::ofstream out(out_path);
+    if (!out) {
+        std::cerr << "Cannot open output file: " << out_path << "\n";
+        return 1;
+    }
+    write_sweep_csv_header(params, out);
+
+    std::cerr << "Sweeping " << points.size() << " points -> " << out_path << "\n";
+    const auto start = std::chrono::steady_clock::now();
+    std::size_t done = 0, failed = 0;
+    double sim_seconds = 0.0;
+
+    run_sweep(base, params, points, options, threads, [&](const SweepPointResult& point) {
+        write_sweep_csv_row(point, out);
+        done++;
+        sim_seconds += point.result.sim_time;
+        if (!point.error.empty()) {
+            failed++;
+            std::cerr << "point " << point.index << ": " << point.error << "\n";
+        }
+        if (done % 100 == 0 || done == points.size()) {
+            out.flush();
+            std::cerr << "  " << done << "/" << points.size() << "\n";
+        }
+    });
+
+    const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "Done: " << done << " points (" << failed << " failed), " << sim_seconds
+              << " simulated s in " << wall << " s wall\n";
+    return failed == 0 ? 0 : 1;
+}
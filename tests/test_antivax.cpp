@@ -5,6 +5,7 @@
 #include "ecs/systems.h"
 #include "ecs/stats.h"
 #include "ecs/spawn.h"
+#include "sim/rng.h"
 
 // Helper: register all component types needed for antivax tests
 static void register_components(flecs::world& world) {
@@ -28,6 +29,7 @@ static void register_components(flecs::world& world) {
 static void set_singletons(flecs::world& world, SimConfig config = SimConfig{}) {
     world.set<SimConfig>(config);
     world.set<SimStats>({});
+    world.set(SimRng{});
     SpatialGrid grid(1920.0f, 1080.0f, 40.0f);
     world.set<SpatialGrid>(std::move(grid));
 }
@@ -311,6 +313,47 @@ TEST(AntivaxReproduction, NoCrossSwarm) {
         << "No offspring should be produced between AntivaxBoid and NormalBoid (cross-swarm prevented)";
 }
 
+// Partners are filtered from grid flags built before the frame's matings; a boid
+// that already mated this frame must still be rejected as a partner.
+TEST(AntivaxReproduction, PartnerMatesOncePerFrame) {
+    flecs::world world;
+    register_components(world);
+
+    SimConfig config{};
+    config.p_offspring_normal = 1.0f;
+    config.offspring_mean_normal = 3.0f;
+    config.offspring_stddev_normal = 0.0f;
+    config.reproduction_cooldown = 60.0f;
+    set_singletons(world, config);
+
+    auto make_parent = [&](float x, bool male) {
+        auto e = world.entity()
+            .add<AntivaxBoid>()
+            .add<Alive>()
+            .set(Position{x, 500.0f})
+            .set(Velocity{0.0f, 0.0f})
+            .set(Heading{0.0f})
+            .set(Health{0.0f, 60.0f})
+            .set(InfectionState{0.0f, 5.0f})
+            .set(ReproductionCooldown{0.0f});
+        if (male) e.add<Male>(); else e.add<Female>();
+        return e;
+    };
+    make_parent(500.0f, true);
+    make_parent(505.0f, false);
+    make_parent(495.0f, false);
+
+    register_rebuild_grid_system(world);
+    register_reproduction_system(world);
+    world.progress(1.0f / 60.0f);
+
+    int total_count = 0;
+    world.query<const Position>().each([&](flecs::entity, const Position&) {
+        total_count++;
+    });
+    EXPECT_EQ(total_count, 6) << "The single male may mate only once per frame (3 parents + 3 offspring)";
+}
+
 // ============================================================
 // B5: Doctor Cures Antivax
 // ============================================================
@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+#include <flecs.h>
+#include "components.h"
+#include "ecs/world.h"
+#include "ecs/systems.h"
+#include "ecs/spawn.h"
+#include "ecs/stats.h"
+#include "ecs/burn_in.h"
+#include "io/burn_in_cache.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// ------------------------------------------------------------
+// Cache keys and files
+// ------------------------------------------------------------
+
+TEST(BurnInKey, IgnoresEpidemicParametersOnly) {
+    SimConfig base{};
+    base.burn_in_seconds = 10.0f;
+    const uint64_t key = burn_in_key(base, 1.0f / 60.0f);
+
+    SimConfig epidemic = base;
+    epidemic.p_infect_normal = 0.9f;
+    epidemic.p_cure = 0.1f;
+    epidemic.p_initial_infect_normal = 0.5f;
+    epidemic.t_death = 12.0f;
+    epidemic.sim_threads = 3;
+    EXPECT_EQ(burn_in_key(epidemic, 1.0f / 60.0f), key);
+
+    SimConfig moved = base;
+    moved.max_speed += 1.0f;
+    EXPECT_NE(burn_in_key(moved, 1.0f / 60.0f), key);
+    SimConfig reseeded = base;
+    reseeded.seed += 1;
+    EXPECT_NE(burn_in_key(reseeded, 1.0f / 60.0f), key);
+    SimConfig larger = base;
+    larger.initial_normal_count += 1;
+    EXPECT_NE(burn_in_key(larger, 1.0f / 60.0f), key);
+    SimConfig longer = base;
+    longer.burn_in_seconds = 20.0f;
+    EXPECT_NE(burn_in_key(longer, 1.0f / 60.0f), key);
+    EXPECT_NE(burn_in_key(base, 1.0f / 30.0f), key);
+
+    EXPECT_EQ(burn_in_path("cache", 0xABCull), "cache/burnin_0000000000000abc.bin");
+    EXPECT_EQ(burn_in_path("", 1), "burnin_0000000000000001.bin");
+}
+
+TEST(BurnInFile, RoundTripsAndRejectsOtherKeys) {
+    const std::string path = burn_in_path("", 0x5EED);
+    std::vector<BurnInBoid> boids(3);
+    for (std::size_t i = 0; i < boids.size(); ++i) {
+        boids[i].uid = 10 + i;
+        boids[i].position = {1.5f * i, 2.0f};
+        boids[i].velocity = {-3.0f, 0.25f * i};
+        boids[i].heading = {0.1f * i};
+    }
+    ASSERT_TRUE(write_burn_in(path, 0x5EED, boids));
+
+    std::vector<BurnInBoid> loaded;
+    ASSERT_TRUE(read_burn_in(path, 0x5EED, loaded));
+    ASSERT_EQ(loaded.size(), boids.size());
+    EXPECT_EQ(std::memcmp(loaded.data(), boids.data(), boids.size() * sizeof(BurnInBoid)), 0);
+
+    EXPECT_FALSE(read_burn_in(path, 0x5EEE, loaded));
+    EXPECT_TRUE(loaded.empty());
+    EXPECT_FALSE(read_burn_in("no_such_burn_in.bin", 0x5EED, loaded));
+
+    // A truncated file is a miss, not a crash
+    std::string bytes;
+    {
+        std::ifstream in(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    std::ofstream(path, std::ios::binary).write(bytes.data(), static_cast<std::streamsize>(bytes.size() - 4));
+    EXPECT_FALSE(read_burn_in(path, 0x5EED, loaded));
+    std::remove(path.c_str());
+}
+
+// ------------------------------------------------------------
+// Settled spawns
+// ------------------------------------------------------------
+
+namespace {
+
+using Kinematics = std::vector<std::tuple<uint64_t, float, float, float, float, bool>>;
+
+Kinematics spawn_settled(const SimConfig& config, BurnInSource& source, const std::string& dir = "") {
+    flecs::world world;
+    init_world(world, config);
+    register_all_systems(world);
+    register_stats_system(world);
+    source = spawn_settled_population(world, 1.0f / 60.0f, dir);
+    EXPECT_EQ(world.get<SimClock>().frame, 0u);
+
+    Kinematics out;
+    world.each([&](flecs::entity e, const BoidId& id, const Position& p, const Velocity& v) {
+        out.emplace_back(id.value, p.x, p.y, v.vx, v.vy, e.has<Infected>());
+    });
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+SimConfig burn_in_config(int seed) {
+    SimConfig config{};
+    config.initial_normal_count = 60;
+    config.initial_doctor_count = 5;
+    config.sim_threads = 1;
+    config.seed = seed;
+    config.burn_in_seconds = 1.0f;
+    return config;
+}
+
+} // namespace
+
+TEST(BurnIn, SettledFlockDoesNotDependOnEpidemicParameters) {
+    SimConfig config = burn_in_config(9101);
+    config.p_initial_infect_normal = 0.0f;
+
+    BurnInSource source;
+    const Kinematics first = spawn_settled(config, source);
+    EXPECT_EQ(source, BurnInSource::Simulated);
+
+    SimConfig epidemic = config;
+    epidemic.p_initial_infect_normal = 0.5f;
+    epidemic.p_cure = 0.0f;
+    // Finished snapshots are not kept in memory; without a cache directory
+    // the next run settles the same flock again
+    const Kinematics second = spawn_settled(epidemic, source);
+    EXPECT_EQ(source, BurnInSource::Simulated);
+
+    // Same settled flock; only the infection draws differ
+    ASSERT_EQ(first.size(), second.size());
+    int infected = 0;
+    for (std::size_t i = 0; i < first.size(); ++i) {
+        EXPECT_EQ(std::get<0>(first[i]), std::get<0>(second[i]));
+        EXPECT_EQ(std::get<1>(first[i]), std::get<1>(second[i]));
+        EXPECT_EQ(std::get<4>(first[i]), std::get<4>(second[i]));
+        infected += std::get<5>(second[i]);
+    }
+    EXPECT_GT(infected, 0);
+
+    // The flock has moved away from the plain spawn
+    SimConfig plain = config;
+    plain.burn_in_seconds = 0.0f;
+    const Kinematics unsettled = spawn_settled(plain, source);
+    EXPECT_EQ(source, BurnInSource::None);
+    EXPECT_NE(first, unsettled);
+}
+
+TEST(BurnIn, CachedSnapshotMatchesSimulatedOne) {
+    const std::string dir = ".";
+    SimConfig config = burn_in_config(9102);
+    const std::string path = burn_in_path(dir, burn_in_key(config, 1.0f / 60.0f));
+    std::remove(path.c_str());
+
+    BurnInSource source;
+    const Kinematics simulated = spawn_settled(config, source, dir);
+    EXPECT_EQ(source, BurnInSource::Simulated);
+
+    // Another process would find only the file
+    std::vector<BurnInBoid> boids;
+    ASSERT_TRUE(read_burn_in(path, burn_in_key(config, 1.0f / 60.0f), boids));
+    EXPECT_EQ(boids.size(), simulated.size());
+
+    // A file for a key this process has not seen is used as is. BoidIds do not
+    // depend on the seed, so a planted snapshot of another seed fits
+    SimConfig planted = burn_in_config(9103);
+    const uint64_t planted_key = burn_in_key(planted, 1.0f / 60.0f);
+    const std::string planted_path = burn_in_path(dir, planted_key);
+    ASSERT_TRUE(write_burn_in(planted_path, planted_key, boids));
+    const Kinematics from_file = spawn_settled(planted, source, dir);
+    EXPECT_EQ(source, BurnInSource::File);
+    ASSERT_EQ(from_file.size(), simulated.size());
+    for (std::size_t i = 0; i < simulated.size(); ++i) {
+        EXPECT_EQ(std::get<1>(from_file[i]), std::get<1>(simulated[i]));
+        EXPECT_EQ(std::get<3>(from_file[i]), std::get<3>(simulated[i]));
+    }
+    std::remove(planted_path.c_str());
+
+    // Later runs in this process reuse the file too
+    const Kinematics again = spawn_settled(config, source, dir);
+    EXPECT_EQ(source, BurnInSource::File);
+    EXPECT_EQ(again, simulated);
+    std::remove(path.c_str());
+}
@@ -0,0 +1,293 @@
+#include <gtest/gtest.h>
+#include <flecs.h>
+#include "components.h"
+#include "ecs/world.h"
+#include "ecs/systems.h"
+#include "ecs/spawn.h"
+#include "ecs/stats.h"
+#include "ecs/runner.h"
+#include "ecs/checkpoint.h"
+#include "io/checkpoint.h"
+#include "sim/population_history.h"
+#include "sim/rng.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Checkpoint image in 8-byte aligned storage, as a mapping would provide
+static std::vector<uint64_t> aligned_image(const std::string& bytes) {
+    std::vector<uint64_t> image((bytes.size() + 7) / 8);
+    std::memcpy(image.data(), bytes.data(), bytes.size());
+    return image;
+}
+
+TEST(CheckpointFormat, RoundTripsColumnsAndGlobals) {
+    CheckpointGlobals globals;
+    globals.config.p_cure = 0.125f;
+    globals.config.seed = 99;
+    globals.stats.normal_alive = 3;
+    globals.stats.dead_total = 17;
+    globals.clock = SimClock{12.5, 750};
+    globals.rng_seed = 99;
+    globals.rng_epoch = 2;
+    globals.rng_spawned[0] = 3;
+    globals.history_capacity = 4;
+    globals.history_total = 7;
+    globals.recycled_entities = 9;
+    PopulationHistory history(4);
+    for (int i = 0; i < 7; ++i) history.push(PopulationHistoryPoint{i, 1, 0, i % 2});
+    for (std::size_t l = 0; l < history.level_count(); ++l) globals.history.push_back(history.level(l));
+
+    const Position pos[3] = {{1.0f, 2.0f}, {3.0f, 4.0f}, {5.0f, 6.0f}};
+    const Velocity vel[3] = {{0.5f, 0.0f}, {0.0f, 0.5f}, {-1.0f, 1.0f}};
+    const Heading heading[3] = {{0.1f}, {0.2f}, {0.3f}};
+    const Health health[3] = {{1.0f, 60.0f}, {2.0f, 60.0f}, {3.0f, 60.0f}};
+    const ReproductionCooldown cooldown[3] = {{0.0f}, {1.0f}, {2.0f}};
+    const BoidId uid[3] = {{11}, {22}, {33}};
+    const InfectionState infection[3] = {{0.0f, 5.0f}, {1.0f, 4.0f}, {2.0f, 3.0f}};
+    const uint64_t alive_bits[1] = {0x5};   // row 1 disabled
+
+    std::vector<CheckpointTable> tables(2);
+    tables[0].tags = CKPT_NORMAL | CKPT_FEMALE | CKPT_ALIVE;   // empty table keeps its slot
+    tables[1].tags = CKPT_DOCTOR | CKPT_MALE | CKPT_ALIVE | CKPT_INFECTED | CKPT_INFECTION_STATE;
+    tables[1].toggled = CKPT_ALIVE;
+    tables[1].rows = 3;
+    tables[1].position = pos;
+    tables[1].velocity = vel;
+    tables[1].heading = heading;
+    tables[1].health = health;
+    tables[1].cooldown = cooldown;
+    tables[1].uid = uid;
+    tables[1].infection = infection;
+    tables[1].alive_enabled = alive_bits;
+
+    std::stringstream out;
+    write_checkpoint(out, globals, tables);
+    const std::string bytes = out.str();
+    EXPECT_EQ(bytes.size() % 8, 0u);
+    const std::vector<uint64_t> image = aligned_image(bytes);
+
+    CheckpointGlobals g;
+    std::vector<CheckpointTable> t;
+    read_checkpoint(reinterpret_cast<const uint8_t*>(image.data()), bytes.size(), g, t);
+    EXPECT_FLOAT_EQ(g.config.p_cure, 0.125f);
+    EXPECT_EQ(g.config.seed, 99);
+    EXPECT_EQ(g.stats.dead_total, 17);
+    EXPECT_EQ(g.clock.frame, 750u);
+    EXPECT_EQ(g.rng_epoch, 2u);
+    EXPECT_EQ(g.rng_spawned[0], 3u);
+    EXPECT_EQ(g.history_total, 7u);
+    EXPECT_EQ(g.recycled_entities, 9u);
+    ASSERT_EQ(g.history.size(), globals.history.size());
+    for (std::size_t l = 0; l < g.history.size(); ++l) {
+        ASSERT_EQ(g.history[l].size(), globals.history[l].size());
+        for (std::size_t b = 0; b < g.history[l].size(); ++b) {
+            EXPECT_EQ(g.history[l][b].first_sample, globals.history[l][b].first_sample);
+            EXPECT_EQ(g.history[l][b].count, globals.history[l][b].count);
+        }
+    }
+
+    ASSERT_EQ(t.size(), 2u);
+    EXPECT_EQ(t[0].rows, 0u);
+    EXPECT_EQ(t[0].tags, tables[0].tags);
+    EXPECT_EQ(t[1].tags, tables[1].tags);
+    ASSERT_EQ(t[1].rows, 3u);
+    EXPECT_FLOAT_EQ(t[1].position[2].y, 6.0f);
+    EXPECT_FLOAT_EQ(t[1].velocity[2].vx, -1.0f);
+    EXPECT_EQ(t[1].uid[1].value, 22u);
+    ASSERT_NE(t[1].infection, nullptr);
+    EXPECT_FLOAT_EQ(t[1].infection[1].time_to_death, 4.0f);
+    EXPECT_EQ(t[1].infected_enabled, nullptr);
+    ASSERT_NE(t[1].alive_enabled, nullptr);
+    EXPECT_EQ(t[1].alive_enabled[0], 0x5u);
+    // Columns point into the image: nothing was copied
+    EXPECT_GE(reinterpret_cast<const uint8_t*>(t[1].position),
+              reinterpret_cast<const uint8_t*>(image.data()));
+
+    // Truncation and foreign files are rejected
+    EXPECT_THROW(read_checkpoint(reinterpret_cast<const uint8_t*>(image.data()), bytes.size() - 8, g, t),
+                 std::runtime_error);
+    std::vector<uint64_t> foreign = image;
+    reinterpret_cast<char*>(foreign.data())[0] = 'X';
+    EXPECT_THROW(read_checkpoint(reinterpret_cast<const uint8_t*>(foreign.data()), bytes.size(), g, t),
+                 std::runtime_error);
+}
+
+// ------------------------------------------------------------
+// Save / restore of live worlds
+// ------------------------------------------------------------
+
+class CheckpointWorldTest : public ::testing::TestWithParam<bool> {
+protected:
+    std::string path_ = "test_checkpoint_tmp.bin";
+
+    void TearDown() override { std::remove(path_.c_str()); }
+
+    static void build(flecs::world& world, const SimConfig& config) {
+        init_world(world, config);
+        register_all_systems(world);
+        register_stats_system(world);
+    }
+
+    // Full observable state, independent of flecs ids
+    static std::vector<std::tuple<uint64_t, float, float, float, float, bool>> boids(flecs::world& world) {
+        std::vector<std::tuple<uint64_t, float, float, float, float, bool>> out;
+        world.each([&](flecs::entity e, const BoidId& id, const Position& p, const Velocity& v) {
+            if (!e.enabled<Alive>()) return;
+            out.emplace_back(id.value, p.x, p.y, v.vx, v.vy, e.enabled<Infected>());
+        });
+        std::sort(out.begin(), out.end());
+        return out;
+    }
+
+    // Boid tables in flecs order: type and row count
+    static std::vector<std::pair<std::string, int>> tables(flecs::world& world) {
+        std::vector<std::pair<std::string, int>> out;
+        world.query_builder<>()
+            .with<Position>()
+            .query_flags(EcsQueryMatchEmptyTables)
+            .build()
+            .run([&](flecs::iter& it) {
+                while (it.next()) {
+                    out.emplace_back(it.table().str().c_str(), static_cast<int>(it.count()));
+                }
+            });
+        return out;
+    }
+};
+
+TEST_P(CheckpointWorldTest, RestoredWorldContinuesBitExactly) {
+    SimConfig config{};
+    config.initial_normal_count = 120;
+    config.initial_doctor_count = 10;
+    config.p_initial_infect_normal = 0.2f;
+    config.sim_threads = 1;
+    config.seed = 5;
+    config.toggle_state_tags = GetParam();
+
+    HeadlessOptions options;
+    options.max_frames = 90;
+    options.stop_on_extinction = false;
+
+    flecs::world original;
+    build(original, config);
+    spawn_initial_population(original);
+    run_headless(original, options);
+    save_checkpoint(original, path_);
+    const auto saved_tables = tables(original);
+    run_headless(original, options);
+
+    SimConfig restored_config = read_checkpoint_config(path_);
+    EXPECT_EQ(restored_config.seed, 5);
+    restored_config.sim_threads = 2;   // thread count does not change results
+    flecs::world restored;
+    build(restored, restored_config);
+    load_checkpoint(restored, path_);
+    EXPECT_EQ(restored.get<SimClock>().frame, 90u);
+    // Same tables in the same order: toggle bitsets are part of each type
+    EXPECT_EQ(tables(restored), saved_tables);
+    if (GetParam()) {
+        for (const auto& t : saved_tables) EXPECT_NE(t.first.find("TOGGLE"), std::string::npos) << t.first;
+    }
+    run_headless(restored, options);
+
+    const SimStats& a = original.get<SimStats>();
+    const SimStats& b = restored.get<SimStats>();
+    EXPECT_EQ(std::memcmp(&a, &b, sizeof(SimStats)), 0);
+    EXPECT_EQ(original.get<SimClock>().time, restored.get<SimClock>().time);
+    EXPECT_EQ(original.get<PopulationHistory>().total_samples(),
+              restored.get<PopulationHistory>().total_samples());
+    EXPECT_EQ(boids(original), boids(restored));
+}
+
+TEST_P(CheckpointWorldTest, RecyclingWorldContinuesBitExactly) {
+    SimConfig config{};
+    config.initial_normal_count = 120;
+    config.initial_doctor_count = 10;
+    config.p_initial_infect_normal = 0.5f;
+    config.t_death = 0.5f;
+    config.sim_threads = 1;
+    config.seed = 6;
+    config.toggle_state_tags = GetParam();
+    config.recycle_entities = true;
+
+    HeadlessOptions options;
+    options.max_frames = 90;
+    options.stop_on_extinction = false;
+
+    flecs::world original;
+    build(original, config);
+    spawn_initial_population(original);
+    run_headless(original, options);
+    const std::size_t parked = original.get<BoidRecycler>().free.size();
+    ASSERT_GT(parked, 0u);
+    save_checkpoint(original, path_);
+    run_headless(original, options);
+
+    flecs::world restored;
+    build(restored, read_checkpoint_config(path_));
+    load_checkpoint(restored, path_);
+    EXPECT_EQ(restored.get<BoidRecycler>().free.size(), parked);
+    run_headless(restored, options);
+
+    const SimStats& a = original.get<SimStats>();
+    const SimStats& b = restored.get<SimStats>();
+    EXPECT_EQ(std::memcmp(&a, &b, sizeof(SimStats)), 0);
+    EXPECT_EQ(boids(original), boids(restored));
+    EXPECT_EQ(original.get<BoidRecycler>().free.size(), restored.get<BoidRecycler>().free.size());
+}
+
+TEST_P(CheckpointWorldTest, RejectsPopulatedOrMismatchedWorlds) {
+    SimConfig config{};
+    config.initial_normal_count = 10;
+    config.initial_doctor_count = 1;
+    config.toggle_state_tags = GetParam();
+
+    flecs::world world;
+    build(world, config);
+    spawn_initial_population(world);
+    save_checkpoint(world, path_);
+    EXPECT_THROW(load_checkpoint(world, path_), std::runtime_error);
+
+    SimConfig other = config;
+    other.toggle_state_tags = !config.toggle_state_tags;
+    flecs::world mismatched;
+    build(mismatched, other);
+    EXPECT_THROW(load_checkpoint(mismatched, path_), std::runtime_error);
+}
+
+TEST_P(CheckpointWorldTest, ImageClonesIntoWorldsWithChangedParameters) {
+    SimConfig config{};
+    config.initial_normal_count = 30;
+    config.initial_doctor_count = 3;
+    config.toggle_state_tags = GetParam();
+
+    flecs::world world;
+    build(world, config);
+    spawn_initial_population(world);
+    const CheckpointImage image = save_checkpoint_image(world);
+    EXPECT_EQ(read_checkpoint_config(image).initial_normal_count, 30);
+
+    // The clone keeps its own parameters but takes the saved state
+    SimConfig changed = read_checkpoint_config(image);
+    changed.p_cure = 0.0f;
+    flecs::world clone;
+    build(clone, changed);
+    load_checkpoint(clone, image);
+    EXPECT_EQ(clone.get<SimConfig>().p_cure, 0.0f);
+    EXPECT_EQ(boids(clone), boids(world));
+
+    SimConfig resized = changed;
+    resized.world_width = 100.0f;
+    flecs::world other;
+    build(other, resized);
+    EXPECT_THROW(load_checkpoint(other, image), std::runtime_error);
+}
+
+INSTANTIATE_TEST_SUITE_P(TagModes, CheckpointWorldTest, ::testing::Values(false, true));
@@ -146,11 +146,123 @@ TEST_F(ConfigLoaderTest, ParsesIntFields) {
     write_file(
         "initial_normal_count = 500\n"
         "initial_doctor_count = 25\n"
+        "sim_threads = 4\n"
     );
     SimConfig config{};
     EXPECT_TRUE(load_config(tmp_path_, config));
     EXPECT_EQ(config.initial_normal_count, 500);
     EXPECT_EQ(config.initial_doctor_count, 25);
+    EXPECT_EQ(config.sim_threads, 4);
+
+    write_file("initial_normal_count = 12.5\n");
+    EXPECT_THROW(load_config(tmp_path_, config), std::runtime_error);
+    EXPECT_THROW(set_config_value(config, "seed", "7x"), std::runtime_error);
+    EXPECT_TRUE(is_integer_config_key("initial_normal_count"));
+    EXPECT_FALSE(is_integer_config_key("p_cure"));
+}
+
+TEST_F(ConfigLoaderTest, ParsesInfectionTickRate) {
+    SimConfig defaults{};
+    EXPECT_FLOAT_EQ(defaults.infection_tick_rate, 0.0f);
+
+    write_file("infection_tick_rate = 1.5\n");
+    SimConfig config{};
+    EXPECT_TRUE(load_config(tmp_path_, config));
+    EXPECT_FLOAT_EQ(config.infection_tick_rate, 1.5f);
+}
+
+TEST_F(ConfigLoaderTest, ParsesToggleStateTags) {
+    SimConfig defaults{};
+    EXPECT_FALSE(defaults.toggle_state_tags);
+
+    write_file("toggle_state_tags = 1\n");
+    SimConfig config{};
+    EXPECT_TRUE(load_config(tmp_path_, config));
+    EXPECT_TRUE(config.toggle_state_tags);
+
+    write_file("toggle_state_tags = yes\n");
+    EXPECT_THROW(load_config(tmp_path_, config), std::runtime_error);
+}
+
+TEST_F(ConfigLoaderTest, ParsesRecycleEntities) {
+    SimConfig defaults{};
+    EXPECT_FALSE(defaults.recycle_entities);
+
+    write_file("recycle_entities = true\n");
+    SimConfig config{};
+    EXPECT_TRUE(load_config(tmp_path_, config));
+    EXPECT_TRUE(config.recycle_entities);
+}
+
+TEST_F(ConfigLoaderTest, ParsesStatsStreamInterval) {
+    SimConfig defaults{};
+    EXPECT_EQ(defaults.stats_stream_interval, 1);
+
+    write_file("stats_stream_interval = 10\n");
+    SimConfig config{};
+    EXPECT_TRUE(load_config(tmp_path_, config));
+    EXPECT_EQ(config.stats_stream_interval, 10);
+}
+
+TEST_F(ConfigLoaderTest, ParsesTrajectoryIntervals) {
+    write_file("trajectory_interval = 6\ntrajectory_keyframe_interval = 60\n");
+    SimConfig config{};
+    EXPECT_TRUE(load_config(tmp_path_, config));
+    EXPECT_EQ(config.trajectory_interval, 6);
+    EXPECT_EQ(config.trajectory_keyframe_interval, 60);
+}
+
+TEST_F(ConfigLoaderTest, ParsesTrajectoryTolerances) {
+    write_file("trajectory_tolerance = 1.5\ntrajectory_heading_tolerance = 0\n");
+    SimConfig config{};
+    EXPECT_TRUE(load_config(tmp_path_, config));
+    EXPECT_FLOAT_EQ(config.trajectory_tolerance, 1.5f);
+    EXPECT_FLOAT_EQ(config.trajectory_heading_tolerance, 0.0f);
+}
+
+TEST_F(ConfigLoaderTest, ParsesSeed) {
+    SimConfig defaults{};
+    EXPECT_EQ(defaults.seed, 42);
+
+    write_file("seed = 1234\n");
+    SimConfig config{};
+    EXPECT_TRUE(load_config(tmp_path_, config));
+    EXPECT_EQ(config.seed, 1234);
+}
+
+TEST_F(ConfigLoaderTest, ParsesStopConditions) {
+    write_file(
+        "stop_on_doctor_extinct = 1\n"
+        "stop_no_infected_seconds = 12.5\n"
+        "stop_steady_window = 30\n"
+        "stop_steady_variance = 4\n");
+    SimConfig config{};
+    EXPECT_TRUE(load_config(tmp_path_, config));
+    EXPECT_FALSE(config.stop_on_normal_extinct);
+    EXPECT_TRUE(config.stop_on_doctor_extinct);
+    EXPECT_FALSE(config.stop_on_antivax_extinct);
+    EXPECT_FLOAT_EQ(config.stop_no_infected_seconds, 12.5f);
+    EXPECT_FLOAT_EQ(config.stop_steady_window, 30.0f);
+    EXPECT_FLOAT_EQ(config.stop_steady_variance, 4.0f);
+}
+
+TEST_F(ConfigLoaderTest, ParsesBurnInSeconds) {
+    write_file("burn_in_seconds = 20\n");
+    SimConfig config{};
+    EXPECT_TRUE(load_config(tmp_path_, config));
+    EXPECT_FLOAT_EQ(config.burn_in_seconds, 20.0f);
+    EXPECT_FLOAT_EQ(SimConfig{}.burn_in_seconds, 0.0f);
+}
+
+TEST(ConfigOverride, SetsKnownKeysAndRejectsUnknown) {
+    SimConfig config{};
+    EXPECT_TRUE(set_config_value(config, "p_cure", "0.25"));
+    EXPECT_FLOAT_EQ(config.p_cure, 0.25f);
+    EXPECT_TRUE(set_config_value(config, "initial_normal_count", "120"));
+    EXPECT_EQ(config.initial_normal_count, 120);
+
+    EXPECT_FALSE(set_config_value(config, "no_such_key", "1"));
+    EXPECT_THROW(set_config_value(config, "p_cure", "high"), std::runtime_error);
 }
 
 TEST_F(ConfigLoaderTest, PartialConfigKeepsDefaults) {
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include "sim/ensemble.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <vector>
+
+TEST(RunningMoments, MatchesTwoPassMeanAndVariance) {
+    std::vector<double> xs = {3.0, 7.0, 7.0, 19.0, 24.0, 1.5};
+    RunningMoments m;
+    for (double x : xs) m.add(x);
+
+    double mean = 0.0;
+    for (double x : xs) mean += x;
+    mean /= xs.size();
+    double ss = 0.0;
+    for (double x : xs) ss += (x - mean) * (x - mean);
+
+    EXPECT_EQ(m.count, xs.size());
+    EXPECT_NEAR(m.mean, mean, 1e-12);
+    EXPECT_NEAR(m.variance(), ss / (xs.size() - 1), 1e-9);
+
+    RunningMoments single;
+    single.add(5.0);
+    EXPECT_EQ(single.variance(), 0.0);
+}
+
+TEST(P2Quantile, ExactForFewObservations) {
+    P2Quantile median(0.5);
+    EXPECT_EQ(median.value(), 0.0);
+    median.add(10.0);
+    EXPECT_EQ(median.value(), 10.0);
+    median.add(2.0);
+    median.add(6.0);
+    EXPECT_DOUBLE_EQ(median.value(), 6.0);
+
+    P2Quantile q25(0.25);
+    for (double x : {4.0, 1.0, 3.0, 2.0, 5.0}) q25.add(x);
+    EXPECT_DOUBLE_EQ(q25.value(), 2.0);
+}
+
+TEST(P2Quantile, TracksQuantilesOfLargeStreams) {
+    std::mt19937 rng(7);
+    std::normal_distribution<double> normal(100.0, 15.0);
+    std::vector<double> xs(20000);
+    for (double& x : xs) x = normal(rng);
+
+    for (double p : {0.05, 0.5, 0.95}) {
+        P2Quantile q(p);
+        for (double x : xs) q.add(x);
+        std::vector<double> sorted = xs;
+        std::sort(sorted.begin(), sorted.end());
+        double exact = sorted[static_cast<std::size_t>(p * (sorted.size() - 1))];
+        EXPECT_NEAR(q.value(), exact, 1.0) << "p = " << p;
+        EXPECT_EQ(q.count(), xs.size());
+    }
+}
+
+TEST(EnsembleAccumulator, AggregatesRowsAcrossRuns) {
+    EnsembleAccumulator acc(2, {0.1, 0.9});
+    for (int run = 0; run < 10; ++run) {
+        for (std::size_t row = 0; row < 3; ++row) {
+            double values[2] = {static_cast<double>(run), 50.0};
+            acc.add(row, (row + 1) * 10, (row + 1) * 0.5, values);
+        }
+    }
+    acc.add(3, 40, 2.0, std::vector<double>{1.0, 1.0}.data());
+
+    ASSERT_EQ(acc.rows(), 4u);
+    EXPECT_EQ(acc.runs(0), 10u);
+    EXPECT_EQ(acc.runs(3), 1u);
+    EXPECT_EQ(acc.frame(2), 30u);
+    EXPECT_DOUBLE_EQ(acc.time(2), 1.5);
+    EXPECT_NEAR(acc.moments(1, 0).mean, 4.5, 1e-12);
+    EXPECT_NEAR(acc.moments(1, 1).variance(), 0.0, 1e-12);
+    EXPECT_DOUBLE_EQ(acc.quantile(0, 1, 0), 50.0);
+    EXPECT_LT(acc.quantile(0, 0, 0), acc.quantile(0, 0, 1));
+
+    EXPECT_THROW(EnsembleAccumulator(1, {0.0, 0.5}), std::invalid_argument);
+}
+
+TEST(EnsembleCsv, LabelsAndRoundTrip) {
+    EXPECT_EQ(quantile_label(0.05), "q05");
+    EXPECT_EQ(quantile_label(0.5), "q50");
+    EXPECT_EQ(quantile_label(0.025), "q2.5");
+
+    EnsembleAccumulator acc(2, {0.05, 0.5, 0.95});
+    for (int run = 0; run < 4; ++run) {
+        for (std::size_t row = 0; row < 5; ++row) {
+            double values[2] = {static_cast<double>(row * 10 + run), static_cast<double>(run)};
+            acc.add(row, (row + 1) * 6, (row + 1) * 0.1, values);
+        }
+    }
+    const char* names[] = {"normal_alive", "infected_alive"};
+    std::stringstream csv;
+    write_ensemble_csv(acc, names, csv);
+
+    std::string header;
+    std::getline(std::stringstream(csv.str()), header);
+    EXPECT_EQ(header,
+              "frame,time,runs,normal_alive_mean,normal_alive_sd,normal_alive_q05,normal_alive_q50,"
+              "normal_alive_q95,infected_alive_mean,infected_alive_sd,infected_alive_q05,"
+              "infected_alive_q50,infected_alive_q95");
+
+    EnsembleSummary summary = read_ensemble_csv(csv);
+    ASSERT_EQ(summary.rows(), 5u);
+    ASSERT_EQ(summary.series.size(), 2u);
+    ASSERT_EQ(summary.quantile_levels.size(), 3u);
+    EXPECT_NEAR(summary.quantile_levels[0], 0.05, 1e-12);
+    EXPECT_EQ(summary.frames[4], 30u);
+
+    const EnsembleSeries* normal = summary.find("normal_alive");
+    ASSERT_NE(normal, nullptr);
+    EXPECT_FLOAT_EQ(normal->mean[2], 21.5f);
+    EXPECT_NEAR(normal->sd[2], std::sqrt(acc.moments(2, 0).variance()), 1e-4);
+    ASSERT_EQ(normal->quantiles.size(), 3u);
+    EXPECT_FLOAT_EQ(normal->quantiles[1][2], static_cast<float>(acc.quantile(2, 0, 1)));
+    EXPECT_EQ(summary.find("doctor_alive"), nullptr);
+
+    std::stringstream bad("frame,time\n1,2\n");
+    EXPECT_THROW(read_ensemble_csv(bad), std::runtime_error);
+}
@@ -0,0 +1,76 @@
+#include "sim/infection.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+// ============================================================
+// Hazard-rate conversion
+// ============================================================
+
+// One reference frame reproduces the configured per-frame probability
+TEST(InfectionHazard, OneReferenceFrameIsIdentity) {
+    EXPECT_NEAR(hazard_probability(0.3f, 1.0f / 60.0f), 0.3f, 1e-5f);
+    EXPECT_NEAR(hazard_probability(0.001f, 1.0f / 60.0f), 0.001f, 1e-7f);
+}
+
+// A 1 s tick carries the same risk as 60 independent per-frame rolls
+TEST(InfectionHazard, OneSecondMatchesSixtyFrames) {
+    float p = 0.01f;
+    float expected = 1.0f - std::pow(1.0f - p, 60.0f);
+    EXPECT_NEAR(hazard_probability(p, 1.0f), expected, 1e-5f);
+}
+
+TEST(InfectionHazard, ClampsDegenerateInputs) {
+    EXPECT_FLOAT_EQ(hazard_probability(0.0f, 1.0f), 0.0f);
+    EXPECT_FLOAT_EQ(hazard_probability(1.0f, 1.0f), 1.0f);
+    EXPECT_FLOAT_EQ(hazard_probability(1.0f, 1.0f / 60.0f), 1.0f);
+    EXPECT_FLOAT_EQ(hazard_probability(0.5f, 0.0f), 0.0f);
+}
+
+// ============================================================
+// Staggered tick scheduling
+// ============================================================
+
+TEST(InfectionSchedule, PhaseInUnitInterval) {
+    for (uint64_t id = 0; id < 10000; ++id) {
+        float phase = infection_phase(id);
+        EXPECT_GE(phase, 0.0f);
+        EXPECT_LT(phase, 1.0f);
+    }
+}
+
+// Over one second at 1 Hz every boid ticks exactly once
+TEST(InfectionSchedule, EachBoidTicksOncePerInterval) {
+    const float dt = 1.0f / 60.0f;
+    for (uint64_t id = 1; id <= 500; ++id) {
+        float phase = infection_phase(id);
+        int ticks = 0;
+        for (int frame = 0; frame < 60; ++frame) {
+            ticks += infection_ticks_due(phase, frame * dt, (frame + 1) * dt, 1.0f);
+        }
+        EXPECT_EQ(ticks, 1) << "entity " << id;
+    }
+}
+
+// Sequential ids spread evenly: roughly 1/60 of the population ticks per frame
+TEST(InfectionSchedule, LoadSpreadAcrossFrames) {
+    const int N = 60000;
+    const float dt = 1.0f / 60.0f;
+    std::vector<int> per_frame(60, 0);
+    for (uint64_t id = 1; id <= static_cast<uint64_t>(N); ++id) {
+        float phase = infection_phase(id);
+        for (int frame = 0; frame < 60; ++frame) {
+            per_frame[frame] += infection_ticks_due(phase, frame * dt, (frame + 1) * dt, 1.0f);
+        }
+    }
+    for (int count : per_frame) {
+        EXPECT_NEAR(count, N / 60, N / 60 / 5);
+    }
+}
+
+// A frame longer than the tick interval reports every tick it covers
+TEST(InfectionSchedule, LongFrameCoversSeveralTicks) {
+    EXPECT_EQ(infection_ticks_due(0.5f, 0.0, 3.0, 1.0f), 3);
+    EXPECT_EQ(infection_ticks_due(0.5f, 0.0, 0.4, 1.0f), 0);
+    EXPECT_EQ(infection_ticks_due(0.5f, 0.0, 1.0, 0.0f), 0);
+}
@@ -0,0 +1,228 @@
+#include <gtest/gtest.h>
+#include <flecs.h>
+#include "components.h"
+#include "spatial_grid.h"
+#include "ecs/systems.h"
+#include "ecs/worker_pool.h"
+#include "sim/infection.h"
+#include <memory>
+#include <random>
+#include <vector>
+
+// Helper: register all component types needed for infection/cure systems
+static void register_components(flecs::world& world) {
+    world.component<Position>();
+    world.component<Velocity>();
+    world.component<Heading>();
+    world.component<Health>();
+    world.component<InfectionState>();
+    world.component<ReproductionCooldown>();
+    world.component<NormalBoid>();
+    world.component<DoctorBoid>();
+    world.component<AntivaxBoid>();
+    world.component<Male>();
+    world.component<Female>();
+    world.component<Infected>();
+    world.component<Alive>();
+    world.component<SpatialGrid>();
+    world.component<InteractionIndex>();
+}
+
+// Helper: singletons including the filtered InteractionIndex (enables reverse direction)
+static void set_singletons(flecs::world& world, SimConfig config) {
+    world.set<SimConfig>(config);
+    world.set<SimStats>({});
+    world.set<SpatialGrid>(SpatialGrid(1920.0f, 1080.0f, 40.0f));
+    world.set<InteractionIndex>(InteractionIndex(1920.0f, 1080.0f, 40.0f));
+}
+
+static flecs::entity make_boid(flecs::world& world, float x, float y, bool doctor, bool infected) {
+    auto e = world.entity()
+        .add<Alive>()
+        .add<Male>()
+        .set(Position{x, y})
+        .set(Velocity{0.0f, 0.0f})
+        .set(Heading{0.0f})
+        .set(Health{0.0f, 60.0f})
+        .set(InfectionState{0.0f, 5.0f})
+        .set(ReproductionCooldown{0.0f});
+    if (doctor) {
+        e.add<DoctorBoid>();
+    } else {
+        e.add<NormalBoid>();
+    }
+    if (infected) e.add<Infected>();
+    return e;
+}
+
+// Infected majority: InfectionSystem iterates the lone susceptible and queries the
+// infected index. A neighbor within the spreader radius must still infect it,
+// while one outside it must not.
+TEST(InteractionDirection, ReverseInfectionFromSusceptibleSide) {
+    flecs::world world;
+    register_components(world);
+
+    SimConfig config{};
+    config.p_infect_normal = 1.0f;
+    set_singletons(world, config);
+
+    // Effective normal spreader radius = 30 * 0.8 = 24 px
+    auto near_target = make_boid(world, 500.0f, 500.0f, false, false);
+    auto far_target = make_boid(world, 900.0f, 500.0f, false, false);
+    make_boid(world, 510.0f, 500.0f, false, true);   // 10 px from near_target
+    make_boid(world, 930.0f, 500.0f, false, true);   // 30 px from far_target
+    for (int i = 0; i < 4; ++i) {
+        make_boid(world, 100.0f + 50.0f * i, 100.0f, false, true);  // far away
+    }
+
+    register_rebuild_grid_system(world);
+    register_infection_system(world);
+
+    world.progress(1.0f / 60.0f);
+
+    EXPECT_TRUE(near_target.has<Infected>())
+        << "Susceptible within the spreader radius should be infected in reverse mode";
+    EXPECT_FALSE(far_target.has<Infected>())
+        << "Susceptible outside the debuffed spreader radius must stay healthy";
+}
+
+// Staggered ticks: a pair is rolled on the spreader's tick whichever side is
+// iterated. The direction flips every frame; with a certain transmission the
+// susceptible must be infected on exactly the spreader's tick frame, neither
+// earlier (an extra roll on its own tick) nor later (a missed roll).
+TEST(InteractionDirection, StaggeredPairRollsOnSpreaderTickInEitherDirection) {
+    const float dt = 1.0f / 60.0f;
+    auto tick_frame = [&](uint64_t uid) {
+        for (int f = 0; f < 60; ++f) {
+            const double t_now = (f + 1) * static_cast<double>(dt);
+            if (infection_ticks_due(infection_phase(uid), t_now - dt, t_now, 1.0f) > 0) return f;
+        }
+        return -1;
+    };
+    const uint64_t spreader_uid = 1;
+    uint64_t target_uid = 2;
+    while (tick_frame(target_uid) == tick_frame(spreader_uid)) target_uid++;
+
+    for (int parity = 0; parity < 2; ++parity) {
+        flecs::world world;
+        register_components(world);
+
+        SimConfig config{};
+        config.p_infect_normal = 1.0f;
+        config.infection_tick_rate = 1.0f;
+        set_singletons(world, config);
+
+        auto target = make_boid(world, 500.0f, 500.0f, false, false).set(BoidId{target_uid});
+        make_boid(world, 510.0f, 500.0f, false, true).set(BoidId{spreader_uid});
+        // Far-away infected boids outnumber the target: reverse direction...
+        for (int i = 0; i < 3; ++i) make_boid(world, 100.0f + 50.0f * i, 100.0f, false, true);
+        // ...unless these far-away susceptibles are alive: forward direction
+        std::vector<flecs::entity> crowd;
+        for (int i = 0; i < 5; ++i) crowd.push_back(make_boid(world, 100.0f + 50.0f * i, 900.0f, false, false));
+
+        register_rebuild_grid_system(world);
+        register_infection_system(world);
+
+        int infected_at = -1;
+        for (int f = 0; f < 60 && infected_at < 0; ++f) {
+            const bool forward = (f + parity) % 2 == 0;
+            for (auto e : crowd) {
+                if (forward) e.add<Alive>(); else e.remove<Alive>();
+            }
+            world.set<SimClock>({(f + 1) * static_cast<double>(dt), static_cast<uint64_t>(f + 1)});
+            world.progress(dt);
+            if (target.has<Infected>()) infected_at = f;
+        }
+        EXPECT_EQ(infected_at, tick_frame(spreader_uid)) << "parity " << parity;
+    }
+}
+
+// Doctor majority: CureSystem iterates the lone infected boid and queries the
+// doctor index. Doctors cannot cure themselves in either direction.
+TEST(InteractionDirection, ReverseCureFromInfectedSide) {
+    flecs::world world;
+    register_components(world);
+
+    SimConfig config{};
+    config.p_cure = 1.0f;
+    set_singletons(world, config);
+
+    auto patient = make_boid(world, 500.0f, 500.0f, false, true);
+    for (int i = 0; i < 3; ++i) {
+        make_boid(world, 510.0f + 5.0f * i, 500.0f, true, false);
+    }
+
+    register_rebuild_grid_system(world);
+    register_cure_system(world);
+
+    world.progress(1.0f / 60.0f);
+
+    EXPECT_FALSE(patient.has<Infected>())
+        << "Infected boid surrounded by doctors should be cured in reverse mode";
+}
+
+TEST(InteractionDirection, ReverseCureDoctorCannotCureSelf) {
+    flecs::world world;
+    register_components(world);
+
+    SimConfig config{};
+    config.p_cure = 1.0f;
+    set_singletons(world, config);
+
+    // One infected doctor, far from two healthy doctors: reverse mode, nobody in range
+    auto sick_doctor = make_boid(world, 500.0f, 500.0f, true, true);
+    make_boid(world, 1500.0f, 500.0f, true, false);
+    make_boid(world, 1500.0f, 900.0f, true, false);
+
+    register_rebuild_grid_system(world);
+    register_cure_system(world);
+
+    for (int i = 0; i < 10; ++i) {
+        world.progress(1.0f / 60.0f);
+    }
+
+    EXPECT_TRUE(sick_doctor.has<Infected>())
+        << "An isolated infected doctor must not cure itself";
+}
+
+// Parallel infection/cure must not depend on the number of worker threads:
+// draws are keyed per boid and commands are merged in target order.
+static std::vector<bool> run_epidemic_frames(unsigned threads) {
+    flecs::world world;
+    register_components(world);
+
+    SimConfig config{};
+    config.p_infect_normal = 0.3f;
+    config.p_infect_doctor = 0.3f;
+    config.p_cure = 0.5f;
+    set_singletons(world, config);
+    if (threads > 1) {
+        world.set<SimWorkers>({std::make_shared<WorkerPool>(threads)});
+    }
+
+    std::mt19937 layout(7);
+    std::uniform_real_distribution<float> dx(0.0f, 600.0f), dy(0.0f, 400.0f), coin(0.0f, 1.0f);
+    std::vector<flecs::entity> boids;
+    for (int i = 0; i < 2000; ++i) {
+        boids.push_back(make_boid(world, dx(layout), dy(layout), coin(layout) < 0.1f, coin(layout) < 0.4f));
+    }
+
+    register_rebuild_grid_system(world);
+    register_infection_system(world);
+    register_cure_system(world);
+
+    for (int i = 0; i < 5; ++i) {
+        world.progress(1.0f / 60.0f);
+    }
+
+    std::vector<bool> infected;
+    for (auto e : boids) infected.push_back(e.has<Infected>());
+    return infected;
+}
+
+TEST(InteractionDirection, ParallelResultIndependentOfThreadCount) {
+    std::vector<bool> serial = run_epidemic_frames(1);
+    std::vector<bool> parallel = run_epidemic_frames(4);
+    EXPECT_EQ(serial, parallel)
+        << "Infection/cure outcome must be identical for 1 and 4 worker threads";
+}
@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+#include <flecs.h>
+#include "components.h"
+#include "spatial_grid.h"
+#include "ecs/systems.h"
+#include "ecs/stats.h"
+#include "sim/population_history.h"
+#include "sim/rng.h"
+
+static void register_components(flecs::world& world) {
+    world.component<Position>();
+    world.component<Velocity>();
+    world.component<Heading>();
+    world.component<Health>();
+    world.component<InfectionState>();
+    world.component<ReproductionCooldown>();
+    world.component<NormalBoid>();
+    world.component<DoctorBoid>();
+    world.component<AntivaxBoid>();
+    world.component<Male>();
+    world.component<Female>();
+    world.component<Infected>();
+    world.component<Alive>();
+    world.component<Dead>();
+    world.component<SpatialGrid>();
+}
+
+static flecs::entity make_boid(flecs::world& world, bool infected, float time_infected) {
+    auto e = world.entity()
+        .add<NormalBoid>()
+        .add<Alive>()
+        .add<Male>()
+        .set(Position{0.0f, 0.0f})
+        .set(Velocity{0.0f, 0.0f})
+        .set(Heading{0.0f})
+        .set(Health{0.0f, 60.0f})
+        .set(InfectionState{time_infected, 5.0f})
+        .set(ReproductionCooldown{0.0f});
+    if (infected) e.add<Infected>();
+    return e;
+}
+
+TEST(DeadCleanup, DeathTagsDeadAndCleanupDeletesOnlyCorpses) {
+    flecs::world world;
+    register_components(world);
+
+    SimConfig config{};
+    config.t_death = 5.0f;
+    world.set<SimConfig>(config);
+    world.set<SimStats>({});
+
+    auto dying = make_boid(world, true, 6.0f);
+    auto sick = make_boid(world, true, 1.0f);
+    auto healthy = make_boid(world, false, 0.0f);
+
+    register_death_system(world);
+    world.progress(1.0f / 60.0f);
+
+    EXPECT_TRUE(dying.has<Dead>());
+    EXPECT_FALSE(dying.has<Alive>());
+    EXPECT_FALSE(sick.has<Dead>());
+    EXPECT_EQ(world.count<Dead>(), 1);
+
+    register_cleanup_system(world);
+    world.progress(1.0f / 60.0f);
+
+    EXPECT_FALSE(dying.is_alive());
+    EXPECT_TRUE(sick.is_alive());
+    EXPECT_TRUE(healthy.is_alive());
+    EXPECT_EQ(world.count<Dead>(), 0);
+    EXPECT_EQ(world.get<SimStats>().dead_total, 1);
+}
+
+TEST(DeadCleanup, FrameWithoutDeathsLeavesPopulationIntact) {
+    flecs::world world;
+    register_components(world);
+    world.set<SimConfig>({});
+    world.set<SimStats>({});
+
+    for (int i = 0; i < 20; ++i) {
+        make_boid(world, false, 0.0f);
+    }
+
+    register_death_system(world);
+    register_cleanup_system(world);
+    for (int i = 0; i < 3; ++i) {
+        world.progress(1.0f / 60.0f);
+    }
+
+    EXPECT_EQ(world.count<Alive>(), 20);
+}
+
+// Counters are maintained by observers as tags come and go, not by per-frame scans
+TEST(PopulationCounters, FollowStateChangesIncrementally) {
+    flecs::world world;
+    register_components(world);
+    world.set<SimConfig>({});
+    world.set<SimStats>({});
+    world.set(PopulationHistory());
+
+    auto a = make_boid(world, true, 0.0f);
+    make_boid(world, false, 0.0f);
+    register_stats_system(world);  // seeds counters from existing boids
+
+    const SimStats& stats = world.get<SimStats>();
+    EXPECT_EQ(stats.normal_alive, 2);
+    EXPECT_EQ(stats.infected_alive, 1);
+
+    auto doc = world.entity().add<DoctorBoid>().add<Alive>().add<Infected>();
+    EXPECT_EQ(world.get<SimStats>().doctor_alive, 1);
+    EXPECT_EQ(world.get<SimStats>().infected_alive, 2);
+
+    a.remove<Infected>();                  // cure
+    doc.remove<Alive>();                   // death
+    EXPECT_EQ(world.get<SimStats>().infected_alive, 0);
+    EXPECT_EQ(world.get<SimStats>().doctor_alive, 0);
+
+    a.destruct();
+    EXPECT_EQ(world.get<SimStats>().normal_alive, 1);
+
+    // The per-frame step only records history
+    world.progress(1.0f / 60.0f);
+    const PopulationHistory& history = world.get<PopulationHistory>();
+    EXPECT_EQ(history.total_samples(), 1u);
+    EXPECT_EQ(history.latest().normal_alive, 1);
+    EXPECT_EQ(history.latest().infected_count, 0);
+}
+
+// Both sexes iterate, so every pair gets two independent attempts per frame.
+// Isolated pairs with p_offspring = p must mate at 1 - (1 - p)^2, not p.
+TEST(Reproduction, PairTriesFromBothSidesEachFrame) {
+    flecs::world world;
+    register_components(world);
+
+    SimConfig config{};
+    config.p_offspring_normal = 0.3f;
+    config.offspring_mean_normal = 1.0f;
+    config.offspring_stddev_normal = 0.0f;
+    config.world_width = 4000.0f;
+    config.world_height = 4000.0f;
+    world.set<SimConfig>(config);
+    world.set<SimStats>({});
+    world.set(SimRng{7});
+    world.set<SpatialGrid>(SpatialGrid(config.world_width, config.world_height, 40.0f));
+
+    // 1600 pairs, 100 px apart: no boid sees another pair
+    constexpr int SIDE = 40;
+    for (int i = 0; i < SIDE * SIDE; ++i) {
+        const float x = 50.0f + 100.0f * static_cast<float>(i % SIDE);
+        const float y = 50.0f + 100.0f * static_cast<float>(i / SIDE);
+        for (bool male : {true, false}) {
+            auto e = world.entity()
+                .add<NormalBoid>()
+                .add<Alive>()
+                .set(Position{male ? x : x + 5.0f, y})
+                .set(Velocity{0.0f, 0.0f})
+                .set(Heading{0.0f})
+                .set(Health{0.0f, 60.0f})
+                .set(InfectionState{0.0f, 5.0f})
+                .set(ReproductionCooldown{0.0f});
+            if (male) e.add<Male>(); else e.add<Female>();
+        }
+    }
+
+    register_rebuild_grid_system(world);
+    register_reproduction_system(world);
+    world.progress(1.0f / 60.0f);
+
+    const double rate = world.get<SimStats>().newborns_total / double(SIDE * SIDE);
+    const double expected = 1.0 - 0.7 * 0.7;   // 0.51; a single shared draw gives 0.3
+    EXPECT_NEAR(rate, expected, 0.05) << "mating rate per pair and frame";
+}
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include "sim/population_history.h"
+#include <cmath>
+#include <vector>
+
+static PopulationHistoryPoint point(int normal, int infected) {
+    PopulationHistoryPoint p;
+    p.normal_alive = normal;
+    p.doctor_alive = 1;
+    p.antivax_alive = 2;
+    p.infected_count = infected;
+    return p;
+}
+
+TEST(PopulationHistory, KeepsRawSamplesUntilCapacity) {
+    PopulationHistory history(8);
+    for (int i = 0; i < 8; ++i) history.push(point(i, 0));
+
+    EXPECT_EQ(history.level_count(), 1u);
+    EXPECT_EQ(history.bucket_count(), 8u);
+    EXPECT_EQ(history.latest().normal_alive, 7);
+}
+
+TEST(PopulationHistory, CoversWholeRunWithLogarithmicMemory) {
+    PopulationHistory history(16);
+    const uint64_t N = 100000;
+    for (uint64_t i = 0; i < N; ++i) {
+        history.push(point(static_cast<int>(i % 1000), static_cast<int>(i)));
+    }
+
+    EXPECT_EQ(history.total_samples(), N);
+    // ~log2(N / 16) levels of at most 16 buckets each
+    EXPECT_LE(history.level_count(), 14u);
+    EXPECT_LE(history.bucket_count(), 16u * history.level_count());
+
+    // Buckets tile [0, N) in order without gaps or overlaps
+    std::vector<HistoryBucket> all;
+    history.buckets(all);
+    uint64_t next = 0;
+    for (const auto& b : all) {
+        EXPECT_EQ(b.first_sample, next);
+        next += b.count;
+    }
+    EXPECT_EQ(next, N);
+
+    // Oldest bucket aggregates correctly: infected == sample index
+    const HistoryBucket& first = all.front();
+    EXPECT_EQ(first.min.infected_count, 0);
+    EXPECT_EQ(first.max.infected_count, static_cast<int>(first.count - 1));
+    EXPECT_FLOAT_EQ(first.mean(HistorySeries::Infected), (first.count - 1) / 2.0f);
+    EXPECT_FLOAT_EQ(first.mean(HistorySeries::Doctor), 1.0f);
+}
+
+TEST(PopulationHistory, ClearResets) {
+    PopulationHistory history(4);
+    for (int i = 0; i < 50; ++i) history.push(point(i, i));
+    history.clear();
+    EXPECT_EQ(history.total_samples(), 0u);
+    EXPECT_EQ(history.bucket_count(), 0u);
+    EXPECT_EQ(history.latest().normal_alive, 0);
+}
+
+TEST(Lttb, KeepsEndpointsAndPeaks) {
+    std::vector<float> xs, ys;
+    for (int i = 0; i < 1000; ++i) {
+        xs.push_back(static_cast<float>(i));
+        ys.push_back(i == 500 ? 100.0f : std::sin(i * 0.01f));
+    }
+
+    std::vector<std::size_t> idx;
+    lttb_indices(xs, ys, 50, idx);
+    ASSERT_EQ(idx.size(), 50u);
+    EXPECT_EQ(idx.front(), 0u);
+    EXPECT_EQ(idx.back(), 999u);
+    for (std::size_t i = 1; i < idx.size(); ++i) {
+        EXPECT_LT(idx[i - 1], idx[i]);
+    }
+    bool kept_spike = false;
+    for (std::size_t i : idx) kept_spike |= (i == 500);
+    EXPECT_TRUE(kept_spike);
+
+    lttb_indices(xs, ys, 5000, idx);
+    EXPECT_EQ(idx.size(), 1000u);
+}
@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+#include <flecs.h>
+#include "components.h"
+#include "ecs/world.h"
+#include "ecs/systems.h"
+#include "ecs/spawn.h"
+#include "ecs/stats.h"
+#include "ecs/replay.h"
+#include "io/replay_log.h"
+#include "io/xxhash64.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// ------------------------------------------------------------
+// Hashes and log files
+// ------------------------------------------------------------
+
+TEST(XXHash64, MatchesReferenceVectors) {
+    EXPECT_EQ(xxh64("", 0), 0xEF46DB3751D8E999ull);
+    const std::string text = "Nobody inspects the spammish repetition";
+    EXPECT_EQ(xxh64(text.data(), text.size()), 0xFBCEA83C8A378BF1ull);
+
+    // Seeded and unseeded runs over the long-input path differ
+    const std::vector<uint64_t> words(64, 0x0123456789ABCDEFull);
+    const std::size_t bytes = words.size() * sizeof(uint64_t);
+    EXPECT_NE(xxh64(words.data(), bytes, 1), xxh64(words.data(), bytes, 0));
+    EXPECT_EQ(xxh64(words.data(), bytes, 7), xxh64(words.data(), bytes, 7));
+}
+
+namespace {
+
+ReplayFrame make_frame(uint64_t frame, uint64_t kinematics) {
+    ReplayFrame f;
+    f.frame = frame;
+    f.dt = 1.0f / 60.0f;
+    f.hash.kinematics = kinematics;
+    f.hash.epidemic = frame * 3;
+    f.hash.globals = frame * 5;
+    return f;
+}
+
+} // namespace
+
+TEST(ReplayLogFile, RoundTripsAndKeepsCompleteRecordsOfATruncatedLog) {
+    const std::string path = "test_replay_log_tmp.bin";
+    const uint8_t image[5] = {1, 2, 3, 4, 5};
+    StateHash start;
+    start.kinematics = 11;
+    SimConfig changed{};
+    changed.p_cure = 0.25f;
+    {
+        ReplayLogWriter writer(path, image, sizeof(image), start);
+        writer.frame(make_frame(1, 100));
+        writer.config(changed);
+        writer.frame(make_frame(2, 200));
+        writer.reset();
+        writer.frame(make_frame(1, 300));
+    }
+
+    const ReplayLog log = read_replay_log(path);
+    EXPECT_EQ(log.image_bytes, sizeof(image));
+    EXPECT_EQ(std::memcmp(log.image.data(), image, sizeof(image)), 0);
+    EXPECT_EQ(log.start, start);
+    ASSERT_EQ(log.events.size(), 5u);
+    EXPECT_EQ(log.events[1].type, ReplayRecord::Config);
+    EXPECT_EQ(log.events[1].config.p_cure, 0.25f);
+    EXPECT_EQ(log.events[3].type, ReplayRecord::Reset);
+    const std::vector<ReplayFrame> frames = log.frames();
+    ASSERT_EQ(frames.size(), 3u);
+    EXPECT_EQ(frames[2].frame, 1u);
+    EXPECT_EQ(frames[2].hash.kinematics, 300u);
+
+    // A run killed mid-record keeps everything before it
+    std::string bytes;
+    {
+        std::ifstream in(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    std::ofstream(path, std::ios::binary).write(bytes.data(), static_cast<std::streamsize>(bytes.size() - 6));
+    EXPECT_EQ(read_replay_log(path).events.size(), 4u);
+
+    std::ofstream(path, std::ios::binary) << "not a log at all, just some text";
+    EXPECT_THROW(read_replay_log(path), std::runtime_error);
+    EXPECT_THROW(read_replay_log("no_such_replay.log"), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+TEST(ReplayLogFile, BisectsToTheFirstDivergentFrame) {
+    std::vector<ReplayFrame> a, b;
+    for (uint64_t i = 1; i <= 100; ++i) a.push_back(make_frame(i, i));
+    b = a;
+    EXPECT_EQ(first_divergent_frame(a, b), -1);
+    EXPECT_EQ(first_divergent_frame({}, b), -1);
+
+    for (std::size_t i = 37; i < b.size(); ++i) b[i].hash.globals ^= 1;
+    EXPECT_EQ(first_divergent_frame(a, b), 37);
+    EXPECT_EQ(describe_hash_difference(a[37].hash, b[37].hash), "globals");
+
+    // Only the common length counts
+    b.resize(30);
+    EXPECT_EQ(first_divergent_frame(a, b), -1);
+    b.push_back(a[30]);
+    b.back().hash.kinematics ^= 1;
+    b.back().hash.epidemic ^= 1;
+    EXPECT_EQ(first_divergent_frame(a, b), 30);
+    EXPECT_EQ(describe_hash_difference(a[30].hash, b[30].hash), "kinematics,epidemic");
+}
+
+// ------------------------------------------------------------
+// Recording and replaying live worlds
+// ------------------------------------------------------------
+
+class ReplayWorldTest : public ::testing::TestWithParam<bool> {
+protected:
+    std::string path_ = "test_replay_world_tmp.bin";
+
+    void TearDown() override { std::remove(path_.c_str()); }
+
+    // 90 frames: a slider change before frame 40 and a reset before frame 60
+    ReplayLog record() {
+        SimConfig config{};
+        config.initial_normal_count = 80;
+        config.initial_doctor_count = 8;
+        config.p_initial_infect_normal = 0.2f;
+        config.sim_threads = 2;
+        config.seed = 17;
+        config.toggle_state_tags = GetParam();
+
+        flecs::world world;
+        init_world(world, config);
+        register_all_systems(world);
+        register_stats_system(world);
+        spawn_initial_population(world);
+        open_replay_log(world, path_);
+
+        const float dt = 1.0f / 60.0f;
+        for (int i = 0; i < 90; ++i) {
+            if (i == 40) world.get_mut<SimConfig>().cohesion_weight = 4.0f;
+            if (i == 60) {
+                reset_simulation(world);
+                record_replay_reset(world);
+            }
+            world.progress(dt);
+            record_replay_frame(world, dt);
+        }
+        close_replay_log(world);
+        EXPECT_FALSE(world.has<ReplayRecorder>());
+        return read_replay_log(path_);
+    }
+};
+
+TEST_P(ReplayWorldTest, ReplayReproducesEveryFrameAtAnyThreadCount) {
+    const ReplayLog log = record();
+    ASSERT_EQ(log.frames().size(), 90u);
+    int configs = 0, resets = 0;
+    for (const ReplayEvent& e : log.events) {
+        configs += e.type == ReplayRecord::Config;
+        resets += e.type == ReplayRecord::Reset;
+    }
+    EXPECT_EQ(configs, 1);
+    EXPECT_EQ(resets, 1);
+
+    for (int threads : {1, 2}) {
+        const ReplayCheck check = replay_log(log, threads);
+        EXPECT_TRUE(check.start_matches);
+        EXPECT_EQ(check.divergent, -1) << threads << " thread(s)";
+        EXPECT_EQ(check.frames.size(), 90u);
+    }
+}
+
+TEST_P(ReplayWorldTest, ReportsTheFirstFrameThatDoesNotMatch) {
+    ReplayLog log = record();
+    const std::vector<ReplayFrame> logged = log.frames();
+    EXPECT_NE(logged[10].hash, logged[11].hash);
+
+    // Undoing the slider change makes the replay diverge after it
+    ReplayLog no_slider = log;
+    for (ReplayEvent& e : no_slider.events) {
+        if (e.type == ReplayRecord::Config) e.config.cohesion_weight = 1.0f;
+    }
+    const ReplayCheck changed = replay_log(no_slider, 1);
+    EXPECT_GE(changed.divergent, 40);
+    EXPECT_EQ(static_cast<std::size_t>(changed.divergent) + 1, changed.frames.size());
+
+    int seen = 0;
+    for (ReplayEvent& e : log.events) {
+        if (e.type == ReplayRecord::Frame && seen++ == 25) e.frame.hash.epidemic ^= 1;
+    }
+    const ReplayCheck tampered = replay_log(log, 1);
+    EXPECT_EQ(tampered.divergent, 25);
+    EXPECT_EQ(tampered.frames.size(), 26u);
+
+    log.start.globals ^= 1;
+    EXPECT_FALSE(replay_log(log, 1).start_matches);
+}
+
+INSTANTIATE_TEST_SUITE_P(TagModes, ReplayWorldTest, ::testing::Values(false, true));
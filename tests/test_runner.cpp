@@ -0,0 +1,369 @@
+#include <gtest/gtest.h>
+#include <flecs.h>
+#include "components.h"
+#include "render_state.h"
+#include "ecs/world.h"
+#include "ecs/systems.h"
+#include "ecs/spawn.h"
+#include "ecs/stats.h"
+#include "ecs/runner.h"
+#include "ecs/sweep_runner.h"
+#include "io/stats_stream.h"
+#include "sim/ensemble.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+class HeadlessRunnerTest : public ::testing::Test {
+protected:
+    std::string tmp_path_ = "test_runner_tmp.ini";
+
+    void TearDown() override { std::remove(tmp_path_.c_str()); }
+
+    void make_world(flecs::world& world, int normals, int doctors) {
+        std::ofstream(tmp_path_) << "initial_normal_count = " << normals << "\n"
+                                 << "initial_doctor_count = " << doctors << "\n"
+                                 << "sim_threads = 1\n";
+        init_world(world, tmp_path_);
+        register_all_systems(world);
+        register_stats_system(world);
+        spawn_initial_population(world);
+    }
+};
+
+TEST_F(HeadlessRunnerTest, StepsFixedFramesWithoutRenderSync) {
+    flecs::world world;
+    make_world(world, 40, 5);
+
+    HeadlessOptions options;
+    options.dt = 0.05f;
+    options.max_frames = 20;
+    options.stop_on_extinction = false;
+    HeadlessResult result = run_headless(world, options);
+
+    EXPECT_EQ(result.frames, 20u);
+    EXPECT_NEAR(result.sim_time, 1.0, 1e-5);
+    EXPECT_EQ(world.get<SimClock>().frame, 20u);
+    EXPECT_NEAR(world.get<SimClock>().time, 1.0, 1e-5);
+    EXPECT_GT(result.final_stats.normal_alive + result.final_stats.doctor_alive, 0);
+    EXPECT_TRUE(world.get<RenderState>().boids.empty());
+}
+
+TEST_F(HeadlessRunnerTest, StopsAtSimulatedTime) {
+    flecs::world world;
+    make_world(world, 10, 0);
+
+    HeadlessOptions options;
+    options.dt = 0.1f;
+    options.max_frames = 0;
+    options.max_time = 0.95;
+    options.stop_on_extinction = false;
+    HeadlessResult result = run_headless(world, options);
+
+    EXPECT_EQ(result.frames, 10u);
+}
+
+TEST_F(HeadlessRunnerTest, StopsOnExtinction) {
+    flecs::world world;
+    make_world(world, 0, 0);
+
+    HeadlessOptions options;
+    options.max_frames = 100;
+    HeadlessResult result = run_headless(world, options);
+
+    EXPECT_TRUE(result.extinct);
+    EXPECT_EQ(result.frames, 1u);
+}
+
+TEST(HeadlessStopConditions, EndsDecidedRunsWithReason) {
+    SimConfig config{};
+    config.initial_normal_count = 20;
+    config.initial_doctor_count = 0;
+    config.p_initial_infect_normal = 0.0f;
+    config.p_initial_infect_doctor = 0.0f;
+    config.sim_threads = 1;
+    config.stop_no_infected_seconds = 0.1f;
+
+    flecs::world world;
+    init_world(world, config);
+    register_all_systems(world);
+    register_stats_system(world);
+    spawn_initial_population(world);
+
+    HeadlessOptions options;
+    options.dt = 0.05f;
+    options.max_frames = 100;
+    HeadlessResult result = run_headless(world, options);
+    EXPECT_EQ(result.stop_reason, StopReason::InfectionOver);
+    EXPECT_EQ(result.frames, 3u);
+    EXPECT_FALSE(result.extinct);
+
+    // Without the config keys the frame budget is what ends the run
+    options.stop_conditions = false;
+    result = run_headless(world, options);
+    EXPECT_EQ(result.stop_reason, StopReason::FrameLimit);
+    EXPECT_EQ(result.frames, 100u);
+}
+
+TEST(SweepRunner, RunsEveryPointInParallel) {
+    SimConfig base{};
+    base.initial_normal_count = 20;
+    base.initial_doctor_count = 2;
+
+    std::vector<SweepParam> params = {
+        parse_sweep_param("p_cure=0.1,0.9"),
+        parse_sweep_param("initial_normal_count=10,30"),
+    };
+    auto design = build_sweep_design(params, SweepDesign::Grid, 0, 0);
+
+    HeadlessOptions options;
+    options.max_frames = 30;
+    options.stop_on_extinction = false;
+
+    std::vector<SweepPointResult> results(design.size());
+    int calls = 0;
+    run_sweep(base, params, design, options, 4, [&](const SweepPointResult& point) {
+        results[point.index] = point;
+        calls++;
+    });
+
+    EXPECT_EQ(calls, 4);
+    for (const auto& r : results) {
+        EXPECT_TRUE(r.error.empty()) << r.error;
+        EXPECT_EQ(r.result.frames, 30u);
+    }
+
+    // Same design point, same result, regardless of thread or order
+    std::vector<SweepPointResult> again(design.size());
+    run_sweep(base, params, design, options, 1, [&](const SweepPointResult& point) {
+        again[point.index] = point;
+    });
+    for (std::size_t i = 0; i < design.size(); ++i) {
+        EXPECT_EQ(results[i].result.final_stats.normal_alive, again[i].result.final_stats.normal_alive);
+        EXPECT_EQ(results[i].result.final_stats.newborns_total, again[i].result.final_stats.newborns_total);
+    }
+}
+
+TEST(SweepRunner, RoundsRangeLevelsOnIntegerKeys) {
+    std::vector<SweepParam> params = {parse_sweep_param("initial_normal_count=10:15:3")};
+    auto design = build_sweep_design(params, SweepDesign::Grid, 0, 0);
+    ASSERT_DOUBLE_EQ(design[1][0], 12.5);
+
+    HeadlessOptions options;
+    options.max_frames = 1;
+    options.stop_on_extinction = false;
+
+    std::vector<SweepPointResult> results(design.size());
+    run_sweep(SimConfig{}, params, design, options, 1, [&](const SweepPointResult& point) {
+        results[point.index] = point;
+    });
+    EXPECT_TRUE(results[1].error.empty()) << results[1].error;
+    EXPECT_EQ(results[1].values, (std::vector<double>{13}));
+    EXPECT_EQ(results[2].values, (std::vector<double>{15}));
+}
+
+TEST_F(HeadlessRunnerTest, InterleavedWorldsDoNotShareRandomState) {
+    // Stepping two worlds alternately on one thread must give each the same
+    // trajectory it has when stepped alone.
+    flecs::world solo;
+    make_world(solo, 30, 4);
+    for (int i = 0; i < 60; ++i) solo.progress(1.0f / 60.0f);
+
+    flecs::world a;
+    flecs::world b;
+    make_world(a, 30, 4);
+    make_world(b, 30, 4);
+    for (int i = 0; i < 60; ++i) {
+        a.progress(1.0f / 60.0f);
+        b.progress(1.0f / 60.0f);
+    }
+
+    const SimStats& expected = solo.get<SimStats>();
+    for (const flecs::world* w : {&a, &b}) {
+        const SimStats& got = w->get<SimStats>();
+        EXPECT_EQ(got.normal_alive, expected.normal_alive);
+        EXPECT_EQ(got.doctor_alive, expected.doctor_alive);
+        EXPECT_EQ(got.newborns_total, expected.newborns_total);
+        EXPECT_EQ(got.dead_total, expected.dead_total);
+    }
+}
+
+static std::vector<float> spawn_xs(int seed) {
+    SimConfig config{};
+    config.initial_normal_count = 10;
+    config.initial_doctor_count = 0;
+    config.seed = seed;
+    flecs::world world;
+    init_world(world, config);
+    spawn_initial_population(world);
+    std::vector<float> xs;
+    world.each([&](const Position& p) { xs.push_back(p.x); });
+    std::sort(xs.begin(), xs.end());
+    return xs;
+}
+
+TEST(SimSeed, ConfigSeedDrivesSpawn) {
+    EXPECT_EQ(spawn_xs(5), spawn_xs(5));
+    EXPECT_NE(spawn_xs(5), spawn_xs(6));
+}
+
+TEST(EnsembleRunner, AggregatesEverySeedAtEverySample) {
+    SimConfig base{};
+    base.initial_normal_count = 20;
+    base.initial_doctor_count = 2;
+    base.seed = 7;
+
+    HeadlessOptions options;
+    options.max_frames = 30;
+
+    EnsembleAccumulator acc(STATS_COLUMN_COUNT);
+    std::vector<double> seeds;
+    run_ensemble(base, 4, 10, options, 2, acc, [&](const SweepPointResult& run) {
+        EXPECT_TRUE(run.error.empty()) << run.error;
+        EXPECT_EQ(run.result.frames, 30u);
+        seeds.push_back(run.values[0]);
+    });
+
+    std::sort(seeds.begin(), seeds.end());
+    EXPECT_EQ(seeds, (std::vector<double>{7, 8, 9, 10}));
+    ASSERT_EQ(acc.rows(), 3u);
+    for (std::size_t r = 0; r < acc.rows(); ++r) {
+        EXPECT_EQ(acc.runs(r), 4u);
+        EXPECT_EQ(acc.frame(r), (r + 1) * 10);
+    }
+
+    // A one-seed ensemble reproduces a plain run with that seed
+    EnsembleAccumulator one(STATS_COLUMN_COUNT);
+    run_ensemble(base, 1, 10, options, 1, one, [](const SweepPointResult&) {});
+
+    SimConfig config = base;
+    config.sim_threads = 1;
+    flecs::world world;
+    init_world(world, config);
+    register_all_systems(world);
+    register_stats_system(world);
+    spawn_initial_population(world);
+    options.stop_on_extinction = false;
+    run_headless(world, options);
+
+    const StatsRecord expected = make_stats_record(30, 0.5, world.get<SimStats>());
+    for (int c = 0; c < STATS_COLUMN_COUNT; ++c) {
+        EXPECT_EQ(one.moments(2, c).mean, expected.values[c]) << stats_column_names()[c];
+        EXPECT_EQ(one.moments(2, c).variance(), 0.0);
+    }
+}
+
+TEST(CommonRandomNumbers, SpawnDrawsDoNotDependOnProbabilities) {
+    auto spawn = [](float p_infect) {
+        SimConfig config{};
+        config.initial_normal_count = 200;
+        config.initial_doctor_count = 0;
+        config.p_initial_infect_normal = p_infect;
+        config.seed = 11;
+        flecs::world world;
+        init_world(world, config);
+        spawn_initial_population(world);
+        std::vector<std::pair<uint64_t, bool>> boids;   // (BoidId, infected)
+        std::vector<float> xs;
+        world.each([&](flecs::entity e, const BoidId& id, const Position& p) {
+            boids.push_back({id.value, e.has<Infected>()});
+            xs.push_back(p.x);
+        });
+        std::sort(boids.begin(), boids.end());
+        std::sort(xs.begin(), xs.end());
+        return std::make_pair(boids, xs);
+    };
+
+    const auto low = spawn(0.1f);
+    const auto high = spawn(0.2f);
+    EXPECT_EQ(low.second, high.second);
+    ASSERT_EQ(low.first.size(), high.first.size());
+    int infected_low = 0, infected_high = 0;
+    for (std::size_t i = 0; i < low.first.size(); ++i) {
+        ASSERT_EQ(low.first[i].first, high.first[i].first);
+        // Same uniform per boid: raising p only adds infections
+        if (low.first[i].second) EXPECT_TRUE(high.first[i].second);
+        infected_low += low.first[i].second;
+        infected_high += high.first[i].second;
+    }
+    EXPECT_GT(infected_high, infected_low);
+}
+
+TEST(CommonRandomNumbers, IdenticalArmsGiveZeroPairedDifference) {
+    SimConfig base{};
+    base.initial_normal_count = 40;
+    base.initial_doctor_count = 4;
+    base.seed = 3;
+
+    HeadlessOptions options;
+    options.max_frames = 60;
+
+    EnsembleAccumulator acc(STATS_COLUMN_COUNT);
+    run_paired_ensemble(base, base, true, 3, 20, options, 2, acc, [](const SweepPointResult& run) {
+        EXPECT_TRUE(run.error.empty()) << run.error;
+    });
+    ASSERT_EQ(acc.rows(), 3u);
+    for (std::size_t r = 0; r < acc.rows(); ++r) {
+        EXPECT_EQ(acc.runs(r), 3u);
+        for (int c = 0; c < STATS_COLUMN_COUNT; ++c) {
+            EXPECT_EQ(acc.moments(r, c).mean, 0.0) << stats_column_names()[c];
+            EXPECT_EQ(acc.moments(r, c).variance(), 0.0);
+        }
+    }
+}
+
+TEST(BranchRunner, ControlContinuesPrefixAndBranchesStayIsolated) {
+    SimConfig base{};
+    base.initial_normal_count = 60;
+    base.initial_doctor_count = 4;
+    base.p_initial_infect_normal = 0.3f;
+    base.p_infect_normal = 0.2f;
+    base.sim_threads = 1;
+    base.seed = 9;
+
+    HeadlessOptions options;
+    options.max_frames = 40;
+    options.stop_on_extinction = false;
+    options.stop_conditions = false;
+
+    const CheckpointImage prefix = run_branch_prefix(base, options);
+    const std::vector<BranchSpec> branches = {
+        {"control", {}},
+        {"no_cure", {{"p_cure", "0"}}},
+        {"bad", {{"no_such_key", "1"}}},
+        {"resized", {{"world_width", "100"}}},
+    };
+
+    std::vector<BranchRunResult> children(branches.size() * 2);
+    run_branches(prefix, branches, 2, true, 10, options, 2, [&](const BranchRunResult& child) {
+        children[child.branch * 2 + child.replicate] = child;
+    });
+
+    for (std::size_t b = 0; b < 2; ++b) {
+        for (std::size_t r = 0; r < 2; ++r) {
+            const BranchRunResult& child = children[b * 2 + r];
+            EXPECT_TRUE(child.error.empty()) << child.error;
+            EXPECT_EQ(child.seed, 9 + static_cast<int>(r));
+            EXPECT_EQ(child.result.frames, 40u);
+            ASSERT_EQ(child.samples.size(), 4u);
+            EXPECT_EQ(child.samples.front().frame, 50u);   // world clock, past the prefix
+        }
+    }
+    EXPECT_FALSE(children[4].error.empty());
+    EXPECT_FALSE(children[6].error.empty());
+
+    // Replicate 0 of the control branch, run alongside the other children,
+    // is the unbranched run
+    SimConfig config = base;
+    flecs::world world;
+    init_world(world, config);
+    register_all_systems(world);
+    register_stats_system(world);
+    spawn_initial_population(world);
+    run_headless(world, options);
+    run_headless(world, options);
+    const SimStats& plain = world.get<SimStats>();
+    EXPECT_EQ(std::memcmp(&plain, &children[0].result.final_stats, sizeof(SimStats)), 0);
+}
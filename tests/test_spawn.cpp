@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+#include <flecs.h>
+#include "components.h"
+#include "spatial_grid.h"
+#include "ecs/spawn.h"
+#include "ecs/boid_state.h"
+#include "ecs/systems.h"
+#include "render_state.h"
+#include <algorithm>
+#include <vector>
+
+static void register_components(flecs::world& world, bool toggle = false) {
+    world.component<Position>();
+    world.component<Velocity>();
+    world.component<Heading>();
+    world.component<Health>();
+    world.component<InfectionState>();
+    world.component<ReproductionCooldown>();
+    world.component<NormalBoid>();
+    world.component<DoctorBoid>();
+    world.component<AntivaxBoid>();
+    world.component<Male>();
+    world.component<Female>();
+    world.component<Infected>();
+    world.component<Alive>();
+    world.component<SpatialGrid>();
+    if (toggle) {
+        register_state_toggles(world);
+    }
+}
+
+static SpawnSpec make_spec(uint8_t swarm, bool male, bool infected, float x) {
+    SpawnSpec s{};
+    s.swarm_type = swarm;
+    s.male = male;
+    s.infected = infected;
+    s.x = x;
+    s.y = 100.0f;
+    s.vx = 1.0f;
+    s.vy = 2.0f;
+    s.heading = 0.5f;
+    s.cooldown = 3.0f;
+    s.uid = static_cast<uint64_t>(x) + 1;
+    return s;
+}
+
+TEST(BulkSpawn, CreatesBoidsInFinalArchetype) {
+    flecs::world world;
+    register_components(world);
+    SimConfig config{};
+    config.t_death = 7.0f;
+    world.set<SimConfig>(config);
+
+    std::vector<SpawnSpec> specs;
+    for (int i = 0; i < 10; ++i) {
+        specs.push_back(make_spec(static_cast<uint8_t>(i % 3), i % 2 == 0, i < 4, 10.0f * i));
+    }
+    spawn_boids(world, specs);
+
+    int total = 0, infected = 0, doctors = 0, antivax = 0, males = 0;
+    world.query<const Position>().each([&](flecs::entity e, const Position& pos) {
+        total++;
+        EXPECT_TRUE(e.has<Alive>());
+        EXPECT_NE(e.has<Male>(), e.has<Female>());
+        EXPECT_FLOAT_EQ(pos.y, 100.0f);
+        EXPECT_FLOAT_EQ(e.get<Velocity>().vy, 2.0f);
+        EXPECT_FLOAT_EQ(e.get<Heading>().angle, 0.5f);
+        EXPECT_FLOAT_EQ(e.get<ReproductionCooldown>().cooldown, 3.0f);
+        EXPECT_EQ(e.get<BoidId>().value, static_cast<uint64_t>(pos.x) + 1);
+        EXPECT_FLOAT_EQ(e.get<Health>().lifespan, 60.0f);  // prefab default
+        if (e.has<Infected>()) {
+            infected++;
+            EXPECT_FLOAT_EQ(e.get<InfectionState>().time_to_death, 7.0f);
+        } else {
+            EXPECT_FALSE(e.has<InfectionState>());
+        }
+        if (e.has<DoctorBoid>()) doctors++;
+        if (e.has<AntivaxBoid>()) antivax++;
+        if (e.has<Male>()) males++;
+    });
+
+    // Prefabs themselves are not matched by queries
+    EXPECT_EQ(total, 10);
+    EXPECT_EQ(infected, 4);
+    EXPECT_EQ(doctors, 3);
+    EXPECT_EQ(antivax, 3);
+    EXPECT_EQ(males, 5);
+}
+
+TEST(BulkSpawn, ToggleModeCarriesDisabledInfected) {
+    flecs::world world;
+    register_components(world, true);
+    SimConfig config{};
+    config.toggle_state_tags = true;
+    world.set<SimConfig>(config);
+
+    spawn_boids(world, {make_spec(0, true, true, 0.0f), make_spec(0, true, false, 50.0f)});
+
+    int infected = 0, healthy = 0;
+    std::vector<flecs::entity> boids;
+    world.query<const Position>().each([&](flecs::entity e, const Position&) {
+        EXPECT_TRUE(e.has<Infected>());
+        EXPECT_TRUE(e.has<InfectionState>());
+        EXPECT_TRUE(boid_alive(e));
+        if (boid_infected(e)) infected++; else healthy++;
+        boids.push_back(e);
+    });
+    EXPECT_EQ(infected, 1);
+    EXPECT_EQ(healthy, 1);
+
+    // Both land in the one table that carries the bitsets, and stay there
+    ASSERT_EQ(boids.size(), 2u);
+    const flecs::table table = boids[0].table();
+    EXPECT_EQ(boids[1].table(), table);
+    EXPECT_TRUE(table.has(state_toggle_id<Infected>(world)));
+    EXPECT_TRUE(table.has(state_toggle_id<Alive>(world)));
+    for (flecs::entity e : boids) {
+        set_boid_infected(e, !boid_infected(e), true);
+        set_boid_alive(e, false, true);
+        EXPECT_EQ(e.table(), table);
+    }
+}
+
+TEST(BulkSpawn, RecyclesParkedEntities) {
+    flecs::world world;
+    register_components(world);
+    SimConfig config{};
+    config.recycle_entities = true;
+    config.t_death = 1.0f;
+    world.set<SimConfig>(config);
+    world.set<SimStats>({});
+    world.set<BoidRecycler>({});
+
+    spawn_boids(world, {make_spec(0, true, true, 0.0f), make_spec(0, false, false, 50.0f)});
+    flecs::entity sick;
+    world.query<const Infected>().each([&](flecs::entity e, const Infected&) { sick = e; });
+    ASSERT_TRUE(sick.is_valid());
+    sick.set(InfectionState{2.0f, 1.0f});
+    flecs::entity_t sick_id = sick.id();
+
+    register_death_system(world);
+    register_cleanup_system(world);
+    world.progress(1.0f / 60.0f);
+    world.progress(1.0f / 60.0f);
+
+    // Parked: still alive as an id, but empty and invisible to queries
+    const BoidRecycler& recycler = world.get<BoidRecycler>();
+    ASSERT_EQ(recycler.free.size(), 1u);
+    EXPECT_TRUE(sick.is_alive());
+    EXPECT_FALSE(sick.has<Position>());
+    int visible = 0;
+    world.query<const Position>().each([&](flecs::entity, const Position&) { visible++; });
+    EXPECT_EQ(visible, 1);
+
+    // The next spawn reuses the id with freshly written components
+    spawn_boids(world, {make_spec(1, false, false, 300.0f)});
+    EXPECT_TRUE(world.get<BoidRecycler>().free.empty());
+    flecs::entity reused = world.entity(sick_id);
+    EXPECT_TRUE(reused.has<DoctorBoid>());
+    EXPECT_TRUE(reused.has<Alive>());
+    EXPECT_FALSE(reused.has<Infected>());
+    EXPECT_FALSE(reused.has<InfectionState>());
+    EXPECT_FLOAT_EQ(reused.get<Position>().x, 300.0f);
+
+    // Same entity id, different boid: recorded tracks follow the BoidId
+    world.set<RenderState>({});
+    world.set<SimulationState>({});
+    register_render_sync_system(world);
+    world.progress(1.0f / 60.0f);
+    std::vector<uint64_t> track_ids;
+    for (const BoidRenderData& b : world.get<RenderState>().boids) track_ids.push_back(b.id);
+    EXPECT_NE(std::find(track_ids.begin(), track_ids.end(), 301u), track_ids.end());
+    EXPECT_EQ(std::find(track_ids.begin(), track_ids.end(), sick_id), track_ids.end());
+}
@@ -0,0 +1,222 @@
+#include <gtest/gtest.h>
+#include <flecs.h>
+#include "components.h"
+#include "spatial_grid.h"
+#include "ecs/systems.h"
+#include "ecs/boid_state.h"
+#include "ecs/world.h"
+#include "ecs/spawn.h"
+#include "ecs/stats.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+static void register_components(flecs::world& world, bool toggle) {
+    world.component<Position>();
+    world.component<Velocity>();
+    world.component<Heading>();
+    world.component<Health>();
+    world.component<InfectionState>();
+    world.component<ReproductionCooldown>();
+    world.component<NormalBoid>();
+    world.component<DoctorBoid>();
+    world.component<AntivaxBoid>();
+    world.component<Male>();
+    world.component<Female>();
+    world.component<Infected>();
+    world.component<Alive>();
+    world.component<SpatialGrid>();
+    if (toggle) {
+        register_state_toggles(world);
+    }
+}
+
+static flecs::entity make_boid(flecs::world& world, bool infected, bool toggle) {
+    auto e = world.entity()
+        .add<Alive>()
+        .add<NormalBoid>()
+        .add<Male>()
+        .set(Position{0.0f, 0.0f})
+        .set(Velocity{0.0f, 0.0f})
+        .set(Heading{0.0f})
+        .set(Health{0.0f, 60.0f})
+        .set(InfectionState{0.0f, 5.0f})
+        .set(ReproductionCooldown{0.0f});
+    if (toggle) {
+        add_state_toggles(e, infected);
+    } else {
+        set_boid_infected(e, infected, toggle);
+    }
+    return e;
+}
+
+TEST(StateToggle, HelpersMatchTagSemantics) {
+    for (bool toggle : {false, true}) {
+        flecs::world world;
+        register_components(world, toggle);
+
+        auto e = make_boid(world, false, toggle);
+        EXPECT_FALSE(boid_infected(e));
+        EXPECT_TRUE(boid_alive(e));
+
+        set_boid_infected(e, true, toggle);
+        EXPECT_TRUE(boid_infected(e));
+        set_boid_infected(e, false, toggle);
+        EXPECT_FALSE(boid_infected(e));
+
+        set_boid_alive(e, false, toggle);
+        EXPECT_FALSE(boid_alive(e));
+    }
+}
+
+// Queries that list a toggled tag must skip entities where it is disabled
+TEST(StateToggle, QueriesSkipDisabledTags) {
+    flecs::world world;
+    register_components(world, true);
+
+    std::vector<flecs::entity> boids;
+    for (int i = 0; i < 10; ++i) {
+        boids.push_back(make_boid(world, i < 4, true));
+    }
+    set_boid_alive(boids[0], false, true);
+
+    int infected_alive = 0;
+    world.query<const Infected, const Alive>().each([&](const Infected&, const Alive&) {
+        infected_alive++;
+    });
+    EXPECT_EQ(infected_alive, 3);
+
+    // All boids still share one table: no state change moved an entity
+    EXPECT_EQ(boids[0].table(), boids[9].table());
+}
+
+// Neither infection, cure nor death moves a boid created with the bitsets
+TEST(StateToggle, StateChangesNeverMoveTables) {
+    flecs::world world;
+    register_components(world, true);
+
+    auto healthy = make_boid(world, false, true);
+    auto sick = make_boid(world, true, true);
+    const flecs::table table = healthy.table();
+    EXPECT_EQ(sick.table(), table);
+    EXPECT_TRUE(table.has(state_toggle_id<Infected>(world)));
+    EXPECT_TRUE(table.has(state_toggle_id<Alive>(world)));
+
+    set_boid_infected(healthy, true, true);
+    set_boid_infected(sick, false, true);   // first cure
+    set_boid_alive(healthy, false, true);   // death
+    EXPECT_EQ(healthy.table(), table);
+    EXPECT_EQ(sick.table(), table);
+    EXPECT_TRUE(boid_infected(healthy));
+    EXPECT_FALSE(boid_infected(sick));
+    EXPECT_FALSE(boid_alive(healthy));
+    EXPECT_TRUE(boid_alive(sick));
+}
+
+// Death through the real systems: toggle mode leaves the entity to cleanup the same way
+TEST(StateToggle, DeathAndCleanupInToggleMode) {
+    flecs::world world;
+    register_components(world, true);
+
+    SimConfig config{};
+    config.t_death = 1.0f;
+    config.toggle_state_tags = true;
+    world.set<SimConfig>(config);
+    world.set<SimStats>({});
+    world.set<SpatialGrid>(SpatialGrid(1920.0f, 1080.0f, 40.0f));
+
+    auto sick = make_boid(world, true, true);
+    auto healthy = make_boid(world, false, true);
+    sick.set(InfectionState{2.0f, 1.0f});
+
+    register_death_system(world);
+    register_cleanup_system(world);
+    world.progress(1.0f / 60.0f);
+    world.progress(1.0f / 60.0f);
+
+    EXPECT_FALSE(sick.is_alive());
+    EXPECT_TRUE(healthy.is_alive());
+    EXPECT_TRUE(boid_alive(healthy));
+}
+
+// Toggle mode keeps the live counters in the state helpers, so no observer or
+// per-frame scan is needed; both modes must agree with a full count every frame
+TEST(StateToggle, CountersFollowBitsWithoutScans) {
+    for (bool toggle : {false, true}) {
+        SimConfig config{};
+        config.initial_normal_count = 200;
+        config.initial_doctor_count = 20;
+        config.p_initial_infect_normal = 0.3f;
+        config.t_death = 0.5f;
+        config.t_adult = 0.2f;
+        config.p_become_doctor = 0.01f;
+        config.sim_threads = 1;
+        config.toggle_state_tags = toggle;
+
+        flecs::world world;
+        init_world(world, config);
+        register_all_systems(world);
+        register_stats_system(world);
+        spawn_initial_population(world);
+        EXPECT_EQ(static_cast<bool>(world.lookup("CountInfectedAlive")), !toggle);
+
+        int deaths = 0;
+        for (int frame = 0; frame < 120; ++frame) {
+            world.progress(1.0f / 60.0f);
+            SimStats counted{};
+            world.each([&](flecs::entity e, const Position&) {
+                if (!boid_alive(e)) return;
+                swarm_alive_counter(counted, e)++;
+                if (boid_infected(e)) counted.infected_alive++;
+            });
+            const SimStats& stats = world.get<SimStats>();
+            ASSERT_EQ(stats.normal_alive, counted.normal_alive) << "frame " << frame << " toggle " << toggle;
+            ASSERT_EQ(stats.doctor_alive, counted.doctor_alive) << "frame " << frame << " toggle " << toggle;
+            ASSERT_EQ(stats.antivax_alive, counted.antivax_alive) << "frame " << frame << " toggle " << toggle;
+            ASSERT_EQ(stats.infected_alive, counted.infected_alive) << "frame " << frame << " toggle " << toggle;
+            deaths = stats.dead_total;
+        }
+        EXPECT_GT(deaths, 0);
+    }
+}
+
+// Epidemic-peak churn: a large share of the population flips Infected every frame.
+// Compares table moves (add/remove) against bitset flips (enable/disable).
+TEST(StateToggle, ChurnBenchmark) {
+    constexpr int N = 20000;
+    constexpr int FRAMES = 60;
+    constexpr int FLIPS_PER_FRAME = N / 5;
+
+    long long timings_us[2] = {0, 0};
+    for (bool toggle : {false, true}) {
+        flecs::world world;
+        register_components(world, toggle);
+
+        std::vector<flecs::entity> boids;
+        boids.reserve(N);
+        for (int i = 0; i < N; ++i) {
+            boids.push_back(make_boid(world, i % 2 == 0, toggle));
+        }
+
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<int> pick(0, N - 1);
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int f = 0; f < FRAMES; ++f) {
+            world.defer_begin();
+            for (int k = 0; k < FLIPS_PER_FRAME; ++k) {
+                flecs::entity e = boids[pick(rng)];
+                set_boid_infected(e, !boid_infected(e), toggle);
+            }
+            world.defer_end();
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        timings_us[toggle ? 1 : 0] =
+            std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    }
+
+    std::cout << "Infected churn (" << FRAMES << " frames x " << FLIPS_PER_FRAME
+              << " flips): add/remove " << timings_us[0] / 1000.0
+              << "ms, enable/disable " << timings_us[1] / 1000.0 << "ms" << std::endl;
+    SUCCEED();
+}
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include "io/spsc_queue.h"
+#include "io/stats_stream.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static StatsRecord record(uint64_t frame) {
+    StatsRecord r;
+    r.frame = frame;
+    r.time = static_cast<double>(frame) / 60.0;
+    for (int c = 0; c < STATS_COLUMN_COUNT; ++c) {
+        r.values[c] = static_cast<int32_t>(frame * 100 + c);
+    }
+    return r;
+}
+
+class StatsStreamTest : public ::testing::Test {
+protected:
+    std::string tmp_path_ = "test_stats_stream_tmp.bsts";
+    void TearDown() override { std::remove(tmp_path_.c_str()); }
+};
+
+TEST(SpscQueue, PreservesOrderAcrossThreads) {
+    SpscQueue<int> queue(64);
+    const int N = 20000;
+
+    std::thread producer([&] {
+        for (int i = 0; i < N; ++i) {
+            while (!queue.try_push(i)) std::this_thread::yield();
+        }
+    });
+
+    int expected = 0;
+    int value = 0;
+    while (expected < N) {
+        if (queue.try_pop(value)) {
+            ASSERT_EQ(value, expected);
+            ++expected;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    EXPECT_FALSE(queue.try_pop(value));
+}
+
+TEST(SpscQueue, RejectsPushWhenFull) {
+    SpscQueue<int> queue(4);
+    for (std::size_t i = 0; i < queue.capacity(); ++i) EXPECT_TRUE(queue.try_push(1));
+    EXPECT_FALSE(queue.try_push(2));
+}
+
+TEST_F(StatsStreamTest, RoundTripsAcrossChunks) {
+    const uint64_t N = 1000;
+    {
+        StatsStreamWriter writer(tmp_path_, 64);
+        for (uint64_t f = 1; f <= N; ++f) {
+            while (!writer.push(record(f))) std::this_thread::yield();
+        }
+        writer.close();
+    }
+
+    std::vector<StatsRecord> records = read_stats_stream(tmp_path_);
+    ASSERT_EQ(records.size(), N);
+    for (uint64_t i = 0; i < N; ++i) {
+        const StatsRecord expected = record(i + 1);
+        EXPECT_EQ(records[i].frame, expected.frame);
+        EXPECT_DOUBLE_EQ(records[i].time, expected.time);
+        for (int c = 0; c < STATS_COLUMN_COUNT; ++c) {
+            EXPECT_EQ(records[i].values[c], expected.values[c]);
+        }
+    }
+}
+
+TEST_F(StatsStreamTest, ReadsCompleteChunksWithoutIndex) {
+    {
+        StatsStreamWriter writer(tmp_path_, 10);
+        for (uint64_t f = 0; f < 25; ++f) {
+            while (!writer.push(record(f))) std::this_thread::yield();
+        }
+        writer.close();
+    }
+
+    // Simulate a crashed run: cut the file just after the second chunk
+    std::ifstream in(tmp_path_, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    const std::size_t header = 12;
+    const std::size_t chunk = 8 + 10 * (8 + 8 + 4 * STATS_COLUMN_COUNT);
+    std::ofstream(tmp_path_, std::ios::binary | std::ios::trunc)
+        .write(bytes.data(), static_cast<std::streamsize>(header + 2 * chunk + 5));
+
+    std::vector<StatsRecord> records = read_stats_stream(tmp_path_);
+    ASSERT_EQ(records.size(), 20u);
+    EXPECT_EQ(records.back().frame, 19u);
+}
+
+TEST_F(StatsStreamTest, RejectsForeignFiles) {
+    std::ofstream(tmp_path_) << "frame,time\n";
+    EXPECT_THROW(read_stats_stream(tmp_path_), std::runtime_error);
+}
+
+TEST(StatsStreamCsv, WritesHeaderAndRows) {
+    std::ostringstream out;
+    write_stats_csv({record(3)}, out);
+
+    std::istringstream lines(out.str());
+    std::string header, row;
+    std::getline(lines, header);
+    std::getline(lines, row);
+    EXPECT_EQ(header.rfind("frame,time,normal_alive,doctor_alive", 0), 0u);
+    EXPECT_EQ(row.rfind("3,0.05,300,301", 0), 0u);
+}
+
+TEST(StatsStreamCsv, KeepsSimTimeExactOnLongRuns) {
+    EXPECT_EQ(format_sim_time(0.05), "0.05");
+    EXPECT_EQ(format_sim_time(90.0), "90");
+
+    // Three hours of 1/60 s frames: six significant digits would give 10800
+    const double time = 648001.0 / 60.0;
+    EXPECT_EQ(std::strtod(format_sim_time(time).c_str(), nullptr), time);
+
+    StatsRecord r = record(648001);
+    r.time = time;
+    std::ostringstream out;
+    write_stats_csv({r}, out);
+    EXPECT_NE(out.str().find("648001," + format_sim_time(time) + ","), std::string::npos);
+}
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include "sim/stop_monitor.h"
+#include <string>
+
+static SimStats stats(int normal, int doctor, int antivax, int infected) {
+    SimStats s;
+    s.normal_alive = normal;
+    s.doctor_alive = doctor;
+    s.antivax_alive = antivax;
+    s.infected_alive = infected;
+    return s;
+}
+
+TEST(StopMonitor, OffByDefault) {
+    SimConfig config{};
+    StopConditions c = stop_conditions_from(config);
+    EXPECT_FALSE(c.any());
+
+    StopMonitor monitor(c);
+    EXPECT_EQ(monitor.update(1.0, stats(0, 0, 0, 0)), StopReason::None);
+    EXPECT_EQ(std::string(stop_reason_name(StopReason::SteadyState)), "steady_state");
+}
+
+TEST(StopMonitor, ClassExtinctionNeedsTheClassToHaveLived) {
+    StopConditions c;
+    c.doctor_extinct = true;
+    c.antivax_extinct = true;
+    StopMonitor monitor(c);
+
+    // No antivax boid was ever spawned: not an extinction
+    EXPECT_EQ(monitor.update(0.1, stats(50, 3, 0, 1)), StopReason::None);
+    EXPECT_EQ(monitor.update(0.2, stats(50, 1, 0, 1)), StopReason::None);
+    EXPECT_EQ(monitor.update(0.3, stats(50, 0, 0, 1)), StopReason::DoctorExtinct);
+}
+
+TEST(StopMonitor, InfectionOverAfterContinuousStretch) {
+    StopConditions c;
+    c.no_infected_seconds = 1.0;
+    StopMonitor monitor(c);
+
+    EXPECT_EQ(monitor.update(0.0, stats(10, 1, 0, 0)), StopReason::None);
+    EXPECT_EQ(monitor.update(0.5, stats(10, 1, 0, 0)), StopReason::None);
+    // A new infection restarts the clock
+    EXPECT_EQ(monitor.update(0.9, stats(10, 1, 0, 2)), StopReason::None);
+    EXPECT_EQ(monitor.update(1.2, stats(10, 1, 0, 0)), StopReason::None);
+    EXPECT_EQ(monitor.update(2.1, stats(10, 1, 0, 0)), StopReason::None);
+    EXPECT_EQ(monitor.update(2.2, stats(10, 1, 0, 0)), StopReason::InfectionOver);
+}
+
+TEST(StopMonitor, SteadyStateOverFullWindow) {
+    StopConditions c;
+    c.steady_window = 1.0;
+    c.steady_variance = 0.5;
+    StopMonitor monitor(c);
+
+    // Growing population: large variance, never steady
+    int alive = 100;
+    double t = 0.0;
+    for (int i = 0; i < 30; ++i, t += 0.1) {
+        EXPECT_EQ(monitor.update(t, stats(alive += 5, 0, 0, 0)), StopReason::None) << t;
+    }
+    // Flat population: steady once the window no longer holds the growth
+    StopReason reason = StopReason::None;
+    double stopped_at = 0.0;
+    for (int i = 0; i < 30 && reason == StopReason::None; ++i, t += 0.1) {
+        reason = monitor.update(t, stats(alive, 0, 0, 0));
+        stopped_at = t;
+    }
+    EXPECT_EQ(reason, StopReason::SteadyState);
+    // The last growth sample (t = 2.9) already holds the final count, so the
+    // window is flat once t = 2.8 has slid out
+    EXPECT_NEAR(stopped_at, 3.8, 0.15);
+}
+
+TEST(StopMonitor, SteadyStateWaitsForFirstWindow) {
+    StopConditions c;
+    c.steady_window = 2.0;
+    c.steady_variance = 1.0;
+    StopMonitor monitor(c);
+    EXPECT_EQ(monitor.update(0.0, stats(10, 0, 0, 0)), StopReason::None);
+    EXPECT_EQ(monitor.update(1.0, stats(10, 0, 0, 0)), StopReason::None);
+    EXPECT_EQ(monitor.update(2.0, stats(10, 0, 0, 0)), StopReason::SteadyState);
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include "sim/sweep.h"
+#include <algorithm>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+TEST(SweepParam, ParsesRangeAndList) {
+    SweepParam range = parse_sweep_param("p_cure=0.2:0.8:4");
+    EXPECT_EQ(range.key, "p_cure");
+    EXPECT_DOUBLE_EQ(range.lo, 0.2);
+    EXPECT_DOUBLE_EQ(range.hi, 0.8);
+    EXPECT_EQ(range.levels, 4u);
+    EXPECT_TRUE(range.values.empty());
+
+    SweepParam list = parse_sweep_param("initial_normal_count=100,200,400");
+    EXPECT_EQ(list.key, "initial_normal_count");
+    EXPECT_EQ(list.values, (std::vector<double>{100, 200, 400}));
+}
+
+TEST(SweepParam, RejectsMalformedSpecs) {
+    EXPECT_THROW(parse_sweep_param("p_cure"), std::runtime_error);
+    EXPECT_THROW(parse_sweep_param("p_cure=0.1:0.5"), std::runtime_error);
+    EXPECT_THROW(parse_sweep_param("p_cure=0.1:0.5:0"), std::runtime_error);
+    EXPECT_THROW(parse_sweep_param("p_cure=0.1,abc"), std::runtime_error);
+}
+
+TEST(SweepDesign, GridIsCartesianLastFastest) {
+    std::vector<SweepParam> params = {
+        parse_sweep_param("a=0:1:2"),
+        parse_sweep_param("b=10,20,30"),
+    };
+    auto points = build_sweep_design(params, SweepDesign::Grid, 0, 0);
+    ASSERT_EQ(points.size(), 6u);
+    EXPECT_EQ(points[0], (std::vector<double>{0, 10}));
+    EXPECT_EQ(points[1], (std::vector<double>{0, 20}));
+    EXPECT_EQ(points[3], (std::vector<double>{1, 10}));
+    EXPECT_EQ(points[5], (std::vector<double>{1, 30}));
+}
+
+TEST(SweepDesign, LatinHypercubeHitsEveryStratumOnce) {
+    std::vector<SweepParam> params = {
+        parse_sweep_param("a=0:1:1"),
+        parse_sweep_param("b=-5:5:1"),
+    };
+    const std::size_t n = 50;
+    auto points = build_sweep_design(params, SweepDesign::LatinHypercube, n, 7);
+    ASSERT_EQ(points.size(), n);
+
+    for (std::size_t k = 0; k < params.size(); ++k) {
+        std::set<std::size_t> strata;
+        for (const auto& p : points) {
+            const double u = (p[k] - params[k].lo) / (params[k].hi - params[k].lo);
+            ASSERT_GE(u, 0.0);
+            ASSERT_LT(u, 1.0);
+            strata.insert(static_cast<std::size_t>(u * n));
+        }
+        EXPECT_EQ(strata.size(), n);
+    }
+
+    // Deterministic in the seed
+    EXPECT_EQ(points, build_sweep_design(params, SweepDesign::LatinHypercube, n, 7));
+}
+
+TEST(SweepDesign, SeedReplicatesShareSeedsAcrossPointsUnderCrn) {
+    std::vector<std::vector<double>> design = {{0.1}, {0.2}};
+
+    auto common = add_seed_replicates(design, 3, 42, true);
+    ASSERT_EQ(common.size(), 6u);
+    EXPECT_EQ(common[0], (std::vector<double>{0.1, 42}));
+    EXPECT_EQ(common[2], (std::vector<double>{0.1, 44}));
+    EXPECT_EQ(common[3], (std::vector<double>{0.2, 42}));
+    EXPECT_EQ(common[5], (std::vector<double>{0.2, 44}));
+
+    auto independent = add_seed_replicates(design, 3, 42, false);
+    ASSERT_EQ(independent.size(), 6u);
+    std::set<double> seeds;
+    for (const auto& row : independent) seeds.insert(row.back());
+    EXPECT_EQ(seeds.size(), 6u);
+    EXPECT_EQ(independent[3], (std::vector<double>{0.2, 45}));
+
+    EXPECT_TRUE(add_seed_replicates(design, 0, 1, true).empty());
+}
+
+TEST(SweepDesign, FormatsIntegersWithoutFraction) {
+    EXPECT_EQ(format_sweep_value(200.0), "200");
+    EXPECT_EQ(format_sweep_value(0.25), "0.25");
+}
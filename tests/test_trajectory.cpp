@@ -0,0 +1,320 @@
+#include <gtest/gtest.h>
+#include "io/trajectory.h"
+#include "io/trajectory_player.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr float W = 1280.0f;
+constexpr float H = 720.0f;
+constexpr float PI = 3.14159265f;
+
+// Toroidal flock: boids move smoothly, occasionally die, are born or change
+// infection state
+class FakeFlock {
+public:
+    explicit FakeFlock(int n) {
+        for (int i = 0; i < n; ++i) add();
+    }
+
+    TrajectoryFrame step(uint64_t frame) {
+        std::uniform_real_distribution<float> u(0.0f, 1.0f);
+        for (size_t i = 0; i < boids_.size();) {
+            if (u(rng_) < 0.01f) {
+                boids_.erase(boids_.begin() + static_cast<long>(i));
+                continue;
+            }
+            auto& b = boids_[i];
+            b.angle += (u(rng_) - 0.5f) * 0.1f;
+            if (b.angle > PI) b.angle -= 2.0f * PI;
+            if (b.angle < -PI) b.angle += 2.0f * PI;
+            b.x = std::fmod(b.x + std::cos(b.angle) * 3.0f + W, W);
+            b.y = std::fmod(b.y + std::sin(b.angle) * 3.0f + H, H);
+            if (u(rng_) < 0.02f) b.infected = !b.infected;
+            ++i;
+        }
+        if (u(rng_) < 0.5f) add();
+        if (frame % 50 == 0) boids_.front().x = std::fmod(boids_.front().x + 400.0f, W);  // teleport
+
+        TrajectoryFrame f;
+        f.frame = frame;
+        f.time = frame / 60.0;
+        f.boids = boids_;
+        return f;
+    }
+
+private:
+    void add() {
+        std::uniform_real_distribution<float> u(0.0f, 1.0f);
+        TrajectorySample s;
+        s.id = next_id_++;
+        s.x = u(rng_) * W;
+        s.y = u(rng_) * H;
+        s.angle = (u(rng_) * 2.0f - 1.0f) * PI;
+        s.swarm_type = static_cast<uint8_t>(s.id % 3);
+        boids_.push_back(s);
+    }
+
+    std::mt19937 rng_{7};
+    std::vector<TrajectorySample> boids_;
+    uint64_t next_id_ = 1;
+};
+
+float wrapped_diff(float a, float b, float period) {
+    float d = std::fabs(a - b);
+    return std::min(d, period - d);
+}
+
+// tolerance/heading_tolerance: what the encoder was allowed to drift, on top
+// of one 16-bit cell and one 8-bit heading step of quantization
+void expect_matches(const TrajectoryFrame& decoded, const TrajectoryFrame& original,
+                    float tolerance = 0.0f, float heading_tolerance = 0.0f) {
+    ASSERT_EQ(decoded.frame, original.frame);
+    ASSERT_EQ(decoded.boids.size(), original.boids.size());
+    for (size_t i = 0; i < original.boids.size(); ++i) {
+        // Original boids are created in id order, so both lists are sorted
+        const auto& d = decoded.boids[i];
+        const auto& o = original.boids[i];
+        ASSERT_EQ(d.id, o.id);
+        EXPECT_LT(wrapped_diff(d.x, o.x, W), tolerance + W / 65536.0f);
+        EXPECT_LT(wrapped_diff(d.y, o.y, H), tolerance + H / 65536.0f);
+        EXPECT_LT(wrapped_diff(d.angle, o.angle, 2.0f * PI), heading_tolerance + 2.0f * PI / 256.0f);
+        EXPECT_EQ(d.swarm_type, o.swarm_type);
+        EXPECT_EQ(d.infected, o.infected);
+    }
+}
+
+} // namespace
+
+TEST(TrajectoryCodec, RoundTripsWithinQuantization) {
+    FakeFlock flock(200);
+    TrajectoryEncoder encoder(W, H, 30);
+    TrajectoryDecoder decoder(W, H);
+
+    int keyframes = 0;
+    for (uint64_t f = 1; f <= 200; ++f) {
+        TrajectoryFrame original = flock.step(f);
+        std::vector<uint8_t> block;
+        if (encoder.encode(original, block)) ++keyframes;
+
+        TrajectoryFrame decoded;
+        EXPECT_EQ(decoder.decode(block.data(), block.size(), decoded), block.size());
+        expect_matches(decoded, original);
+    }
+    EXPECT_EQ(keyframes, 7);  // frames 1, 31, 61, ... 181
+}
+
+TEST(TrajectoryCodec, DeltaFramesAreCompact) {
+    FakeFlock flock(1000);
+    TrajectoryEncoder encoder(W, H, 1000);
+    std::vector<uint8_t> key, delta;
+    encoder.encode(flock.step(1), key);
+    for (uint64_t f = 2; f <= 10; ++f) {
+        delta.clear();
+        encoder.encode(flock.step(f), delta);
+    }
+    // Keyframe ~7 bytes/boid; this jittery flock ~1.5 bytes/boid at full precision
+    EXPECT_LT(delta.size(), key.size() / 2);
+}
+
+TEST(TrajectoryCodec, LossyRoundTripStaysWithinTolerance) {
+    FakeFlock flock(200);
+    const float tolerance = 1.0f, heading_tolerance = 0.1f;
+    TrajectoryEncoder encoder(W, H, 50, tolerance, heading_tolerance);
+    TrajectoryDecoder decoder(W, H);
+    for (uint64_t f = 1; f <= 200; ++f) {
+        TrajectoryFrame original = flock.step(f);
+        std::vector<uint8_t> block;
+        encoder.encode(original, block);
+        TrajectoryFrame decoded;
+        decoder.decode(block.data(), block.size(), decoded);
+        expect_matches(decoded, original, tolerance, heading_tolerance);
+    }
+}
+
+// At full precision straight flight leaves only cell jitter to correct
+TEST(TrajectoryCodec, SteadyFlightCostsUnderAByte) {
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> u(0.0f, 1.0f);
+    std::vector<TrajectorySample> boids(2000);
+    for (std::size_t i = 0; i < boids.size(); ++i) {
+        boids[i].id = i + 1;
+        boids[i].x = u(rng) * W;
+        boids[i].y = u(rng) * H;
+        boids[i].angle = (u(rng) * 2.0f - 1.0f) * PI;
+    }
+    TrajectoryEncoder encoder(W, H, 1000);
+    TrajectoryDecoder decoder(W, H);
+    std::vector<uint8_t> block;
+    for (uint64_t f = 1; f <= 20; ++f) {
+        TrajectoryFrame frame;
+        frame.frame = f;
+        for (auto& b : boids) {
+            b.x = std::fmod(b.x + std::cos(b.angle) * 3.0f + W, W);
+            b.y = std::fmod(b.y + std::sin(b.angle) * 3.0f + H, H);
+        }
+        frame.boids = boids;
+        block.clear();
+        encoder.encode(frame, block);
+        TrajectoryFrame decoded;
+        decoder.decode(block.data(), block.size(), decoded);
+        expect_matches(decoded, frame);
+    }
+    EXPECT_LT(block.size(), boids.size());
+}
+
+// Bytes per boid per frame for a flock flying at 3 px/frame, turning at
+// turn_rate rad/frame, recorded with the default tolerances and keyframes
+static double recorded_bytes_per_boid_frame(float turn_rate) {
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> u(0.0f, 1.0f);
+    std::vector<TrajectorySample> boids(2000);
+    for (std::size_t i = 0; i < boids.size(); ++i) {
+        boids[i].id = i + 1;
+        boids[i].x = u(rng) * W;
+        boids[i].y = u(rng) * H;
+        boids[i].angle = (u(rng) * 2.0f - 1.0f) * PI;
+    }
+    const float tolerance = 0.5f, heading_tolerance = 4.0f * PI / 180.0f;
+    TrajectoryEncoder encoder(W, H, 300, tolerance, heading_tolerance);
+    TrajectoryDecoder decoder(W, H);
+    const uint64_t frames = 600;
+    std::size_t bytes = 0;
+    std::vector<uint8_t> block;
+    for (uint64_t f = 1; f <= frames; ++f) {
+        TrajectoryFrame frame;
+        frame.frame = f;
+        for (auto& b : boids) {
+            b.angle += turn_rate;
+            if (b.angle > PI) b.angle -= 2.0f * PI;
+            b.x = std::fmod(b.x + std::cos(b.angle) * 3.0f + W, W);
+            b.y = std::fmod(b.y + std::sin(b.angle) * 3.0f + H, H);
+        }
+        frame.boids = boids;
+        block.clear();
+        encoder.encode(frame, block);
+        bytes += block.size();
+        TrajectoryFrame decoded;
+        decoder.decode(block.data(), block.size(), decoded);
+        expect_matches(decoded, frame, tolerance, heading_tolerance);
+    }
+    return static_cast<double>(bytes) / (boids.size() * frames);
+}
+
+// The recording budget: 100k boids at 60 Hz for an hour is 21.6e9 boid-frames,
+// so a few GB leaves ~0.1-0.2 bytes each, keyframes included
+TEST(TrajectoryCodec, SteadyFlightFitsRecordingBudget) {
+    EXPECT_LT(recorded_bytes_per_boid_frame(0.0f), 0.12);
+}
+
+TEST(TrajectoryCodec, SteadyTurnFitsRecordingBudget) {
+    EXPECT_LT(recorded_bytes_per_boid_frame(0.02f), 0.2);
+}
+
+class TrajectoryFileTest : public ::testing::Test {
+protected:
+    std::string tmp_path_ = "test_trajectory_tmp.btrj";
+    void TearDown() override { std::remove(tmp_path_.c_str()); }
+
+    std::vector<TrajectoryFrame> record(uint64_t frames, uint32_t keyframe_interval) {
+        FakeFlock flock(100);
+        std::vector<TrajectoryFrame> originals;
+        TrajectoryWriter writer(tmp_path_, W, H, keyframe_interval);
+        for (uint64_t f = 1; f <= frames; ++f) {
+            originals.push_back(flock.step(f));
+            TrajectoryFrame copy = originals.back();
+            while (!writer.push(std::move(copy))) {
+                copy = originals.back();
+                std::this_thread::yield();
+            }
+        }
+        writer.close();
+        return originals;
+    }
+};
+
+TEST_F(TrajectoryFileTest, SeeksViaKeyframeIndex) {
+    auto originals = record(120, 25);
+    TrajectoryReader reader(tmp_path_);
+    EXPECT_FLOAT_EQ(reader.world_width(), W);
+    EXPECT_EQ(reader.last_frame(), 120u);
+    ASSERT_FALSE(reader.keyframes().empty());
+
+    TrajectoryFrame frame;
+    ASSERT_TRUE(reader.seek(87, frame));
+    expect_matches(frame, originals[86]);
+    ASSERT_TRUE(reader.next(frame));
+    expect_matches(frame, originals[87]);
+
+    ASSERT_TRUE(reader.seek(3, frame));
+    expect_matches(frame, originals[2]);
+    EXPECT_FALSE(reader.seek(500, frame));
+}
+
+TEST_F(TrajectoryFileTest, RecoversBlocksWithoutIndex) {
+    record(60, 20);
+
+    // Drop the index and trailer plus a few bytes of the last block
+    std::ifstream in(tmp_path_, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    uint64_t index_offset;
+    std::memcpy(&index_offset, bytes.data() + bytes.size() - 12, sizeof(uint64_t));
+    std::ofstream(tmp_path_, std::ios::binary | std::ios::trunc)
+        .write(bytes.data(), static_cast<std::streamsize>(index_offset - 3));
+
+    TrajectoryReader reader(tmp_path_);
+    EXPECT_EQ(reader.last_frame(), 59u);
+    // Frames 1, 21, 41, plus any forced after a full queue
+    ASSERT_GE(reader.keyframes().size(), 3u);
+    EXPECT_EQ(reader.keyframes().front().frame, 1u);
+
+    TrajectoryFrame frame;
+    uint64_t count = 0;
+    while (reader.next(frame)) ++count;
+    EXPECT_EQ(count, 59u);
+}
+
+// Polls the player until it hands over a frame (bounded wait)
+static bool wait_advance(TrajectoryPlayer& player, uint64_t playhead, TrajectoryFrame& current) {
+    for (int i = 0; i < 2000; ++i) {
+        if (player.advance(playhead, current)) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+TEST_F(TrajectoryFileTest, PlayerDecodesAheadAndSeeks) {
+    auto originals = record(90, 30);
+    TrajectoryPlayer player(tmp_path_, 4);
+    EXPECT_EQ(player.first_frame(), 1u);
+    EXPECT_EQ(player.last_frame(), 90u);
+
+    TrajectoryFrame current;
+    ASSERT_TRUE(wait_advance(player, 1, current));
+    expect_matches(current, originals[0]);
+
+    // Skipping ahead keeps only the newest frame at or before the playhead
+    ASSERT_TRUE(wait_advance(player, 3, current));
+    EXPECT_LE(current.frame, 3u);
+
+    player.seek(70);
+    ASSERT_TRUE(wait_advance(player, 70, current));
+    expect_matches(current, originals[69]);
+
+    // Play to the end
+    while (!player.at_end()) {
+        player.advance(1000, current);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    player.advance(1000, current);
+    expect_matches(current, originals.back());
+}
@@ -0,0 +1,33 @@
+// Converts a binary stats stream (boid_swarm --stats-out) to CSV.
+// Usage: stats_to_csv <input.bsts> [output.csv]   (stdout if no output given)
+
+#include "io/stats_stream.h"
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <input.bsts> [output.csv]\n";
+        return 2;
+    }
+
+    try {
+        std::vector<StatsRecord> records = read_stats_stream(argv[1]);
+        if (argc > 2) {
+            std::ofstream out(argv[2]);
+            if (!out) {
+                std::cerr << "Cannot open output file: " << argv[2] << "\n";
+                return 1;
+            }
+            write_stats_csv(records, out);
+            std::cerr << "Wrote " << records.size() << " records to " << argv[2] << "\n";
+        } else {
+            write_stats_csv(records, std::cout);
+        }
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}